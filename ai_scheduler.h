@@ -0,0 +1,136 @@
+/**************************************************************************************************
+ * ai_scheduler.h
+ * Time-Sliced AI Planning Scheduler for Conqueror Engine (Header)
+ *
+ * ai.py's AIManager.plan_group_strategy re-plans every unit in one call. In the engine, strategic
+ * planning (what to buy, where to attack) has to share the 33 ms tick with the simulation, so it
+ * is spread across ticks instead:
+ *   - agents (nations, unit groups) request a plan with an urgency; requests are deduplicated
+ *     per agent key and a repeated request only raises the urgency;
+ *   - runSlice(), called once per tick, first applies results that finished on worker threads,
+ *     then runs queued plans most urgent first until the per-tick budget (microseconds) is
+ *     spent. Waiting requests age, so low-urgency agents are never starved;
+ *   - a plan that needs an expensive computation (pathfinding, combat estimation) offloads it:
+ *     the work runs on a worker thread against data the plan copied, and its apply step runs on
+ *     the tick thread in a later slice, where it may touch engine state.
+ * With zero worker threads (builds without threads) offloaded work runs inline and is still
+ * applied on the next slice.
+ *
+ * Exposed Types:
+ * - AiAgentKey
+ * - AiScheduler
+ **************************************************************************************************/
+
+#ifndef AI_SCHEDULER_H
+#define AI_SCHEDULER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using AiAgentKey = std::uint64_t;
+
+//-------------------------------------------------
+// AI Scheduler
+//-------------------------------------------------
+class AiScheduler {
+public:
+    using Plan = std::function<void()>;
+
+    static constexpr std::uint32_t kDefaultBudgetMicros = 2000;
+
+    explicit AiScheduler(std::size_t workerThreads = 1);
+    ~AiScheduler();
+    AiScheduler(const AiScheduler&) = delete;
+    AiScheduler& operator=(const AiScheduler&) = delete;
+
+    // Time each runSlice() may spend on applies and plans.
+    void setBudgetMicros(std::uint32_t micros) { budgetMicros = micros; }
+    std::uint32_t budget() const { return budgetMicros; }
+    // Urgency a waiting request gains per slice.
+    void setAging(double urgencyPerSlice) { aging = urgencyPerSlice; }
+
+    /**
+     * @brief Queues a plan for an agent (tick thread only). If the agent already has one queued,
+     * the newer plan replaces it and the higher of the two urgencies is kept.
+     */
+    void request(AiAgentKey agent, double urgency, Plan plan);
+    bool isQueued(AiAgentKey agent) const { return queued.count(agent) != 0; }
+    std::size_t queuedCount() const { return queued.size(); }
+
+    /**
+     * @brief Runs `work` on a worker thread; `apply` receives its result on the tick thread during
+     * a later runSlice(). `work` must only use data it owns or captured by value.
+     */
+    template <typename Result>
+    void offload(std::function<Result()> work, std::function<void(Result&)> apply) {
+        auto result = std::make_shared<Result>();
+        submit([result, work]() { *result = work(); },
+               [result, apply]() { apply(*result); });
+    }
+    std::size_t inFlight() const;
+
+    /**
+     * @brief One tick's share of planning: finished applies first, then queued plans by urgency,
+     * until the budget is spent. At least one plan runs per slice if any is queued.
+     * @return Number of plans run.
+     */
+    std::size_t runSlice();
+    // Blocks until every offloaded job has finished (their applies still need a runSlice()).
+    void waitIdle();
+
+    // Statistics.
+    std::uint64_t plansRun() const { return planCount; }
+    std::uint64_t applied() const { return applyCount; }
+    std::uint64_t overruns() const { return overrunCount; }     // Slices that ended over budget.
+    double lastSliceMicros() const { return lastSlice; }
+
+private:
+    struct Entry {
+        double key;             // urgency - aging * slice at request; larger runs first.
+        std::uint64_t version;
+        AiAgentKey agent;
+        bool operator<(const Entry& other) const { return key < other.key; }
+    };
+    struct Queued {
+        std::uint64_t version;
+        double urgency;
+        Plan plan;
+    };
+    struct Job {
+        std::function<void()> work;
+        std::function<void()> apply;
+    };
+
+    std::uint32_t budgetMicros = kDefaultBudgetMicros;
+    double aging = 0.1;
+    std::uint64_t slice = 0;
+    std::uint64_t nextVersion = 0;
+    std::priority_queue<Entry> heap;
+    std::unordered_map<AiAgentKey, Queued> queued;
+
+    mutable std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::condition_variable jobsDone;
+    std::deque<Job> jobs;
+    std::vector<std::function<void()>> finished;
+    std::size_t running = 0;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    std::uint64_t planCount = 0, applyCount = 0, overrunCount = 0;
+    double lastSlice = 0.0;
+
+    void submit(std::function<void()> work, std::function<void()> apply);
+    void workerLoop();
+};
+
+#endif // AI_SCHEDULER_H
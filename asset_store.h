@@ -0,0 +1,101 @@
+/**************************************************************************************************
+ * asset_store.h
+ * Lazy Asset Store for Conqueror Engine (Header)
+ *
+ * Assets are no longer preloaded before main() runs; the engine asks for them by id when it first
+ * needs them (a module's data when it starts, a region's data when the camera approaches it):
+ *   - a catalog maps asset ids to files (config.json "assets"); unknown ids are used as paths;
+ *   - acquire() returns a resident asset at once, or queues its read on the ResourceLoader and
+ *     runs the callback from update() when it arrives;
+ *   - prefetch() hints at assets that are likely to be needed soon; they are read at Low priority
+ *     and never delay an acquire();
+ *   - resident assets count against a memory budget; update() evicts the least recently used ones
+ *     that nobody outside the store still holds a handle to.
+ * Evicted assets are simply read again on the next acquire (from the ResourceCache when one is
+ * attached to the loader). The store is not thread-safe: use it from the thread that calls update().
+ *
+ * Exposed Types:
+ * - AssetRequest
+ * - AssetStore
+ **************************************************************************************************/
+
+#ifndef ASSET_STORE_H
+#define ASSET_STORE_H
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "resource_loader.h"
+
+struct JsonValue;
+
+struct AssetRequest {
+    std::string id;
+    ResourcePriority priority = ResourcePriority::Normal;
+};
+
+//-------------------------------------------------
+// Asset Store
+//-------------------------------------------------
+class AssetStore {
+public:
+    static constexpr std::size_t kDefaultBudget = 64u * 1024u * 1024u;
+
+    explicit AssetStore(ResourceLoader& loader, std::size_t budgetBytes = kDefaultBudget);
+
+    // Maps an asset id to the file that holds it.
+    void declare(const std::string& id, const std::string& path);
+    // Declares every member of a JSON object of the form { "id": "path", ... }. Returns the count.
+    std::size_t declareCatalog(const JsonValue& catalog);
+
+    /**
+     * @brief Returns the asset if it is resident (marking it most recently used); otherwise starts
+     * loading it and returns nullptr.
+     * @param onLoaded Optional; runs immediately if the asset is resident, else from update() once
+     *        it has been read (also on failure; check ResourceHandle::ok()).
+     */
+    ResourceHandle acquire(const std::string& id, ResourcePriority priority = ResourcePriority::High,
+                           ResourceCallback onLoaded = nullptr);
+    // Starts low-priority reads of assets that are likely to be acquired soon.
+    void prefetch(const std::vector<std::string>& ids);
+
+    /**
+     * @brief Delivers finished reads to their callbacks and trims the store to its budget.
+     * Call once per frame.
+     * @return Number of loader callbacks run.
+     */
+    std::size_t update();
+    // Evicts least recently used assets until the budget is met. Returns the number evicted.
+    std::size_t trim();
+
+    void setBudget(std::size_t budgetBytes) { budget = budgetBytes; }
+    std::size_t budgetBytes() const { return budget; }
+    std::size_t residentBytes() const { return resident; }
+    std::size_t residentCount() const { return recency.size(); }
+    std::size_t evictions() const { return evicted; }
+    bool isResident(const std::string& id) const;
+
+private:
+    struct Asset {
+        std::string path;
+        ResourceHandle data;                         // Null unless resident.
+        std::list<std::string>::iterator position;   // In `recency` while resident.
+        bool loading = false;
+        std::vector<ResourceCallback> waiting;
+    };
+
+    ResourceLoader& loader;
+    std::size_t budget;
+    std::size_t resident = 0;
+    std::size_t evicted = 0;
+    std::unordered_map<std::string, Asset> assets;
+    std::list<std::string> recency;                  // Most recently used first.
+
+    Asset& lookup(const std::string& id);
+    void arrived(const std::string& id, const ResourceHandle& data);
+};
+
+#endif // ASSET_STORE_H
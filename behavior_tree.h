@@ -0,0 +1,164 @@
+/**************************************************************************************************
+ * behavior_tree.h
+ * Batched Behavior Tree Runtime for Conqueror Engine (Header)
+ *
+ * Native replacement for the behavior-tree classes in ai.py (Sequence, Selector, Inverter,
+ * Condition, Action), which allocate one Python object per node per unit:
+ *   - a tree is built once per unit type and compiled into a flat pre-order node array that every
+ *     unit of that type shares;
+ *   - per-unit state lives in a BtBlackboard: named float / int columns (SoA), one row per unit;
+ *   - tick() runs the whole population through the tree at once. Each node receives the list of
+ *     units that reached it, leaves evaluate that list in one call over the blackboard columns,
+ *     and composites route the units that succeeded or failed to the next child. The cost per
+ *     node is one pass over contiguous arrays instead of a virtual call per unit.
+ * Semantics match ai.py: nodes succeed or fail (there is no "running" state); a Sequence stops
+ * at the first failing child and a Selector at the first succeeding one.
+ *
+ * Exposed Types:
+ * - BtBlackboard
+ * - BtNodeKind / BtLeaf
+ * - BehaviorTree / BehaviorTreeBuilder
+ **************************************************************************************************/
+
+#ifndef BEHAVIOR_TREE_H
+#define BEHAVIOR_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+//-------------------------------------------------
+// Blackboard (per-unit state, SoA)
+//-------------------------------------------------
+class BtBlackboard {
+public:
+    // Columns are declared before units are added; new columns start at zero for existing rows.
+    std::size_t addFloat(const std::string& name);
+    std::size_t addInt(const std::string& name);
+    // Column index by name, or SIZE_MAX.
+    std::size_t floatColumn(const std::string& name) const;
+    std::size_t intColumn(const std::string& name) const;
+
+    // Appends a zeroed row and returns its index.
+    std::size_t addRow();
+    // Moves the last row into `row` and shrinks by one. Returns the old index of the moved row
+    // (== row if it was the last).
+    std::size_t removeRow(std::size_t row);
+    std::size_t size() const { return rows; }
+
+    float* floats(std::size_t column) { return floatData[column].data(); }
+    const float* floats(std::size_t column) const { return floatData[column].data(); }
+    std::int32_t* ints(std::size_t column) { return intData[column].data(); }
+    const std::int32_t* ints(std::size_t column) const { return intData[column].data(); }
+
+private:
+    std::vector<std::string> floatNames, intNames;
+    std::vector<std::vector<float>> floatData;
+    std::vector<std::vector<std::int32_t>> intData;
+    std::size_t rows = 0;
+};
+
+//-------------------------------------------------
+// Nodes
+//-------------------------------------------------
+enum class BtNodeKind : std::uint8_t {
+    Sequence,   // Succeeds if every child succeeds (stops at the first failure).
+    Selector,   // Succeeds at the first child that succeeds.
+    Inverter,   // One child; flips its result.
+    Condition,  // Leaf; must not modify the blackboard.
+    Action      // Leaf.
+};
+
+/**
+ * Leaf evaluated for a batch of units: for each i < count, reads/writes row units[i] of the
+ * blackboard and stores 1 (success) or 0 (failure) in results[i].
+ */
+using BtLeaf = std::function<void(BtBlackboard& board, const std::uint32_t* units, std::size_t count,
+                                  std::uint8_t* results)>;
+
+//-------------------------------------------------
+// Behavior Tree (compiled, shareable)
+//-------------------------------------------------
+class BehaviorTree {
+public:
+    /**
+     * @brief Runs every row of the blackboard through the tree.
+     * @param succeeded Optional; receives 1/0 per row for the root result.
+     * @return Number of rows for which the root succeeded.
+     */
+    std::size_t tick(BtBlackboard& board, std::vector<std::uint8_t>* succeeded = nullptr);
+    // Runs only the listed rows (e.g. one time slice of a large population).
+    std::size_t tick(BtBlackboard& board, const std::uint32_t* rows, std::size_t count,
+                     std::vector<std::uint8_t>* succeeded = nullptr);
+
+    std::size_t nodeCount() const { return nodes.size(); }
+    const std::string& nodeName(std::size_t node) const { return names[node]; }
+    // Units that reached each node on the last tick (for debugging trees).
+    const std::vector<std::uint32_t>& visits() const { return visitCounts; }
+
+private:
+    friend class BehaviorTreeBuilder;
+
+    struct Node {
+        BtNodeKind kind;
+        std::uint32_t end;          // One past the last node of this subtree.
+        std::uint32_t leaf;         // Index into `leaves` for Condition / Action.
+    };
+    // Row lists for one tree depth: the units still being routed, and each child's outcome.
+    struct Scratch {
+        std::vector<std::uint32_t> current, pass, fail;
+        std::vector<std::uint8_t> results;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<BtLeaf> leaves;
+    std::vector<std::string> names;
+    std::vector<std::uint32_t> visitCounts;
+    std::vector<Scratch> scratch;   // One per depth.
+    std::vector<std::uint32_t> allRows, rootPass, rootFail;
+
+    // Routes `count` rows through `node`, appending them to `pass` or `fail`.
+    void evaluate(std::uint32_t node, std::size_t level, BtBlackboard& board, const std::uint32_t* rows,
+                  std::size_t count, std::vector<std::uint32_t>& pass, std::vector<std::uint32_t>& fail);
+};
+
+//-------------------------------------------------
+// Builder
+//-------------------------------------------------
+// Nested calls mirror the tree: sequence()/selector()/inverter() open a node, end() closes it.
+class BehaviorTreeBuilder {
+public:
+    BehaviorTreeBuilder& sequence(const std::string& name);
+    BehaviorTreeBuilder& selector(const std::string& name);
+    BehaviorTreeBuilder& inverter(const std::string& name);
+    BehaviorTreeBuilder& condition(const std::string& name, BtLeaf leaf);
+    BehaviorTreeBuilder& action(const std::string& name, BtLeaf leaf);
+    BehaviorTreeBuilder& end();
+
+    /**
+     * @brief Compiles the tree.
+     * @param error Optional; receives the reason if the tree is malformed (unclosed nodes, an
+     *        inverter without exactly one child, an empty composite or more than one root).
+     * @return False if malformed; `out` is untouched.
+     */
+    bool build(BehaviorTree& out, std::string* error = nullptr) const;
+
+private:
+    struct Pending {
+        BtNodeKind kind;
+        std::string name;
+        BtLeaf leaf;
+        int parent;
+        int children = 0;
+        std::uint32_t end = 0;
+    };
+    std::vector<Pending> pending;
+    std::vector<int> open;
+    std::string problem;
+
+    BehaviorTreeBuilder& add(BtNodeKind kind, const std::string& name, BtLeaf leaf, bool opens);
+};
+
+#endif // BEHAVIOR_TREE_H
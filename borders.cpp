@@ -0,0 +1,378 @@
+/*
+ * borders.cpp - Incremental border, area and contiguity maintenance on the territory owner grid.
+ */
+
+#include "borders.h"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+// Logging utility
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
+    std::cout << "[" << level << "] " << message << std::endl;
+}
+
+namespace {
+const double kEarthRadiusKm = 6371.0;
+const double kDegToRad = 3.14159265358979323846 / 180.0;
+} // namespace
+
+BorderMap::BorderMap(TerritoryIndex& territoryIndex)
+    : territory(territoryIndex),
+      width(territoryIndex.width()),
+      height(territoryIndex.height()),
+      rowAreaKm2(static_cast<std::size_t>(territoryIndex.height())),
+      borderSlot(static_cast<std::size_t>(width) * height, -1),
+      label(static_cast<std::size_t>(width) * height, kNoLabel),
+      visitEpoch(static_cast<std::size_t>(width) * height, 0) {
+    // Area of a lat/lng cell: R^2 * dLng * (sin(lat1) - sin(lat0)).
+    double cell = territory.cellDegrees();
+    for (int cy = 0; cy < height; ++cy) {
+        double lat0 = -90.0 + cy * cell;
+        double lat1 = std::min(90.0, lat0 + cell);
+        rowAreaKm2[cy] = kEarthRadiusKm * kEarthRadiusKm * (cell * kDegToRad) *
+                         (std::sin(lat1 * kDegToRad) - std::sin(lat0 * kDegToRad));
+    }
+}
+
+BorderMap::NationStats& BorderMap::statsFor(NationId nation) {
+    if (nation >= stats.size()) stats.resize(static_cast<std::size_t>(nation) + 1);
+    return stats[nation];
+}
+
+const std::vector<std::uint32_t>& BorderMap::borderCells(NationId nation) const {
+    static const std::vector<std::uint32_t> kEmpty;
+    return nation < stats.size() ? stats[nation].border : kEmpty;
+}
+
+// 4-neighbourhood; wraps across the antimeridian, stops at the poles.
+int BorderMap::neighbours(std::uint32_t cell, std::uint32_t out[4]) const {
+    int cx = static_cast<int>(cell % width), cy = static_cast<int>(cell / width);
+    std::uint32_t row = static_cast<std::uint32_t>(cy) * width;
+    int n = 0;
+    out[n++] = row + (cx == 0 ? width - 1 : cx - 1);
+    out[n++] = row + (cx == width - 1 ? 0 : cx + 1);
+    if (cy > 0) out[n++] = cell - width;
+    if (cy < height - 1) out[n++] = cell + width;
+    return n;
+}
+
+bool BorderMap::computeBorder(std::uint32_t cell) const {
+    NationId owner = territory.cellOwner(cell);
+    std::uint32_t nb[4];
+    int n = neighbours(cell, nb);
+    for (int i = 0; i < n; ++i)
+        if (territory.cellOwner(nb[i]) != owner) return true;
+    return false;
+}
+
+void BorderMap::removeBorder(std::uint32_t cell, NationId owner) {
+    std::vector<std::uint32_t>& list = stats[owner].border;
+    std::int32_t slot = borderSlot[cell];
+    std::uint32_t last = list.back();
+    list[slot] = last;
+    borderSlot[last] = slot;
+    list.pop_back();
+    borderSlot[cell] = -1;
+}
+
+void BorderMap::refreshBorder(std::uint32_t cell) {
+    NationId owner = territory.cellOwner(cell);
+    bool want = owner != kNoNation && computeBorder(cell);
+    bool have = borderSlot[cell] >= 0;
+    if (want && !have) {
+        std::vector<std::uint32_t>& list = statsFor(owner).border;
+        borderSlot[cell] = static_cast<std::int32_t>(list.size());
+        list.push_back(cell);
+    } else if (!want && have) {
+        removeBorder(cell, owner);
+    }
+}
+
+std::uint32_t BorderMap::newLabel() {
+    std::uint32_t l = static_cast<std::uint32_t>(parent.size());
+    parent.push_back(l);
+    retiredEpoch.push_back(0);
+    return l;
+}
+
+std::uint32_t BorderMap::findRoot(std::uint32_t l) {
+    while (parent[l] != l) {
+        parent[l] = parent[parent[l]]; // Path halving.
+        l = parent[l];
+    }
+    return l;
+}
+
+// Dissolves a component once per batch; its cells are about to be re-flooded.
+void BorderMap::retireRoot(std::uint32_t root, NationId nation) {
+    if (retiredEpoch[root] == epoch) return;
+    retiredEpoch[root] = epoch;
+    --stats[nation].components;
+}
+
+// Labels the connected region of `nation` containing `seed` with one fresh label.
+void BorderMap::floodComponent(std::uint32_t seed, NationId nation) {
+    std::uint32_t fresh = newLabel();
+    ++stats[nation].components;
+    retiredEpoch[fresh] = 0;
+    floodStack.clear();
+    floodStack.push_back(seed);
+    visitEpoch[seed] = epoch;
+    while (!floodStack.empty()) {
+        std::uint32_t cell = floodStack.back();
+        floodStack.pop_back();
+        if (label[cell] != kNoLabel) retireRoot(findRoot(label[cell]), nation);
+        label[cell] = fresh;
+        std::uint32_t nb[4];
+        int n = neighbours(cell, nb);
+        for (int i = 0; i < n; ++i) {
+            if (visitEpoch[nb[i]] == epoch || territory.cellOwner(nb[i]) != nation) continue;
+            visitEpoch[nb[i]] = epoch;
+            floodStack.push_back(nb[i]);
+        }
+    }
+}
+
+// True if removing `cell` from `from` provably keeps `from`'s component connected: the remaining
+// 4-neighbours of `from` are joined through the surrounding 8-cell ring, and no other cell in the
+// 3x3 block changed owner this batch. An isolated cell is not simple (its component vanishes).
+bool BorderMap::isSimpleLoss(std::uint32_t cell, NationId from, std::uint32_t flipEpoch) const {
+    static const int ringDx[8] = {-1, 0, 1, 1, 1, 0, -1, -1};
+    static const int ringDy[8] = {-1, -1, -1, 0, 1, 1, 1, 0};
+    int cx = static_cast<int>(cell % width), cy = static_cast<int>(cell / width);
+    bool owned[8];
+    for (int i = 0; i < 8; ++i) {
+        int x = cx + ringDx[i], y = cy + ringDy[i];
+        owned[i] = false;
+        if (y < 0 || y >= height) continue;
+        x = (x + width) % width;
+        std::uint32_t nb = static_cast<std::uint32_t>(territory.cellIndex(x, y));
+        if (visitEpoch[nb] == flipEpoch) return false;
+        owned[i] = territory.cellOwner(nb) == from;
+    }
+    // Count ring arcs of owned cells that contain an edge neighbour (odd ring positions).
+    int start = -1;
+    for (int i = 0; i < 8; ++i)
+        if (!owned[i]) { start = i; break; }
+    if (start < 0) return true; // Fully surrounded.
+    int arcsWithEdge = 0;
+    bool inArc = false, arcHasEdge = false;
+    for (int k = 1; k <= 8; ++k) {
+        int i = (start + k) % 8;
+        if (owned[i]) {
+            if (!inArc) { inArc = true; arcHasEdge = false; }
+            if (i % 2 == 1) arcHasEdge = true;
+        } else if (inArc) {
+            inArc = false;
+            if (arcHasEdge) ++arcsWithEdge;
+        }
+    }
+    return arcsWithEdge == 1;
+}
+
+void BorderMap::relabelAll() {
+    parent.clear();
+    retiredEpoch.clear();
+    std::fill(label.begin(), label.end(), kNoLabel);
+    for (auto& s : stats) s.components = 0;
+    ++epoch;
+    for (std::uint32_t cell = 0; cell < label.size(); ++cell) {
+        NationId owner = territory.cellOwner(cell);
+        if (owner == kNoNation || visitEpoch[cell] == epoch) continue;
+        statsFor(owner);
+        visitEpoch[cell] = epoch;
+        floodComponent(cell, owner);
+    }
+}
+
+void BorderMap::rebuild() {
+    for (auto& s : stats) s = NationStats();
+    std::fill(borderSlot.begin(), borderSlot.end(), -1);
+    for (std::uint32_t cell = 0; cell < label.size(); ++cell) {
+        NationId owner = territory.cellOwner(cell);
+        if (owner == kNoNation) continue;
+        NationStats& s = statsFor(owner);
+        ++s.cells;
+        s.areaKm2 += rowAreaKm2[cell / width];
+        refreshBorder(cell);
+    }
+    relabelAll();
+    pending.clear();
+    changed.clear();
+}
+
+void BorderMap::queueCapture(double lat, double lng, NationId nation) {
+    queueCaptureCell(territory.cellIndex(lat, lng), nation);
+}
+
+void BorderMap::queueCaptureCell(std::size_t cell, NationId nation) {
+    pending.push_back({static_cast<std::uint32_t>(cell), nation});
+}
+
+std::size_t BorderMap::applyCaptures() {
+    changed.clear();
+    changedFrom.clear();
+    if (pending.empty()) return 0;
+
+    // Phase 1: flip owners, patch area and border lists around each flipped cell.
+    ++epoch;
+    for (const PendingCapture& capture : pending) {
+        std::uint32_t cell = capture.cell;
+        NationId from = territory.cellOwner(cell);
+        if (from == capture.nation) continue;
+        if (visitEpoch[cell] != epoch) {
+            visitEpoch[cell] = epoch;
+            changed.push_back(cell);
+            changedFrom.push_back(from);
+        }
+        double area = rowAreaKm2[cell / width];
+        if (from != kNoNation) {
+            if (borderSlot[cell] >= 0) removeBorder(cell, from);
+            --stats[from].cells;
+            stats[from].areaKm2 -= area;
+        }
+        if (capture.nation != kNoNation) {
+            NationStats& s = statsFor(capture.nation);
+            ++s.cells;
+            s.areaKm2 += area;
+        }
+        territory.setCellOwner(cell, capture.nation);
+        refreshBorder(cell);
+        std::uint32_t nb[4];
+        int n = neighbours(cell, nb);
+        for (int i = 0; i < n; ++i) refreshBorder(nb[i]);
+    }
+    pending.clear();
+
+    // Drop cells that ended the batch with their original owner.
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < changed.size(); ++i) {
+        if (territory.cellOwner(changed[i]) == changedFrom[i]) continue;
+        changed[kept] = changed[i];
+        changedFrom[kept] = changedFrom[i];
+        ++kept;
+    }
+    changed.resize(kept);
+    changedFrom.resize(kept);
+
+    // Phase 2: contiguity. A loss that cannot split its component (see isSimpleLoss) just drops
+    // the cell; any other loss dissolves the loser's component, which is re-flooded from the lost
+    // cells' neighbours. Gains join existing components through union-find.
+    std::uint32_t flipEpoch = epoch;
+    ++epoch;
+    splitSeeds.clear();
+    for (std::size_t i = 0; i < changed.size(); ++i) {
+        std::uint32_t cell = changed[i];
+        NationId from = changedFrom[i];
+        if (from == kNoNation) continue;
+        if (isSimpleLoss(cell, from, flipEpoch)) {
+            label[cell] = kNoLabel;
+            continue;
+        }
+        retireRoot(findRoot(label[cell]), from);
+        label[cell] = kNoLabel;
+        std::uint32_t nb[4];
+        int n = neighbours(cell, nb);
+        for (int k = 0; k < n; ++k)
+            if (territory.cellOwner(nb[k]) == from) splitSeeds.emplace_back(nb[k], from);
+    }
+    for (const auto& seed : splitSeeds) {
+        if (visitEpoch[seed.first] == epoch) continue;
+        visitEpoch[seed.first] = epoch;
+        floodComponent(seed.first, seed.second);
+    }
+    for (std::uint32_t cell : changed) {
+        NationId owner = territory.cellOwner(cell);
+        if (owner == kNoNation || visitEpoch[cell] == epoch) continue; // Already re-flooded.
+        visitEpoch[cell] = epoch;
+        std::uint32_t root = newLabel();
+        label[cell] = root;
+        ++stats[owner].components;
+        std::uint32_t nb[4];
+        int n = neighbours(cell, nb);
+        for (int k = 0; k < n; ++k) {
+            if (territory.cellOwner(nb[k]) != owner || label[nb[k]] == kNoLabel) continue;
+            std::uint32_t other = findRoot(label[nb[k]]);
+            if (other == root) continue;
+            parent[other] = root;
+            --stats[owner].components;
+        }
+    }
+
+    // Labels only grow between compactions; re-flood everything once they dwarf the grid.
+    if (parent.size() > 4 * label.size()) relabelAll();
+    return changed.size();
+}
+
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DBORDERS_TEST)
+//   g++ -std=c++17 -O2 -DBORDERS_TEST borders.cpp territory.cpp worldpack.cpp json_reader.cpp -o borders
+#ifdef BORDERS_TEST
+#include <chrono>
+#include <random>
+
+int main() {
+    NationRegistry registry;
+    TerritoryIndex territory;
+    if (!territory.loadGeoJson("countries.geo.json", registry)) return 1;
+    BorderMap borders(territory);
+    borders.rebuild();
+
+    NationId france = registry.find("FRA"), germany = registry.find("DEU");
+    auto report = [&](NationId n) {
+        logEvent(registry.name(n) + ": " + std::to_string(borders.cellCount(n)) + " cells, " +
+                 std::to_string(static_cast<long>(borders.areaKm2(n))) + " km2, " +
+                 std::to_string(borders.borderCells(n).size()) + " border cells, " +
+                 std::to_string(borders.componentCount(n)) + " components");
+    };
+    report(france);
+    report(germany);
+
+    // Frontline: every tick, random nations capture random neighbouring border cells.
+    std::mt19937 rng(7);
+    const int ticks = 50, capturesPerTick = 4000;
+    double totalUs = 0;
+    for (int t = 0; t < ticks; ++t) {
+        for (int c = 0; c < capturesPerTick; ++c) {
+            NationId victim = static_cast<NationId>(rng() % registry.count());
+            const auto& border = borders.borderCells(victim);
+            if (border.empty()) continue;
+            std::uint32_t cell = border[rng() % border.size()];
+            std::uint32_t cx = cell % territory.width(), cy = cell / territory.width();
+            std::uint32_t probe = static_cast<std::uint32_t>(territory.cellIndex(
+                static_cast<int>((cx + 1) % territory.width()), static_cast<int>(cy)));
+            NationId attacker = territory.cellOwner(probe);
+            borders.queueCaptureCell(cell, attacker == victim ? kNoNation : attacker);
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        borders.applyCaptures();
+        totalUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    }
+    logEvent("Average applyCaptures(): " + std::to_string(static_cast<long>(totalUs / ticks)) + " us for " +
+             std::to_string(capturesPerTick) + " captures/tick");
+
+    // Incremental state must match a from-scratch recomputation.
+    BorderMap reference(territory);
+    auto t0 = std::chrono::steady_clock::now();
+    reference.rebuild();
+    double rebuildUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    logEvent("Full rebuild: " + std::to_string(static_cast<long>(rebuildUs)) + " us");
+
+    int mismatches = 0;
+    for (NationId n = 0; n < registry.count(); ++n) {
+        if (borders.cellCount(n) != reference.cellCount(n) ||
+            borders.componentCount(n) != reference.componentCount(n) ||
+            borders.borderCells(n).size() != reference.borderCells(n).size() ||
+            std::fabs(borders.areaKm2(n) - reference.areaKm2(n)) > 1.0)
+            ++mismatches;
+    }
+    report(france);
+    report(germany);
+    logEvent("Nations with mismatched statistics: " + std::to_string(mismatches));
+    return mismatches == 0 ? 0 : 1;
+}
+#endif
+
+// End of borders.cpp
@@ -0,0 +1,103 @@
+/**************************************************************************************************
+ * borders.h
+ * Incremental Border Maintenance for Conqueror Engine (Header)
+ *
+ * Territory capture happens as cell-level ownership flips on the TerritoryIndex owner grid,
+ * replacing the whole-bounding-box shifts of country_relations.py (simulate_border_movement).
+ * Captures are queued during the tick and applied in one batch; per-nation statistics are then
+ * patched around the flipped cells only:
+ *   - area (cell count and km^2),
+ *   - border-cell lists (cells with a differently owned 4-neighbour),
+ *   - contiguity (number of connected land masses), kept with a union-find over cell labels.
+ *     Gains merge labels in near-constant time; losses re-flood only the components that touched
+ *     a lost cell.
+ *
+ * The grid wraps east-west at the antimeridian. Whether a capture is allowed (war status,
+ * alliances) is decided by the caller before queueing it.
+ *
+ * Exposed Classes:
+ * - BorderMap
+ **************************************************************************************************/
+
+#ifndef BORDERS_H
+#define BORDERS_H
+
+#include "nations.h"
+#include "territory.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class BorderMap {
+public:
+    explicit BorderMap(TerritoryIndex& territory);
+
+    // Full recomputation from the current owner grid. Call once after the territory is loaded.
+    void rebuild();
+
+    // Queues a capture; ownership changes when applyCaptures() runs. Later captures of the
+    // same cell within a batch win.
+    void queueCapture(double lat, double lng, NationId nation);
+    void queueCaptureCell(std::size_t cell, NationId nation);
+
+    /**
+     * @brief Applies all queued captures and patches statistics around the flipped cells.
+     * @return Number of cells whose owner actually changed.
+     */
+    std::size_t applyCaptures();
+
+    // Cells flipped by the most recent applyCaptures() call.
+    const std::vector<std::uint32_t>& changedCells() const { return changed; }
+
+    // Per-nation statistics.
+    std::size_t cellCount(NationId nation) const { return nation < stats.size() ? stats[nation].cells : 0; }
+    double areaKm2(NationId nation) const { return nation < stats.size() ? stats[nation].areaKm2 : 0.0; }
+    std::size_t componentCount(NationId nation) const { return nation < stats.size() ? stats[nation].components : 0; }
+    const std::vector<std::uint32_t>& borderCells(NationId nation) const;
+    bool isBorderCell(std::size_t cell) const { return borderSlot[cell] >= 0; }
+
+private:
+    struct NationStats {
+        std::size_t cells = 0;
+        double areaKm2 = 0.0;
+        std::size_t components = 0;
+        std::vector<std::uint32_t> border;
+    };
+    struct PendingCapture { std::uint32_t cell; NationId nation; };
+
+    static constexpr std::uint32_t kNoLabel = 0xFFFFFFFFu;
+
+    TerritoryIndex& territory;
+    int width, height;
+    std::vector<double> rowAreaKm2;                 // Cell area per grid row.
+    std::vector<NationStats> stats;
+
+    std::vector<std::int32_t> borderSlot;           // Index into stats[owner].border, or -1.
+    std::vector<std::uint32_t> label;               // Union-find label per cell.
+    std::vector<std::uint32_t> parent;              // Union-find forest over labels.
+    std::vector<std::uint32_t> retiredEpoch;        // Batch in which a label root was dissolved.
+    std::vector<std::uint32_t> visitEpoch;          // Flood-fill visit stamps per cell.
+    std::uint32_t epoch = 0;
+
+    std::vector<PendingCapture> pending;
+    std::vector<std::uint32_t> changed;
+    std::vector<NationId> changedFrom;              // Owner of changed[i] before the batch.
+    std::vector<std::pair<std::uint32_t, NationId>> splitSeeds;
+    std::vector<std::uint32_t> floodStack;
+
+    NationStats& statsFor(NationId nation);
+    int neighbours(std::uint32_t cell, std::uint32_t out[4]) const;
+    bool computeBorder(std::uint32_t cell) const;
+    void removeBorder(std::uint32_t cell, NationId owner);
+    void refreshBorder(std::uint32_t cell);
+    std::uint32_t newLabel();
+    std::uint32_t findRoot(std::uint32_t l);
+    void retireRoot(std::uint32_t root, NationId nation);
+    bool isSimpleLoss(std::uint32_t cell, NationId from, std::uint32_t flipEpoch) const;
+    void floodComponent(std::uint32_t seed, NationId nation);
+    void relabelAll();
+};
+
+#endif // BORDERS_H
@@ -10,19 +10,87 @@ SRC_FILES=(
   "gameplay_stitched.cpp"
 )
 
+# Engine subsystems linked into game_engine.cpp, and the data files they read at startup.
+ENGINE_SOURCES=(
+  "territory.cpp"
+  "borders.cpp"
+  "passability.cpp"
+  "diplomacy.cpp"
+  "events.cpp"
+  "modifiers.cpp"
+  "combat.cpp"
+  "government.cpp"
+  "cities.cpp"
+  "worldpack.cpp"
+  "chat.cpp"
+  "behavior_tree.cpp"
+  "unit_ai.cpp"
+  "ai_scheduler.cpp"
+  "influence.cpp"
+  "recruitment.cpp"
+  "steering.cpp"
+  "territory_router.cpp"
+  "movement.cpp"
+  "city_index.cpp"
+  "road_network.cpp"
+  "marker_clusters.cpp"
+  "geo.cpp"
+  "json_reader.cpp"
+)
+ENGINE_DATA=(
+  --preload-file world.pack
+)
+
+# Sources linked into gameplay_stitched.cpp.
+STITCHED_SOURCES=(
+  "resource_loader.cpp"
+  "resource_cache.cpp"
+  "asset_store.cpp"
+  "chat.cpp"
+  "json_reader.cpp"
+)
+# Assets are fetched on demand instead of preloaded, so they are served from the output directory.
+STITCHED_FLAGS=(
+  -s FETCH=1
+  -lidbfs.js
+  --preload-file resources.manifest
+)
+
 # Create output directory if it doesn't exist
 mkdir -p "$OUTPUT_DIR"
 
+# Offline step: convert country outlines, cities and unit variants into world.pack (native build).
+echo "Building world.pack..."
+"${HOSTCXX:-g++}" -std=c++17 -O2 -DWORLDPACK_BUILD \
+  worldpack.cpp territory.cpp cities.cpp json_reader.cpp units.cpp movement.cpp geo.cpp -o "$OUTPUT_DIR/worldpack-build"
+"$OUTPUT_DIR/worldpack-build" world.pack countries.geo.json data/cities.json
+
+# Offline step: hash every asset into resources.manifest for the resource cache.
+echo "Building resources.manifest..."
+"${HOSTCXX:-g++}" -std=c++17 -O2 -DRESOURCE_MANIFEST_BUILD resource_cache.cpp -o "$OUTPUT_DIR/resource-manifest"
+find assets -type f 2>/dev/null | xargs "$OUTPUT_DIR/resource-manifest" resources.manifest
+
 # Build loop
 for src_file in "${SRC_FILES[@]}"; do
   base_name=$(basename "$src_file" .cpp)
+  extra_args=()
+  if [ "$base_name" = "game_engine" ]; then
+    extra_args=("${ENGINE_SOURCES[@]}" "${ENGINE_DATA[@]}")
+  elif [ "$base_name" = "gameplay_stitched" ]; then
+    extra_args=("${STITCHED_SOURCES[@]}" "${STITCHED_FLAGS[@]}")
+  fi
   echo "Building $src_file..."
-  emcc "$src_file" -O2 \
+  emcc "$src_file" "${extra_args[@]}" -O2 -msimd128 -std=c++17 \
     -s WASM=1 \
     -s USE_PTHREADS=1 \
     -s "EXPORTED_RUNTIME_METHODS=['ccall','cwrap','FS']" \
-    --preload-file assets \
     -o "$OUTPUT_DIR/${base_name}.html"
 done
 
+# Served next to the page for on-demand loading.
+if [ -d assets ]; then
+  cp -r assets "$OUTPUT_DIR/"
+fi
+cp config.json "$OUTPUT_DIR/"
+
 echo "Build complete. Output files are in '$OUTPUT_DIR'"
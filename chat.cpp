@@ -0,0 +1,346 @@
+/*
+ * chat.cpp - Lock-free MPSC chat queue over a pooled message free list, with per-lobby ring history.
+ */
+
+#include "chat.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
+    std::cout << "[" << level << "] " << message << std::endl;
+}
+
+ChatHub::ChatHub(std::size_t poolSize, std::size_t historyPerLobby)
+    : nodes(new Node[poolSize ? poolSize : 1]), nodeCount(poolSize ? poolSize : 1),
+      historyCapacity(historyPerLobby), head(&stub), tail(&stub) {
+    for (std::size_t i = 0; i < nodeCount; ++i)
+        nodes[i].nextFree.store(i + 1 < nodeCount ? static_cast<std::uint32_t>(i + 2) : 0, std::memory_order_relaxed);
+    freeHead.store(1, std::memory_order_relaxed);
+    batch.reserve(nodeCount);
+}
+
+ChatHub::~ChatHub() = default;
+
+ChatLobbyId ChatHub::openLobby(const std::string& name) {
+    ChatLobbyId existing = findLobby(name);
+    if (existing != kNoLobby) return existing;
+    lobbies.push_back({name, ChatHistory(historyCapacity)});
+    openLobbies.store(lobbies.size(), std::memory_order_release);
+    return static_cast<ChatLobbyId>(lobbies.size() - 1);
+}
+
+ChatLobbyId ChatHub::findLobby(const std::string& name) const {
+    for (std::size_t i = 0; i < lobbies.size(); ++i)
+        if (lobbies[i].name == name) return static_cast<ChatLobbyId>(i);
+    return kNoLobby;
+}
+
+const std::string& ChatHub::lobbyName(ChatLobbyId lobby) const {
+    static const std::string unknown;
+    return lobby < lobbies.size() ? lobbies[lobby].name : unknown;
+}
+
+ChatHub::Node* ChatHub::allocate() {
+    std::uint64_t current = freeHead.load(std::memory_order_acquire);
+    for (;;) {
+        std::uint32_t index = static_cast<std::uint32_t>(current);
+        if (index == 0) return nullptr;
+        Node* node = &nodes[index - 1];
+        // The tag changes on every pop, so a node popped and pushed back in between fails the CAS.
+        std::uint64_t next = ((current >> 32) + 1) << 32 | node->nextFree.load(std::memory_order_relaxed);
+        if (freeHead.compare_exchange_weak(current, next, std::memory_order_acq_rel, std::memory_order_acquire))
+            return node;
+    }
+}
+
+void ChatHub::recycle(Node* node) {
+    std::uint32_t index = static_cast<std::uint32_t>(node - nodes.get()) + 1;
+    std::uint64_t current = freeHead.load(std::memory_order_relaxed);
+    for (;;) {
+        node->nextFree.store(static_cast<std::uint32_t>(current), std::memory_order_relaxed);
+        std::uint64_t next = (current & 0xFFFFFFFF00000000ull) | index;
+        if (freeHead.compare_exchange_weak(current, next, std::memory_order_release, std::memory_order_relaxed))
+            return;
+    }
+}
+
+void ChatHub::enqueue(Node* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    Node* previous = head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+}
+
+ChatHub::Node* ChatHub::dequeue() {
+    Node* current = tail;
+    Node* next = current->next.load(std::memory_order_acquire);
+    if (current == &stub) {
+        if (!next) return nullptr;
+        tail = next;
+        current = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next) {
+        tail = next;
+        return current;
+    }
+    // `current` is the last linked node; a producer may be between its exchange and its link.
+    if (current != head.load(std::memory_order_acquire)) return nullptr;
+    enqueue(&stub);
+    next = current->next.load(std::memory_order_acquire);
+    if (next) {
+        tail = next;
+        return current;
+    }
+    return nullptr;
+}
+
+bool ChatHub::post(ChatLobbyId lobby, std::string_view sender, std::string_view text) {
+    Node* node = lobby < openLobbies.load(std::memory_order_acquire) ? allocate() : nullptr;
+    if (!node) {
+        dropCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    ChatMessage& message = node->message;
+    message.lobby = lobby;
+    message.textLength = static_cast<std::uint16_t>(std::min(text.size(), ChatMessage::kMaxText));
+    std::memcpy(message.text, text.data(), message.textLength);
+    std::size_t senderLength = std::min(sender.size(), ChatMessage::kMaxSender);
+    std::memcpy(message.sender, sender.data(), senderLength);
+    message.sender[senderLength] = '\0';
+    message.timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    enqueue(node);
+    return true;
+}
+
+std::size_t ChatHub::pump(const ChatBatchSink& sink) {
+    batch.clear();
+    while (Node* node = dequeue()) {
+        batch.push_back(node->message);
+        recycle(node);
+    }
+    for (ChatMessage& message : batch) {
+        message.sequence = nextSequence++;
+        lobbies[message.lobby].history.append(message);
+    }
+    deliveredCount += batch.size();
+    if (sink && !batch.empty()) sink(batch.data(), batch.size());
+    return batch.size();
+}
+
+#ifndef __EMSCRIPTEN__
+std::size_t FdChatInput::poll(std::vector<std::string>& lines) {
+    std::size_t before = lines.size();
+    char buffer[4096];
+    while (active) {
+        pollfd request = {fd, POLLIN, 0};
+        if (::poll(&request, 1, 0) <= 0 || !(request.revents & (POLLIN | POLLHUP))) break;
+        ssize_t got = ::read(fd, buffer, sizeof(buffer));
+        if (got <= 0) {
+            active = false;         // End of file or a closed descriptor.
+            break;
+        }
+        partial.append(buffer, static_cast<std::size_t>(got));
+        std::size_t start = 0;
+        for (std::size_t end; (end = partial.find('\n', start)) != std::string::npos; start = end + 1) {
+            std::size_t length = end - start;
+            if (length && partial[end - 1] == '\r') --length;
+            lines.emplace_back(partial, start, length);
+        }
+        partial.erase(0, start);
+    }
+    if (!active && !partial.empty()) {
+        lines.push_back(partial);
+        partial.clear();
+    }
+    return lines.size() - before;
+}
+
+std::unique_ptr<ChatInput> makeChatInput() {
+    return std::unique_ptr<ChatInput>(new FdChatInput(STDIN_FILENO));
+}
+#else
+extern "C" EMSCRIPTEN_KEEPALIVE void chatPortMessage(PortChatInput* input, const char* text) {
+    input->receive(text);
+}
+
+bool PortChatInput::open() {
+    // The port lives on the browser thread; its handler posts straight into the lock-free inbox.
+    MAIN_THREAD_EM_ASM({
+        var channel = new MessageChannel();
+        channel.port1.onmessage = function(event) {
+            var text = String(event.data);
+            var bytes = lengthBytesUTF8(text) + 1;
+            var ptr = _malloc(bytes);
+            stringToUTF8(text, ptr, bytes);
+            Module._chatPortMessage($0, ptr);
+            _free(ptr);
+        };
+        Module.chatPort = channel.port2;
+        Module.chatPortOwner = channel.port1;
+    }, this);
+    active = true;
+    return true;
+}
+
+void PortChatInput::close() {
+    if (!active) return;
+    active = false;
+    MAIN_THREAD_EM_ASM({
+        if (Module.chatPortOwner) Module.chatPortOwner.close();
+        Module.chatPort = null;
+        Module.chatPortOwner = null;
+    });
+}
+
+std::size_t PortChatInput::poll(std::vector<std::string>& lines) {
+    std::size_t before = lines.size();
+    inbox.pump([&lines](const ChatMessage* messages, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) lines.emplace_back(messages[i].body());
+    });
+    return lines.size() - before;
+}
+
+std::unique_ptr<ChatInput> makeChatInput() {
+    return std::unique_ptr<ChatInput>(new PortChatInput());
+}
+#endif
+
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DCHAT_TEST)
+// Several producer threads post while the consumer pumps; checks per-producer order, that every
+// post is delivered or counted as dropped, and the bounded history. Compares against the old
+// mutex + vector<string> queue.
+//   g++ -std=c++17 -O2 -pthread -DCHAT_TEST chat.cpp -o chat_test
+#ifdef CHAT_TEST
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+int main() {
+    const int producers = 4;
+    const int perProducer = 200000;
+    auto ms = [](std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    };
+    int failures = 0;
+
+    // Time the consuming (tick) thread spends draining, including waiting for the lock.
+    double mutexTickMs = 0.0, hubTickMs = 0.0;
+
+    // Old path: vector<string> under one mutex, drained by the consumer.
+    auto t0 = std::chrono::steady_clock::now();
+    {
+        std::mutex mtx;
+        std::vector<std::string> queue;
+        std::atomic<int> done{0};
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p)
+            threads.emplace_back([&, p]() {
+                for (int i = 0; i < perProducer; ++i) {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    queue.push_back("player" + std::to_string(p) + ": message " + std::to_string(i));
+                }
+                ++done;
+            });
+        std::size_t received = 0;
+        while (done.load() < producers || !queue.empty()) {
+            auto drain = std::chrono::steady_clock::now();
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                received += queue.size();
+                queue.clear();
+            }
+            mutexTickMs += ms(drain);
+            std::this_thread::yield();
+        }
+        for (std::thread& thread : threads) thread.join();
+        failures += received != static_cast<std::size_t>(producers) * perProducer;
+    }
+    double mutexMs = ms(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    ChatHub hub(4096, 64);
+    ChatLobbyId lobbies[2] = {hub.openLobby("ROOM-0"), hub.openLobby("ROOM-1")};
+    std::atomic<int> done{0};
+    std::atomic<std::uint64_t> retries{0};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+        threads.emplace_back([&, p]() {
+            std::string sender = "player" + std::to_string(p);
+            char text[32];
+            for (int i = 0; i < perProducer; ++i) {
+                int length = std::snprintf(text, sizeof(text), "%d", i);
+                // Retry when the pool is full so the test can check every message arrives.
+                while (!hub.post(lobbies[p % 2], sender, std::string_view(text, length))) {
+                    ++retries;
+                    std::this_thread::yield();
+                }
+            }
+            ++done;
+        });
+    std::vector<int> lastSeen(producers, -1);
+    std::size_t batches = 0;
+    auto sink = [&](const ChatMessage* messages, std::size_t count) {
+        ++batches;
+        for (std::size_t i = 0; i < count; ++i) {
+            int p = messages[i].sender[6] - '0';
+            int value = std::atoi(std::string(messages[i].body()).c_str());
+            failures += value != lastSeen[p] + 1;
+            lastSeen[p] = value;
+        }
+    };
+    while (done.load() < producers) {
+        auto drain = std::chrono::steady_clock::now();
+        hub.pump(sink);
+        hubTickMs += ms(drain);
+        std::this_thread::yield();
+    }
+    for (std::thread& thread : threads) thread.join();
+    hub.pump(sink);
+    double hubMs = ms(t0);
+
+    const std::uint64_t total = static_cast<std::uint64_t>(producers) * perProducer;
+    failures += hub.delivered() != total || hub.dropped() != retries.load();
+    for (int p = 0; p < producers; ++p) failures += lastSeen[p] != perProducer - 1;
+    const ChatHistory& history = hub.history(lobbies[0]);
+    failures += history.size() != history.capacity();
+    failures += history.latest().sequence <= history.at(0).sequence;
+    failures += hub.post(kNoLobby, "x", "unknown lobby");
+
+    // Non-blocking input: partial lines wait for their newline, end of file closes the channel.
+    int pipeEnds[2];
+    failures += ::pipe(pipeEnds) != 0;
+    FdChatInput input(pipeEnds[0]);
+    input.open();
+    std::vector<std::string> lines;
+    auto pollStart = std::chrono::steady_clock::now();
+    failures += input.poll(lines) != 0;                     // Nothing written: returns at once.
+    double idlePollMs = ms(pollStart);
+    failures += ::write(pipeEnds[1], "hello\r\nwor", 10) != 10;
+    failures += input.poll(lines) != 1 || lines.back() != "hello";
+    failures += ::write(pipeEnds[1], "ld\n/exit", 8) != 8;
+    ::close(pipeEnds[1]);
+    input.poll(lines);
+    failures += lines.size() != 3 || lines[1] != "world" || lines[2] != "/exit" || input.isOpen();
+    ::close(pipeEnds[0]);
+
+    std::cout << total << " messages: mutex+vector " << mutexMs << " ms (tick " << mutexTickMs << " ms), hub "
+              << hubMs << " ms (tick " << hubTickMs << " ms) in " << batches << " batches, " << retries.load()
+              << " full-pool retries; idle input poll " << idlePollMs << " ms; failures: " << failures << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+// End of chat.cpp
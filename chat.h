@@ -0,0 +1,214 @@
+/**************************************************************************************************
+ * chat.h
+ * Lobby Chat Queue for Conqueror Engine (Header)
+ *
+ * Chat used to be a vector<string> that the input thread filled and the tick printed and cleared
+ * under one mutex. ChatHub keeps chat traffic off the simulation's locks:
+ *   - messages are fixed-size ChatMessage records taken from a preallocated pool (lock-free free
+ *     list), so posting never allocates;
+ *   - any thread posts into an intrusive multi-producer / single-consumer queue (one atomic
+ *     exchange per post, no lock);
+ *   - the tick thread pumps the queue: each drained message is appended in O(1) to a bounded
+ *     per-lobby ring-buffer history, the whole batch is handed to the network/output sink in one
+ *     call, and the pool records are recycled.
+ * When the pool is exhausted a post is dropped and counted rather than blocking the poster.
+ *
+ * Chat input comes from a ChatInput channel that the tick polls without blocking, so no thread is
+ * parked on stdin and shutdown is immediate:
+ *   - natively, FdChatInput polls a file descriptor (stdin by default) and reads whole lines;
+ *   - in WASM, PortChatInput receives lines posted by the page on a MessageChannel
+ *     (Module.chatPort.postMessage(text)).
+ *
+ * Exposed Types:
+ * - ChatLobbyId / ChatMessage / ChatBatchSink
+ * - ChatHistory
+ * - ChatHub
+ * - ChatInput / FdChatInput / PortChatInput / makeChatInput
+ **************************************************************************************************/
+
+#ifndef CHAT_H
+#define CHAT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using ChatLobbyId = std::uint16_t;
+constexpr ChatLobbyId kNoLobby = 0xFFFF;
+
+//-------------------------------------------------
+// Chat Message (fixed-size record)
+//-------------------------------------------------
+struct ChatMessage {
+    static constexpr std::size_t kMaxText = 240;     // Longer messages are truncated.
+    static constexpr std::size_t kMaxSender = 31;
+
+    ChatLobbyId lobby = kNoLobby;
+    std::uint16_t textLength = 0;
+    std::uint32_t sequence = 0;                      // Assigned by ChatHub::pump(), per hub.
+    std::int64_t timeMs = 0;                         // Wall clock at post time.
+    char sender[kMaxSender + 1] = {};
+    char text[kMaxText] = {};
+
+    std::string_view body() const { return std::string_view(text, textLength); }
+    std::string_view from() const { return std::string_view(sender); }
+};
+
+// Receives each pumped batch, in post order per producer. `messages` is valid for the call only.
+using ChatBatchSink = std::function<void(const ChatMessage* messages, std::size_t count)>;
+
+//-------------------------------------------------
+// Chat History (bounded ring per lobby)
+//-------------------------------------------------
+class ChatHistory {
+public:
+    explicit ChatHistory(std::size_t capacity = 256) : ring(capacity ? capacity : 1) {}
+
+    // O(1); overwrites the oldest message once full.
+    void append(const ChatMessage& message) {
+        ring[(first + count) % ring.size()] = message;
+        if (count < ring.size()) ++count;
+        else first = (first + 1) % ring.size();
+    }
+    std::size_t size() const { return count; }
+    std::size_t capacity() const { return ring.size(); }
+    // i = 0 is the oldest message kept.
+    const ChatMessage& at(std::size_t i) const { return ring[(first + i) % ring.size()]; }
+    const ChatMessage& latest() const { return at(count - 1); }
+
+private:
+    std::vector<ChatMessage> ring;
+    std::size_t first = 0;
+    std::size_t count = 0;
+};
+
+//-------------------------------------------------
+// Chat Hub
+//-------------------------------------------------
+class ChatHub {
+public:
+    /**
+     * @param poolSize Messages that can be in flight between posts and the next pump.
+     * @param historyPerLobby Messages kept per lobby.
+     */
+    explicit ChatHub(std::size_t poolSize = 1024, std::size_t historyPerLobby = 256);
+    ~ChatHub();
+    ChatHub(const ChatHub&) = delete;
+    ChatHub& operator=(const ChatHub&) = delete;
+
+    // Registers a lobby (or returns the existing id). Call from the tick thread, before posting to it.
+    ChatLobbyId openLobby(const std::string& name);
+    ChatLobbyId findLobby(const std::string& name) const;
+    const std::string& lobbyName(ChatLobbyId lobby) const;
+    std::size_t lobbyCount() const { return lobbies.size(); }
+
+    /**
+     * @brief Queues a message. Safe from any thread; lock-free and allocation-free.
+     * @return False (and counts a drop) if the pool is exhausted or the lobby is unknown.
+     */
+    bool post(ChatLobbyId lobby, std::string_view sender, std::string_view text);
+
+    /**
+     * @brief Drains everything posted so far (call from the tick thread only): appends each message
+     * to its lobby history, then hands the batch to `sink` in one call.
+     * @return Number of messages drained.
+     */
+    std::size_t pump(const ChatBatchSink& sink = nullptr);
+
+    const ChatHistory& history(ChatLobbyId lobby) const { return lobbies[lobby].history; }
+    std::uint64_t dropped() const { return dropCount.load(std::memory_order_relaxed); }
+    std::uint64_t delivered() const { return deliveredCount; }
+
+private:
+    struct Node {
+        ChatMessage message;
+        std::atomic<Node*> next{nullptr};            // Queue link.
+        std::atomic<std::uint32_t> nextFree{0};      // Free-list link (index + 1, 0 = end).
+    };
+    struct Lobby {
+        std::string name;
+        ChatHistory history;
+    };
+
+    std::unique_ptr<Node[]> nodes;
+    std::size_t nodeCount;
+    std::size_t historyCapacity;
+    // Free list head: (ABA tag << 32) | (index + 1).
+    std::atomic<std::uint64_t> freeHead{0};
+    // Intrusive MPSC queue: producers exchange `head`, the consumer owns `tail`.
+    Node stub;
+    std::atomic<Node*> head;
+    Node* tail;
+    std::vector<Lobby> lobbies;
+    std::atomic<std::size_t> openLobbies{0};         // Published lobby count for post().
+    std::vector<ChatMessage> batch;                  // Reused by pump().
+    std::uint32_t nextSequence = 1;
+    std::uint64_t deliveredCount = 0;
+    std::atomic<std::uint64_t> dropCount{0};
+
+    Node* allocate();
+    void recycle(Node* node);
+    void enqueue(Node* node);
+    Node* dequeue();
+};
+
+//-------------------------------------------------
+// Chat Input Channels (non-blocking)
+//-------------------------------------------------
+class ChatInput {
+public:
+    virtual ~ChatInput() = default;
+    virtual bool open() = 0;
+    // Appends every complete line received since the last poll. Never blocks.
+    virtual std::size_t poll(std::vector<std::string>& lines) = 0;
+    // Stops reading. Returns immediately; safe to call more than once.
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+};
+
+#ifndef __EMSCRIPTEN__
+// Lines from a file descriptor, checked with poll() and a zero timeout. End of file closes it.
+class FdChatInput : public ChatInput {
+public:
+    explicit FdChatInput(int fd = 0) : fd(fd) {}
+    bool open() override { active = fd >= 0; return active; }
+    std::size_t poll(std::vector<std::string>& lines) override;
+    void close() override { active = false; }
+    bool isOpen() const override { return active; }
+
+private:
+    int fd;
+    bool active = false;
+    std::string partial;            // Bytes after the last newline.
+};
+#else
+// Lines posted by the page on Module.chatPort (a MessageChannel port). They are queued through a
+// ChatHub, so the browser thread never waits on the tick.
+class PortChatInput : public ChatInput {
+public:
+    PortChatInput() : inbox(256, 1) { channel = inbox.openLobby("input"); }
+    ~PortChatInput() override { close(); }
+    bool open() override;
+    std::size_t poll(std::vector<std::string>& lines) override;
+    void close() override;
+    bool isOpen() const override { return active; }
+
+    // Called from the port's message handler.
+    void receive(const char* text) { inbox.post(channel, "", text); }
+
+private:
+    ChatHub inbox;
+    ChatLobbyId channel;
+    bool active = false;
+};
+#endif
+
+// The platform's default channel: stdin natively, the page's message port in WASM.
+std::unique_ptr<ChatInput> makeChatInput();
+
+#endif // CHAT_H
@@ -0,0 +1,257 @@
+/*
+ * cities.cpp - SoA city columns, vectorizable growth/economy step and per-nation income.
+ */
+
+#include "cities.h"
+#include "worldpack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
+    std::cout << "[" << level << "] " << message << std::endl;
+}
+
+namespace {
+
+inline std::uint32_t hashIndex(std::uint32_t index, std::uint32_t salt) {
+    std::uint32_t h = (index ^ salt) * 0x9E3779B1u;
+    h ^= h >> 15;
+    h *= 0x85EBCA77u;
+    h ^= h >> 13;
+    h *= 0xC2B2AE3Du;
+    h ^= h >> 16;
+    return h;
+}
+
+// Uniform draw in [lo, hi) from one 8-bit lane of a hash.
+inline double lane(std::uint32_t h, int laneIndex, double lo, double hi) {
+    return lo + (hi - lo) * (((h >> (laneIndex * 8)) & 0xFF) / 256.0);
+}
+
+} // namespace
+
+bool CitySystem::loadJson(const std::string& path, const OwnerResolver& resolveOwner, std::uint32_t seed) {
+    JsonValue root;
+    std::string error;
+    if (!loadJsonFile(path, root, &error)) {
+        logEvent("CitySystem: Failed to load " + path + ": " + error, "ERROR");
+        return false;
+    }
+    return loadJson(root, resolveOwner, seed);
+}
+
+bool CitySystem::loadJson(const JsonValue& root, const OwnerResolver& resolveOwner, std::uint32_t seed) {
+    if (!root.isArray()) {
+        logEvent("CitySystem: Expected a list of countries.", "ERROR");
+        return false;
+    }
+    *this = CitySystem();
+    std::uint32_t serial = 0;
+    for (const JsonValue& country : root.array) {
+        const JsonValue* cities = country.find("cities");
+        if (!cities || !cities->isArray()) continue;
+        std::string code = country.stringOr("code", "");
+        std::string countryName = country.stringOr("name", "");
+        int rank = 0;
+        for (const JsonValue& city : cities->array) {
+            const JsonValue* latValue = city.find("lat");
+            const JsonValue* lngValue = city.find("lng");
+            if (!latValue || !lngValue || !latValue->isNumber() || !lngValue->isNumber()) continue;
+            double lat = latValue->number;
+            double lng = lngValue->number;
+            addSeededCity(city.stringOr("name", ""), lat, lng, resolveOwner(code, countryName, lat, lng), serial++,
+                          rank++, seed);
+        }
+    }
+    logEvent("CitySystem: Loaded " + std::to_string(count()) + " cities.");
+    return true;
+}
+
+bool CitySystem::loadPack(const WorldPack& pack, const OwnerResolver& resolveOwner, std::uint32_t seed) {
+    std::size_t countryCount = 0, nameCount = 0, latCount = 0, lngCount = 0;
+    const PackCityCountry* countries = pack.section<PackCityCountry>(WorldPackSection::CityCountries, &countryCount);
+    const std::uint32_t* cityNames = pack.section<std::uint32_t>(WorldPackSection::CityNames, &nameCount);
+    const double* cityLat = pack.section<double>(WorldPackSection::CityLat, &latCount);
+    const double* cityLng = pack.section<double>(WorldPackSection::CityLng, &lngCount);
+    bool consistent = countries && cityNames && cityLat && cityLng && latCount == nameCount && lngCount == nameCount;
+    for (std::size_t c = 0; consistent && c < countryCount; ++c)
+        consistent = countries[c].firstCity + countries[c].cityCount <= nameCount;
+    if (!consistent) {
+        logEvent("CitySystem: World pack has missing or inconsistent city sections.", "ERROR");
+        return false;
+    }
+    *this = CitySystem();
+    names.reserve(nameCount);
+    std::uint32_t serial = 0;
+    for (std::size_t c = 0; c < countryCount; ++c) {
+        std::string code = pack.string(countries[c].code);
+        std::string countryName = pack.string(countries[c].name);
+        for (std::uint32_t k = 0; k < countries[c].cityCount; ++k) {
+            std::uint32_t i = countries[c].firstCity + k;
+            addSeededCity(pack.string(cityNames[i]), cityLat[i], cityLng[i],
+                          resolveOwner(code, countryName, cityLat[i], cityLng[i]), serial++, static_cast<int>(k), seed);
+        }
+    }
+    logEvent("CitySystem: Loaded " + std::to_string(count()) + " cities from the world pack.");
+    return true;
+}
+
+bool CitySystem::writePack(const JsonValue& root, WorldPackWriter& writer) {
+    if (!root.isArray()) return false;
+    std::vector<PackCityCountry> countries;
+    std::vector<std::uint32_t> cityNames;
+    std::vector<double> cityLat, cityLng;
+    for (const JsonValue& country : root.array) {
+        const JsonValue* cities = country.find("cities");
+        if (!cities || !cities->isArray()) continue;
+        PackCityCountry entry{writer.addString(country.stringOr("code", "")),
+                              writer.addString(country.stringOr("name", "")),
+                              static_cast<std::uint32_t>(cityNames.size()), 0};
+        // Same filter as loadJson(), so serials (and therefore seeded stats) line up.
+        for (const JsonValue& city : cities->array) {
+            const JsonValue* latValue = city.find("lat");
+            const JsonValue* lngValue = city.find("lng");
+            if (!latValue || !lngValue || !latValue->isNumber() || !lngValue->isNumber()) continue;
+            cityNames.push_back(writer.addString(city.stringOr("name", "")));
+            cityLat.push_back(latValue->number);
+            cityLng.push_back(lngValue->number);
+            ++entry.cityCount;
+        }
+        countries.push_back(entry);
+    }
+    writer.addSection(WorldPackSection::CityCountries, countries);
+    writer.addSection(WorldPackSection::CityNames, cityNames);
+    writer.addSection(WorldPackSection::CityLat, cityLat);
+    writer.addSection(WorldPackSection::CityLng, cityLng);
+    return true;
+}
+
+void CitySystem::addSeededCity(const std::string& name, double lat, double lng, NationId owner, std::uint32_t serial,
+                               int rank, std::uint32_t seed) {
+    std::uint32_t h = hashIndex(serial, seed);
+    // Countries list their largest cities first; scale the starting population by rank.
+    double population = lane(h, 0, 2.0e5, 3.0e6) * (rank == 0 ? 2.5 : 1.0 / (1.0 + 0.3 * rank));
+    addCity(name, lat, lng, owner, std::floor(population), 3 + static_cast<int>(lane(h, 1, 0, 6)),
+            lane(h, 2, 0.9, 1.1), lane(h, 3, 0.9, 1.1), 0.01 + 0.025 * ((h >> 4) & 0xFF) / 256.0);
+}
+
+std::size_t CitySystem::addCity(const std::string& name, double lat, double lng, NationId owner, double population,
+                                int infrastructure, double economicIndex, double defenseIndex, double growthRate) {
+    names.push_back(name);
+    lats.push_back(lat);
+    lngs.push_back(lng);
+    owners.push_back(owner);
+    growthRates.push_back(growthRate);
+    populations.push_back(population);
+    infrastructures.push_back(std::min(10, std::max(1, infrastructure)));
+    economicIndices.push_back(economicIndex);
+    defenseIndices.push_back(defenseIndex);
+    stepFactors.push_back(1.0);
+    productions.push_back(0.0);
+    refreshStepFactor(names.size() - 1);
+    return names.size() - 1;
+}
+
+void CitySystem::refreshStepFactor(std::size_t city) {
+    double effectiveGrowth = growthRates[city] * (1.0 + infrastructures[city] / 20.0);
+    stepFactors[city] = std::pow(1.0 + effectiveGrowth, stepYears);
+}
+
+void CitySystem::setYearsPerStep(double years) {
+    stepYears = years;
+    for (std::size_t i = 0; i < count(); ++i) refreshStepFactor(i);
+}
+
+void CitySystem::stepRange(std::size_t begin, std::size_t end) {
+    end = std::min(end, count());
+    double* population = populations.data();
+    double* produced = productions.data();
+    const double* factor = stepFactors.data();
+    const double* infra = infrastructures.data();
+    const double* econ = economicIndices.data();
+    // simulate_growth() + update_economy(): multiply/add only, no branches or calls.
+    for (std::size_t i = begin; i < end; ++i) {
+        double grown = population[i] * factor[i];
+        population[i] = grown;
+        produced[i] = grown * 0.01 * (1.0 + (infra[i] * 0.1) * econ[i]);
+    }
+}
+
+void CitySystem::aggregateIncome(std::size_t nationCount) {
+    incomes.assign(nationCount, 0.0);
+    for (std::size_t i = 0; i < count(); ++i)
+        if (owners[i] < nationCount) incomes[owners[i]] += productions[i];
+}
+
+void CitySystem::step(std::size_t nationCount) {
+    stepRange(0, count());
+    aggregateIncome(nationCount);
+}
+
+bool CitySystem::improveInfrastructure(std::size_t city, double investment) {
+    if (city >= count()) return false;
+    double baseCost = 100000.0 * infrastructures[city];
+    if (investment < baseCost || infrastructures[city] >= 10) return false;
+    infrastructures[city] += 1;
+    economicIndices[city] *= 1.05;
+    defenseIndices[city] *= 1.05;
+    refreshStepFactor(city);
+    return true;
+}
+
+void CitySystem::updateDefense(std::size_t city, double modifier) {
+    if (city < count()) defenseIndices[city] *= (1.0 + modifier);
+}
+
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DCITIES_TEST)
+// Replays cities_model.py's standalone run, then times data/cities.json steps.
+// Compile: g++ -std=c++17 -O2 -DCITIES_TEST cities.cpp worldpack.cpp json_reader.cpp
+#ifdef CITIES_TEST
+#include <chrono>
+#include <iomanip>
+
+int main() {
+    NationRegistry registry;
+    NationId home = registry.intern("US", "United States");
+
+    CitySystem manager;
+    std::size_t metropolis = manager.addCity("Metropolis", 40.7128, -74.0060, home, 1000000, 5, 1.0, 1.0, 0.03);
+    std::size_t gotham = manager.addCity("Gotham", 34.0522, -118.2437, home, 750000, 4, 0.95, 1.1, 0.025);
+    manager.addCity("Star City", 41.8781, -87.6298, home, 500000, 3, 1.1, 0.9, 0.035);
+    auto dump = [&]() {
+        for (std::size_t i = 0; i < manager.count(); ++i)
+            std::cout << manager.name(i) << " | Pop: " << std::fixed << std::setprecision(0) << manager.population(i)
+                      << " | Infra: " << manager.infrastructure(i) << " | Econ: " << std::setprecision(2)
+                      << manager.economicIndex(i) << " | Def: " << manager.defenseIndex(i) << std::endl;
+    };
+    dump();
+    manager.setYearsPerStep(1.0);
+    manager.step(registry.count());
+    dump();
+    std::cout << "Metropolis production: " << manager.production(metropolis) << ", nation income: "
+              << manager.incomeOf(home) << std::endl;
+    std::cout << "Upgrade Gotham with 500000: " << (manager.improveInfrastructure(gotham, 500000) ? "ok" : "refused")
+              << std::endl;
+    int failures = std::fabs(manager.population(metropolis) - 1000000 * (1 + 0.03 * 1.25)) > 1e-3 ? 1 : 0;
+
+    // Full data set: owners interned from the listed country.
+    CitySystem world;
+    auto resolver = [&](const std::string& code, const std::string& country, double, double) {
+        return registry.intern(code, country);
+    };
+    if (!world.loadJson("data/cities.json", resolver)) return 1;
+    world.setYearsPerStep(1.0 / (365 * 43200.0));   // One engine tick.
+    const int steps = 100000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; ++s) world.step(registry.count());
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << world.count() << " cities, " << registry.count() << " nations: " << std::setprecision(3)
+              << us / steps << " us/step" << std::endl;
+    return failures;
+}
+#endif
+
+// End of cities.cpp
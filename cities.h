@@ -0,0 +1,119 @@
+/**************************************************************************************************
+ * cities.h
+ * City Simulation for Conqueror Engine (Header)
+ *
+ * Native counterpart of cities_model.py's CityManager. All cities from data/cities.json live in
+ * structure-of-arrays columns (population, infrastructure, economic index, defense index, growth,
+ * owner), and one step advances simulate_growth() and update_economy() for every city:
+ *   - each city's per-step growth factor (1 + growth * (1 + infra / 20)) ^ yearsPerStep is cached
+ *     and only recomputed when infrastructure, growth or the time step changes, so the hot loop is
+ *     multiply/add only and vectorizes;
+ *   - stepRange() touches disjoint index ranges, so the pass can be split across workers;
+ *   - production is then summed per owner into a dense per-nation income column.
+ *
+ * data/cities.json carries names and coordinates only; starting population and indices are drawn
+ * deterministically per city (larger for a country's first-listed cities). The same list can be
+ * read from world.pack (worldpack.h) without parsing.
+ *
+ * Exposed Classes:
+ * - CitySystem
+ **************************************************************************************************/
+
+#ifndef CITIES_H
+#define CITIES_H
+
+#include "nations.h"
+#include "json_reader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class WorldPack;
+class WorldPackWriter;
+
+//-------------------------------------------------
+// City System
+//-------------------------------------------------
+class CitySystem {
+public:
+    // Maps a city's listed country (ISO alpha-2 code and name) and position to its owning nation.
+    using OwnerResolver = std::function<NationId(const std::string& code, const std::string& country,
+                                                 double lat, double lng)>;
+
+    /**
+     * @brief Loads every city from a cities.json document, replacing the current set.
+     * @return false if the file is missing or malformed.
+     */
+    bool loadJson(const std::string& path, const OwnerResolver& resolveOwner, std::uint32_t seed = 1);
+    bool loadJson(const JsonValue& root, const OwnerResolver& resolveOwner, std::uint32_t seed = 1);
+    // Same cities (and the same seeded starting stats) from a world pack's city sections.
+    bool loadPack(const WorldPack& pack, const OwnerResolver& resolveOwner, std::uint32_t seed = 1);
+    // Converts a cities.json document into world pack sections (offline builder).
+    static bool writePack(const JsonValue& root, WorldPackWriter& writer);
+
+    // Appends one city (cities_model.py's City constructor). Returns its index.
+    std::size_t addCity(const std::string& name, double lat, double lng, NationId owner, double population,
+                        int infrastructure, double economicIndex, double defenseIndex, double growthRate);
+
+    // Length of one step in simulated years; refreshes the cached growth factors.
+    void setYearsPerStep(double years);
+    double yearsPerStep() const { return stepYears; }
+
+    // Advances every city one step and recomputes per-nation income.
+    void step(std::size_t nationCount);
+    // Growth and production for cities [begin, end) only; safe to run on disjoint ranges in parallel.
+    void stepRange(std::size_t begin, std::size_t end);
+    // Sums city production into the per-nation income column (annual units).
+    void aggregateIncome(std::size_t nationCount);
+
+    // improve_infrastructure(): +1 level (max 10) and +5% indices if the investment covers 100000 * level.
+    bool improveInfrastructure(std::size_t city, double investment);
+    // update_defense(): scales the defense index by (1 + modifier).
+    void updateDefense(std::size_t city, double modifier);
+    void setOwner(std::size_t city, NationId owner) { owners[city] = owner; }
+
+    std::size_t count() const { return names.size(); }
+    const std::string& name(std::size_t city) const { return names[city]; }
+    double lat(std::size_t city) const { return lats[city]; }
+    double lng(std::size_t city) const { return lngs[city]; }
+    NationId owner(std::size_t city) const { return owners[city]; }
+    double population(std::size_t city) const { return populations[city]; }
+    int infrastructure(std::size_t city) const { return static_cast<int>(infrastructures[city]); }
+    double economicIndex(std::size_t city) const { return economicIndices[city]; }
+    double defenseIndex(std::size_t city) const { return defenseIndices[city]; }
+    double production(std::size_t city) const { return productions[city]; }
+
+    // Annual production summed per nation (index = NationId); sized by the last aggregateIncome().
+    const double* nationIncome() const { return incomes.data(); }
+    double incomeOf(NationId nation) const { return nation < incomes.size() ? incomes[nation] : 0.0; }
+    std::size_t nationCount() const { return incomes.size(); }
+
+private:
+    double stepYears = 1.0;
+
+    // Cold columns.
+    std::vector<std::string> names;
+    std::vector<double> lats, lngs;
+    std::vector<NationId> owners;
+    std::vector<double> growthRates;
+
+    // Hot columns read or written by every step.
+    std::vector<double> populations;
+    std::vector<double> infrastructures;
+    std::vector<double> economicIndices;
+    std::vector<double> defenseIndices;
+    std::vector<double> stepFactors;        // (1 + effective growth) ^ stepYears.
+    std::vector<double> productions;
+
+    std::vector<double> incomes;
+
+    void refreshStepFactor(std::size_t city);
+    // Adds a listed city with starting stats drawn from (serial, seed) and scaled by its rank in the country.
+    void addSeededCity(const std::string& name, double lat, double lng, NationId owner, std::uint32_t serial,
+                       int rank, std::uint32_t seed);
+};
+
+#endif // CITIES_H
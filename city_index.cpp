@@ -0,0 +1,308 @@
+/*
+ * city_index.cpp - Implicit 3-D k-d tree over city unit vectors for nearest-k and radius queries.
+ */
+
+#include "city_index.h"
+#include "cities.h"
+#include "geo.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <string>
+
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
+    std::cout << "[" << level << "] " << message << std::endl;
+}
+
+namespace {
+constexpr double kDegToRad = 3.14159265358979323846 / 180.0;
+
+// Great-circle km for a squared chord between unit vectors.
+float chordKm(float chord2) {
+    return static_cast<float>(2.0 * kEarthRadiusKm * std::asin(std::min(1.0, std::sqrt(chord2) * 0.5)));
+}
+
+// Squared chord for a great-circle distance.
+float chord2ForKm(double km) {
+    double half = std::sin(std::min(3.14159265358979323846, km / kEarthRadiusKm) * 0.5);
+    return static_cast<float>(4.0 * half * half);
+}
+}
+
+// Query point plus the running k-best list (a max-heap on squared chord).
+struct CityIndex::Query {
+    float p[3];
+    std::size_t k = 1;
+    std::vector<std::pair<float, std::uint32_t>> best;
+
+    Query(double lat, double lng) {
+        const double a = lat * kDegToRad, b = lng * kDegToRad;
+        p[0] = static_cast<float>(std::cos(a) * std::cos(b));
+        p[1] = static_cast<float>(std::cos(a) * std::sin(b));
+        p[2] = static_cast<float>(std::sin(a));
+    }
+    float worst() const { return best.size() < k ? std::numeric_limits<float>::max() : best.front().first; }
+    void offer(float d2, std::uint32_t entry) {
+        if (best.size() < k) {
+            best.emplace_back(d2, entry);
+            std::push_heap(best.begin(), best.end());
+        } else if (d2 < best.front().first) {
+            std::pop_heap(best.begin(), best.end());
+            best.back() = {d2, entry};
+            std::push_heap(best.begin(), best.end());
+        }
+    }
+};
+
+//-------------------------------------------------
+// Build
+//-------------------------------------------------
+void CityIndex::build(const CitySystem& cities) {
+    std::vector<double> lats(cities.count()), lngs(cities.count());
+    for (std::size_t i = 0; i < cities.count(); ++i) {
+        lats[i] = cities.lat(i);
+        lngs[i] = cities.lng(i);
+    }
+    build(lats.data(), lngs.data(), lats.size());
+}
+
+void CityIndex::build(const double* lats, const double* lngs, std::size_t count) {
+    px.resize(count);
+    py.resize(count);
+    pz.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const double a = lats[i] * kDegToRad, b = lngs[i] * kDegToRad;
+        px[i] = static_cast<float>(std::cos(a) * std::cos(b));
+        py[i] = static_cast<float>(std::cos(a) * std::sin(b));
+        pz[i] = static_cast<float>(std::sin(a));
+    }
+    axes.assign(count, 0);
+    std::vector<std::uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    split(0, count, order);
+
+    // Permute the columns into tree order.
+    std::vector<float> x(count), y(count), z(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        x[i] = px[order[i]];
+        y[i] = py[order[i]];
+        z[i] = pz[order[i]];
+    }
+    px.swap(x);
+    py.swap(y);
+    pz.swap(z);
+    ids.swap(order);
+}
+
+void CityIndex::split(std::size_t lo, std::size_t hi, std::vector<std::uint32_t>& order) {
+    if (hi - lo <= kLeafSize) return;
+    const std::vector<float>* columns[3] = {&px, &py, &pz};
+    // Split on the axis with the largest spread over this range.
+    float lower[3] = {2.0f, 2.0f, 2.0f}, upper[3] = {-2.0f, -2.0f, -2.0f};
+    for (std::size_t i = lo; i < hi; ++i) {
+        for (int a = 0; a < 3; ++a) {
+            float v = (*columns[a])[order[i]];
+            lower[a] = std::min(lower[a], v);
+            upper[a] = std::max(upper[a], v);
+        }
+    }
+    int axis = 0;
+    for (int a = 1; a < 3; ++a)
+        if (upper[a] - lower[a] > upper[axis] - lower[axis]) axis = a;
+    const std::vector<float>& column = *columns[axis];
+    const std::size_t mid = (lo + hi) / 2;
+    std::nth_element(order.begin() + lo, order.begin() + mid, order.begin() + hi,
+                     [&column](std::uint32_t a, std::uint32_t b) { return column[a] < column[b]; });
+    axes[mid] = static_cast<std::uint8_t>(axis);
+    split(lo, mid, order);
+    split(mid + 1, hi, order);
+}
+
+//-------------------------------------------------
+// Queries
+//-------------------------------------------------
+void CityIndex::searchNearest(Query& q, std::size_t lo, std::size_t hi) const {
+    if (hi - lo <= kLeafSize) {
+        for (std::size_t i = lo; i < hi; ++i) {
+            float dx = px[i] - q.p[0], dy = py[i] - q.p[1], dz = pz[i] - q.p[2];
+            q.offer(dx * dx + dy * dy + dz * dz, static_cast<std::uint32_t>(i));
+        }
+        return;
+    }
+    const std::size_t mid = (lo + hi) / 2;
+    float dx = px[mid] - q.p[0], dy = py[mid] - q.p[1], dz = pz[mid] - q.p[2];
+    q.offer(dx * dx + dy * dy + dz * dz, static_cast<std::uint32_t>(mid));
+    const float* column = axes[mid] == 0 ? px.data() : axes[mid] == 1 ? py.data() : pz.data();
+    const float diff = q.p[axes[mid]] - column[mid];
+    // Nearer side first; the far side only if the splitting plane is closer than the k-th best.
+    if (diff < 0.0f) {
+        searchNearest(q, lo, mid);
+        if (diff * diff < q.worst()) searchNearest(q, mid + 1, hi);
+    } else {
+        searchNearest(q, mid + 1, hi);
+        if (diff * diff < q.worst()) searchNearest(q, lo, mid);
+    }
+}
+
+void CityIndex::searchWithin(const Query& q, float limit, std::size_t lo, std::size_t hi,
+                             std::vector<std::uint32_t>& out) const {
+    if (hi - lo <= kLeafSize) {
+        for (std::size_t i = lo; i < hi; ++i) {
+            float dx = px[i] - q.p[0], dy = py[i] - q.p[1], dz = pz[i] - q.p[2];
+            if (dx * dx + dy * dy + dz * dz <= limit) out.push_back(ids[i]);
+        }
+        return;
+    }
+    const std::size_t mid = (lo + hi) / 2;
+    float dx = px[mid] - q.p[0], dy = py[mid] - q.p[1], dz = pz[mid] - q.p[2];
+    if (dx * dx + dy * dy + dz * dz <= limit) out.push_back(ids[mid]);
+    const float* column = axes[mid] == 0 ? px.data() : axes[mid] == 1 ? py.data() : pz.data();
+    const float diff = q.p[axes[mid]] - column[mid];
+    if (diff <= 0.0f || diff * diff <= limit) searchWithin(q, limit, lo, mid, out);
+    if (diff >= 0.0f || diff * diff <= limit) searchWithin(q, limit, mid + 1, hi, out);
+}
+
+std::uint32_t CityIndex::nearest(double lat, double lng, float* outKm) const {
+    std::uint32_t city = kNoCity;
+    nearest(lat, lng, 1, &city, outKm);
+    return city;
+}
+
+std::size_t CityIndex::nearest(double lat, double lng, std::size_t k, std::uint32_t* outCities, float* outKm) const {
+    if (ids.empty() || k == 0) return 0;
+    Query q(lat, lng);
+    q.k = std::min(k, ids.size());
+    q.best.reserve(q.k);
+    searchNearest(q, 0, ids.size());
+    std::sort_heap(q.best.begin(), q.best.end());
+    for (std::size_t i = 0; i < q.best.size(); ++i) {
+        outCities[i] = ids[q.best[i].second];
+        if (outKm) outKm[i] = chordKm(q.best[i].first);
+    }
+    return q.best.size();
+}
+
+std::size_t CityIndex::within(double lat, double lng, double km, std::vector<std::uint32_t>& out) const {
+    if (ids.empty()) return 0;
+    const std::size_t before = out.size();
+    searchWithin(Query(lat, lng), chord2ForKm(km), 0, ids.size(), out);
+    return out.size() - before;
+}
+
+void CityIndex::nearestBatch(const float* lats, const float* lngs, std::size_t count, std::uint32_t* outCities) const {
+    for (std::size_t i = 0; i < count; ++i) outCities[i] = nearest(lats[i], lngs[i]);
+}
+
+void CityIndex::withinBatch(const float* lats, const float* lngs, std::size_t count, double km,
+                            std::vector<std::uint32_t>& offsets, std::vector<std::uint32_t>& cities) const {
+    offsets.assign(1, 0);
+    offsets.reserve(count + 1);
+    cities.clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        within(lats[i], lngs[i], km, cities);
+        offsets.push_back(static_cast<std::uint32_t>(cities.size()));
+    }
+}
+
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DCITY_INDEX_TEST)
+// Every nearest, nearest-k and radius answer must match a brute-force GeoPoints scan (over
+// data/cities.json when present, plus 100k random points), and the tree must beat the scan.
+//   g++ -std=c++17 -O2 -DCITY_INDEX_TEST city_index.cpp cities.cpp geo.cpp worldpack.cpp json_reader.cpp -o city_index
+#ifdef CITY_INDEX_TEST
+#include <chrono>
+#include <random>
+
+namespace {
+int check(const std::vector<double>& lats, const std::vector<double>& lngs, const char* label) {
+    int failures = 0;
+    CityIndex index;
+    auto t0 = std::chrono::steady_clock::now();
+    index.build(lats.data(), lngs.data(), lats.size());
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    GeoPoints points;
+    for (std::size_t i = 0; i < lats.size(); ++i) points.add(lats[i], lngs[i]);
+
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<float> latDist(-85.0f, 85.0f), lngDist(-180.0f, 179.99f);
+    const std::size_t queries = 2000;
+    std::vector<float> qLat(queries), qLng(queries);
+    for (std::size_t i = 0; i < queries; ++i) {
+        qLat[i] = latDist(rng);
+        qLng[i] = lngDist(rng);
+    }
+
+    std::vector<float> km(lats.size());
+    std::vector<std::uint8_t> mask(lats.size());
+    std::vector<std::uint32_t> found;
+    std::uint32_t knn[5];
+    float knnKm[5];
+    std::size_t inRadius = 0;
+    for (std::size_t q = 0; q < queries; ++q) {
+        points.distancesKm(qLat[q], qLng[q], km.data());
+        // Nearest 5 by the scan; ties within float noise are accepted either way.
+        std::vector<std::size_t> byKm(lats.size());
+        std::iota(byKm.begin(), byKm.end(), std::size_t(0));
+        std::partial_sort(byKm.begin(), byKm.begin() + 5, byKm.end(),
+                          [&km](std::size_t a, std::size_t b) { return km[a] < km[b]; });
+        std::size_t n = index.nearest(qLat[q], qLng[q], 5, knn, knnKm);
+        failures += n != 5;
+        for (std::size_t i = 0; i < n; ++i) failures += std::fabs(knnKm[i] - km[byKm[i]]) > 0.01f;
+        failures += std::fabs(km[index.nearest(qLat[q], qLng[q])] - km[byKm[0]]) > 0.01f;
+
+        found.clear();
+        index.within(qLat[q], qLng[q], 200.0, found);
+        std::size_t expected = 0, unexpected = 0;
+        for (std::size_t i = 0; i < lats.size(); ++i) expected += km[i] <= 199.99f;
+        for (std::uint32_t city : found) unexpected += km[city] > 200.01f;
+        failures += found.size() < expected || unexpected > 0;
+        inRadius += found.size();
+    }
+
+    // Throughput: batched tree queries versus one brute-force radius scan per query.
+    t0 = std::chrono::steady_clock::now();
+    std::vector<std::uint32_t> nearestCities(queries), offsets, cities;
+    index.nearestBatch(qLat.data(), qLng.data(), queries, nearestCities.data());
+    index.withinBatch(qLat.data(), qLng.data(), queries, 200.0, offsets, cities);
+    double treeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / queries;
+    t0 = std::chrono::steady_clock::now();
+    std::size_t scanned = 0;
+    for (std::size_t q = 0; q < queries; ++q) scanned += points.within(qLat[q], qLng[q], 200.0, mask.data());
+    double scanUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / queries;
+    failures += cities.size() != inRadius || scanned != inRadius;
+
+    std::cout << label << ": " << lats.size() << " cities, build " << buildMs << " ms; nearest + 200 km radius "
+              << treeUs << " us/query (scan " << scanUs << " us); " << inRadius << " hits; failures: " << failures
+              << std::endl;
+    return failures;
+}
+}
+
+int main() {
+    int failures = 0;
+    CitySystem cities;
+    auto anyOwner = [](const std::string&, const std::string&, double, double) { return NationId(0); };
+    if (cities.loadJson("data/cities.json", anyOwner)) {
+        std::vector<double> lats, lngs;
+        for (std::size_t i = 0; i < cities.count(); ++i) {
+            lats.push_back(cities.lat(i));
+            lngs.push_back(cities.lng(i));
+        }
+        failures += check(lats, lngs, "data/cities.json");
+    }
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<double> latDist(-90.0, 90.0), lngDist(-180.0, 180.0);
+    std::vector<double> lats(100000), lngs(100000);
+    for (std::size_t i = 0; i < lats.size(); ++i) {
+        lats[i] = latDist(rng);
+        lngs[i] = lngDist(rng);
+    }
+    failures += check(lats, lngs, "Random");
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+// End of city_index.cpp
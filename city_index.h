@@ -0,0 +1,72 @@
+/**************************************************************************************************
+ * city_index.h
+ * Static Spatial Index over Cities for Conqueror Engine (Header)
+ *
+ * Answers "which city is closest to this point" and "every city within 200 km" without scanning
+ * the whole city list. Positions are converted once to unit vectors on the sphere and stored in an
+ * implicit, balanced k-d tree (3-D, no pointers): each subtree is a contiguous range of SoA
+ * columns, its split point sits at the middle of the range and its split axis is the one with the
+ * largest spread. Straight-line (chord) distance between unit vectors grows with great-circle
+ * distance, so nearest and radius queries are exact on the sphere, with no seams at the date line
+ * or the poles. Leaves of up to kLeafSize cities are scanned linearly.
+ *
+ * Cities never move, so the index is built once at load; owners and stats stay in CitySystem and
+ * callers filter the returned city indices against them.
+ *
+ * Exposed Types:
+ * - CityIndex
+ **************************************************************************************************/
+
+#ifndef CITY_INDEX_H
+#define CITY_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CitySystem;
+
+//-------------------------------------------------
+// City Index
+//-------------------------------------------------
+class CityIndex {
+public:
+    static constexpr std::uint32_t kNoCity = 0xFFFFFFFFu;
+    static constexpr std::size_t kLeafSize = 8;
+
+    // Indexes every city of the system (city index = CitySystem index).
+    void build(const CitySystem& cities);
+    void build(const double* lats, const double* lngs, std::size_t count);
+
+    std::size_t size() const { return ids.size(); }
+
+    // Closest city, or kNoCity when the index is empty.
+    std::uint32_t nearest(double lat, double lng, float* outKm = nullptr) const;
+    /**
+     * @brief The k closest cities, nearest first.
+     * @return Number written to outCities (and outKm when not null): min(k, size()).
+     */
+    std::size_t nearest(double lat, double lng, std::size_t k, std::uint32_t* outCities, float* outKm = nullptr) const;
+    // Appends every city within `km` (great-circle) to `out`, in no particular order. Returns the count.
+    std::size_t within(double lat, double lng, double km, std::vector<std::uint32_t>& out) const;
+
+    // Batch forms over query columns. Nearest writes one city per query; within writes a CSR list:
+    // the cities of query q are cities[offsets[q] .. offsets[q + 1]).
+    void nearestBatch(const float* lats, const float* lngs, std::size_t count, std::uint32_t* outCities) const;
+    void withinBatch(const float* lats, const float* lngs, std::size_t count, double km,
+                     std::vector<std::uint32_t>& offsets, std::vector<std::uint32_t>& cities) const;
+
+private:
+    // Tree order (SoA): unit vectors, the city each entry came from, and the split axis of the
+    // subtree whose middle entry this is.
+    std::vector<float> px, py, pz;
+    std::vector<std::uint32_t> ids;
+    std::vector<std::uint8_t> axes;
+
+    struct Query;
+    void split(std::size_t lo, std::size_t hi, std::vector<std::uint32_t>& order);
+    void searchNearest(Query& q, std::size_t lo, std::size_t hi) const;
+    void searchWithin(const Query& q, float limit, std::size_t lo, std::size_t hi, std::vector<std::uint32_t>& out) const;
+};
+
+#endif // CITY_INDEX_H
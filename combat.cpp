@@ -9,221 +9,181 @@
  *   - Extended diagnostics and logging to assist with in‑depth debugging and performance analysis.
  *
  * The combat resolution algorithm is based on unit variant cost, subscription status (for elite units),
- * and random battlefield modifiers to produce realistic outcomes.
+ * and random battlefield modifiers to produce realistic outcomes. A per-nation combat multiplier
+ * (the folded combatEffectiveness stack from modifiers.h) scales attack and defense.
  *
  * Compile with:
  *   g++ combat.cpp -o combat -std=c++11
  ********************************************************************************************************************/
 
+#include "combat.h"
+
 #include <iostream>
 #include <cmath>
 #include <cstdlib>
 #include <ctime>
 #include <sstream>
-#include <string>
-#include <vector>
-#include <map>
 #include <iomanip>
-
-// -------------------------------------------------
-// Forward declarations based on units.cpp definitions.
-// In your integration, include the proper headers as needed.
-struct UnitVariant {
-    std::string category;
-    std::string variantName;
-    double cost;
-    double resourceCost;
-    bool subscriptionRequired;
-    std::string iconPath;
-};
-
-class Unit {
-public:
-    std::string category;
-    UnitVariant variant;
-    float x, y;           // 2D position (for a placeholder 3D position, z could be added later)
-    std::string nationName;
-    
-    Unit(const std::string &cat, const UnitVariant &var, float posX, float posY, const std::string &nation)
-        : category(cat), variant(var), x(posX), y(posY), nationName(nation) {}
-};
+#include <algorithm>
 
 // -------------------------------------------------
 // Logging utility: Simulates the logEvent functionality from JS.
-void logEvent(const std::string &message, const std::string &level = "INFO") {
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
     std::cout << "[" << level << "] " << message << std::endl;
 }
 
 // ============================================================
 // CombatStats: Computes effective combat factors for a unit.
 // ============================================================
-class CombatStats {
-public:
-    double attackStrength;
-    double defenseStrength;
-    double hitPoints;
-    
-    CombatStats() : attackStrength(0), defenseStrength(0), hitPoints(100) {}
-
-    // Computes stats based on unit variant cost and subscription status.
-    // Formula:
-    //   attack = variant.cost / 100000 (plus a bonus if subscription required)
-    //   defense = variant.cost / 120000 (plus a bonus if subscription required)
-    //   hitPoints = max(50, variant.cost / 20000), with randomness added.
-    void computeStats(const Unit &unit) {
-        attackStrength = unit.variant.cost / 100000.0;
-        defenseStrength = unit.variant.cost / 120000.0;
-        hitPoints = std::max(50.0, unit.variant.cost / 20000.0);
-        if (unit.variant.subscriptionRequired) {
-            // Elite units get enhanced stats.
-            attackStrength *= 1.25;
-            defenseStrength *= 1.25;
-            hitPoints *= 1.2;
-        }
-        // Introduce a random factor between +0% and +10%.
-        double randFactor = (std::rand() % 11) / 100.0;
-        attackStrength *= (1.0 + randFactor);
-        defenseStrength *= (1.0 + randFactor);
-        hitPoints *= (1.0 + randFactor);
+void CombatStats::computeStats(const CombatUnit &unit, double combatMultiplier) {
+    attackStrength = unit.variant.cost / 100000.0;
+    defenseStrength = unit.variant.cost / 120000.0;
+    hitPoints = std::max(50.0, unit.variant.cost / 20000.0);
+    if (unit.variant.subscriptionRequired) {
+        // Elite units get enhanced stats.
+        attackStrength *= 1.25;
+        defenseStrength *= 1.25;
+        hitPoints *= 1.2;
     }
-    
-    // Returns a formatted string summarizing the combat stats.
-    std::string toString() const {
-        std::ostringstream oss;
-        oss << "Attack: " << std::fixed << std::setprecision(2) << attackStrength
-            << ", Defense: " << defenseStrength
-            << ", HP: " << hitPoints;
-        return oss.str();
-    }
-};
+    // Introduce a random factor between +0% and +10%.
+    double randFactor = (std::rand() % 11) / 100.0;
+    attackStrength *= (1.0 + randFactor);
+    defenseStrength *= (1.0 + randFactor);
+    hitPoints *= (1.0 + randFactor);
+    attackStrength *= combatMultiplier;
+    defenseStrength *= combatMultiplier;
+}
+
+std::string CombatStats::toString() const {
+    std::ostringstream oss;
+    oss << "Attack: " << std::fixed << std::setprecision(2) << attackStrength
+        << ", Defense: " << defenseStrength
+        << ", HP: " << hitPoints;
+    return oss.str();
+}
 
 // ============================================================
 // CombatResolver: Encapsulates combat resolution algorithms.
 // ============================================================
-class CombatResolver {
-public:
-    CombatResolver() { std::srand((unsigned int)std::time(nullptr)); }
-    
-    // Resolve combat between an attacker and a defender.
-    // Returns true if the attacker wins, false if the defender prevails.
-    bool resolveCombat(Unit *attacker, Unit *defender) {
-        if (!attacker || !defender) {
-            logEvent("Invalid unit provided to resolveCombat.", "ERROR");
-            return false;
-        }
-        
-        CombatStats attackerStats, defenderStats;
-        attackerStats.computeStats(*attacker);
-        defenderStats.computeStats(*defender);
-        
-        std::ostringstream oss;
-        oss << "Combat Analysis - Attacker (" << attacker->variant.variantName << "): " 
-            << attackerStats.toString() << " | Defender (" 
-            << defender->variant.variantName << "): " << defenderStats.toString();
-        logEvent(oss.str(), "DEBUG");
-        
-        // Determine outcome based on the difference between attack and defense.
-        double battleFactor = attackerStats.attackStrength - defenderStats.defenseStrength;
-        // Introduce a random modifier between -5 and +5.
-        double randomFactor = (std::rand() % 11) - 5;  
-        double outcomeScore = battleFactor + randomFactor;
-        
-        oss.str("");
-        oss << "Battle Factor: " << battleFactor << ", Random Factor: " << randomFactor
-            << ", Outcome Score: " << outcomeScore;
-        logEvent(oss.str(), "DEBUG");
-        
-        bool attackerWins = (outcomeScore > 0);
-        logEvent(attackerWins ? "Attacker wins the combat." : "Defender wins the combat.", "INFO");
-        return attackerWins;
+CombatResolver::CombatResolver() { std::srand((unsigned int)std::time(nullptr)); }
+
+// Resolve combat between an attacker and a defender.
+// Returns true if the attacker wins, false if the defender prevails.
+bool CombatResolver::resolveCombat(CombatUnit *attacker, CombatUnit *defender) {
+    if (!attacker || !defender) {
+        logEvent("Invalid unit provided to resolveCombat.", "ERROR");
+        return false;
     }
     
-    // Resolve group combat between two groups of units.
-    // Returns true if the attacking group wins, false otherwise.
-    bool resolveGroupCombat(const std::vector<Unit*> &attackers, const std::vector<Unit*> &defenders) {
-        if (attackers.empty() || defenders.empty()) {
-            logEvent("Empty combat group provided to resolveGroupCombat.", "ERROR");
-            return false;
-        }
-        
-        double attackerTotal = 0;
-        double defenderTotal = 0;
-        
-        // Sum combat stats for each group.
-        for (auto attacker : attackers) {
-            CombatStats cs;
-            cs.computeStats(*attacker);
-            attackerTotal += cs.attackStrength;
-        }
-        for (auto defender : defenders) {
-            CombatStats cs;
-            cs.computeStats(*defender);
-            defenderTotal += cs.defenseStrength;
-        }
-        
-        std::ostringstream oss;
-        oss << "Group Combat Power - Attackers: " << attackerTotal 
-            << ", Defenders: " << defenderTotal;
-        logEvent(oss.str(), "DEBUG");
-        
-        // Apply random adjustments to simulate battlefield chaos.
-        double attackerRandom = (std::rand() % 101) / 100.0; // Absent to 1.0 factor.
-        double defenderRandom = (std::rand() % 101) / 100.0;
-        attackerTotal *= (1.0 + attackerRandom * 0.2);  // Up to +20%
-        defenderTotal *= (1.0 + defenderRandom * 0.2);
-        
-        oss.str("");
-        oss << "After Random Adjustment - Attackers: " << attackerTotal
-            << ", Defenders: " << defenderTotal;
-        logEvent(oss.str(), "DEBUG");
-        
-        bool attackersWin = (attackerTotal > defenderTotal);
-        logEvent(attackersWin ? "Attacking force wins the group combat."
-                              : "Defending force successfully repels the attack.", "INFO");
-        return attackersWin;
-    }
+    CombatStats attackerStats, defenderStats;
+    attackerStats.computeStats(*attacker, multiplierFor(*attacker));
+    defenderStats.computeStats(*defender, multiplierFor(*defender));
     
-    // Simulate multiple rounds of one-on-one combat between two units.
-    // Returns "attacker" if the attacker wins more rounds, or "defender" otherwise.
-    std::string simulateCombatRounds(Unit *attacker, Unit *defender, int rounds) {
-        int attackerWins = 0;
-        int defenderWins = 0;
-        for (int i = 1; i <= rounds; ++i) {
-            logEvent("Combat Round " + std::to_string(i), "DEBUG");
-            bool result = resolveCombat(attacker, defender);
-            if (result)
-                attackerWins++;
-            else
-                defenderWins++;
-            // Short delay simulation loop.
-            for (volatile int j = 0; j < 100000; ++j);
-        }
-        std::ostringstream oss;
-        oss << "After " << rounds << " rounds: Attacker Wins = " << attackerWins 
-            << ", Defender Wins = " << defenderWins;
-        logEvent(oss.str(), "INFO");
-        return (attackerWins > defenderWins) ? "attacker" : "defender";
+    std::ostringstream oss;
+    oss << "Combat Analysis - Attacker (" << attacker->variant.variantName << "): " 
+        << attackerStats.toString() << " | Defender (" 
+        << defender->variant.variantName << "): " << defenderStats.toString();
+    logEvent(oss.str(), "DEBUG");
+    
+    // Determine outcome based on the difference between attack and defense.
+    double battleFactor = attackerStats.attackStrength - defenderStats.defenseStrength;
+    // Introduce a random modifier between -5 and +5.
+    double randomFactor = (std::rand() % 11) - 5;  
+    double outcomeScore = battleFactor + randomFactor;
+    
+    oss.str("");
+    oss << "Battle Factor: " << battleFactor << ", Random Factor: " << randomFactor
+        << ", Outcome Score: " << outcomeScore;
+    logEvent(oss.str(), "DEBUG");
+    
+    bool attackerWins = (outcomeScore > 0);
+    logEvent(attackerWins ? "Attacker wins the combat." : "Defender wins the combat.", "INFO");
+    return attackerWins;
+}
+
+// Resolve group combat between two groups of units.
+// Returns true if the attacking group wins, false otherwise.
+bool CombatResolver::resolveGroupCombat(const std::vector<CombatUnit*> &attackers, const std::vector<CombatUnit*> &defenders) {
+    if (attackers.empty() || defenders.empty()) {
+        logEvent("Empty combat group provided to resolveGroupCombat.", "ERROR");
+        return false;
     }
     
-    // Extended simulation: Run a series of engagements between groups and output win percentages.
-    void extendedCombatSimulation(const std::vector<Unit*> &attackers, const std::vector<Unit*> &defenders, int engagements) {
-        int wins = 0;
-        for (int i = 0; i < engagements; ++i) {
-            bool result = resolveGroupCombat(attackers, defenders);
-            if (result)
-                wins++;
-            // Simulate processing delay.
-            for (volatile int j = 0; j < 50000; ++j);
-        }
-        double winPercentage = ((double)wins / engagements) * 100.0;
-        std::ostringstream oss;
-        oss << "Extended Simulation: Attackers won " << wins << " out of " << engagements 
-            << " engagements (" << std::fixed << std::setprecision(2) << winPercentage << "%)";
-        logEvent(oss.str(), "INFO");
+    double attackerTotal = 0;
+    double defenderTotal = 0;
+    
+    // Sum combat stats for each group.
+    for (auto attacker : attackers) {
+        CombatStats cs;
+        cs.computeStats(*attacker, multiplierFor(*attacker));
+        attackerTotal += cs.attackStrength;
+    }
+    for (auto defender : defenders) {
+        CombatStats cs;
+        cs.computeStats(*defender, multiplierFor(*defender));
+        defenderTotal += cs.defenseStrength;
     }
     
-    // Additional advanced combat routines can be inserted here in a production system.
-};
+    std::ostringstream oss;
+    oss << "Group Combat Power - Attackers: " << attackerTotal 
+        << ", Defenders: " << defenderTotal;
+    logEvent(oss.str(), "DEBUG");
+    
+    // Apply random adjustments to simulate battlefield chaos.
+    double attackerRandom = (std::rand() % 101) / 100.0; // Absent to 1.0 factor.
+    double defenderRandom = (std::rand() % 101) / 100.0;
+    attackerTotal *= (1.0 + attackerRandom * 0.2);  // Up to +20%
+    defenderTotal *= (1.0 + defenderRandom * 0.2);
+    
+    oss.str("");
+    oss << "After Random Adjustment - Attackers: " << attackerTotal
+        << ", Defenders: " << defenderTotal;
+    logEvent(oss.str(), "DEBUG");
+    
+    bool attackersWin = (attackerTotal > defenderTotal);
+    logEvent(attackersWin ? "Attacking force wins the group combat."
+                          : "Defending force successfully repels the attack.", "INFO");
+    return attackersWin;
+}
+
+// Simulate multiple rounds of one-on-one combat between two units.
+// Returns "attacker" if the attacker wins more rounds, or "defender" otherwise.
+std::string CombatResolver::simulateCombatRounds(CombatUnit *attacker, CombatUnit *defender, int rounds) {
+    int attackerWins = 0;
+    int defenderWins = 0;
+    for (int i = 1; i <= rounds; ++i) {
+        logEvent("Combat Round " + std::to_string(i), "DEBUG");
+        bool result = resolveCombat(attacker, defender);
+        if (result)
+            attackerWins++;
+        else
+            defenderWins++;
+        // Short delay simulation loop.
+        for (volatile int j = 0; j < 100000; ++j);
+    }
+    std::ostringstream oss;
+    oss << "After " << rounds << " rounds: Attacker Wins = " << attackerWins 
+        << ", Defender Wins = " << defenderWins;
+    logEvent(oss.str(), "INFO");
+    return (attackerWins > defenderWins) ? "attacker" : "defender";
+}
+
+// Extended simulation: Run a series of engagements between groups and output win percentages.
+void CombatResolver::extendedCombatSimulation(const std::vector<CombatUnit*> &attackers, const std::vector<CombatUnit*> &defenders, int engagements) {
+    int wins = 0;
+    for (int i = 0; i < engagements; ++i) {
+        bool result = resolveGroupCombat(attackers, defenders);
+        if (result)
+            wins++;
+        // Simulate processing delay.
+        for (volatile int j = 0; j < 50000; ++j);
+    }
+    double winPercentage = ((double)wins / engagements) * 100.0;
+    std::ostringstream oss;
+    oss << "Extended Simulation: Attackers won " << wins << " out of " << engagements 
+        << " engagements (" << std::fixed << std::setprecision(2) << winPercentage << "%)";
+    logEvent(oss.str(), "INFO");
+}
 
 // ============================================================
 // Additional Extended Diagnostics for Combat System
@@ -251,10 +211,17 @@ int main() {
     UnitVariant variantDefender = {"Tank", "T-14 Armata", 1200000, 600000, false, "icons/tank_t14.png"};
     
     // Create two sample units.
-    Unit attacker("Tank", variantAttacker, 100.0f, 200.0f, "NationA");
-    Unit defender("Tank", variantDefender, 150.0f, 250.0f, "NationB");
+    NationRegistry registry;
+    NationId nationA = registry.intern("NTA", "NationA");
+    NationId nationB = registry.intern("NTB", "NationB");
+    CombatUnit attacker("Tank", variantAttacker, 100.0f, 200.0f, nationA);
+    CombatUnit defender("Tank", variantDefender, 150.0f, 250.0f, nationB);
     
     CombatResolver resolver;
+    // NationA fields a doctrine-boosted army (Military Innovation: combatEffectiveness 1.15).
+    resolver.setCombatMultiplier([nationA](const CombatUnit &unit) { return unit.nation == nationA ? 1.15 : 1.0; });
+    int failures = 0;
+    failures += resolver.multiplierFor(attacker) != 1.15 || resolver.multiplierFor(defender) != 1.0;
     
     // Single combat encounter.
     bool result = resolver.resolveCombat(&attacker, &defender);
@@ -265,11 +232,11 @@ int main() {
     logEvent("Winner after 10 rounds: " + winner, "INFO");
     
     // Simulate group combat.
-    std::vector<Unit*> attackers;
-    std::vector<Unit*> defenders;
+    std::vector<CombatUnit*> attackers;
+    std::vector<CombatUnit*> defenders;
     for (int i = 0; i < 5; ++i) {
-        attackers.push_back(new Unit("Tank", variantAttacker, 100.0f + i * 5, 200.0f + i * 5, "NationA"));
-        defenders.push_back(new Unit("Tank", variantDefender, 150.0f + i * 3, 250.0f + i * 3, "NationB"));
+        attackers.push_back(new CombatUnit("Tank", variantAttacker, 100.0f + i * 5, 200.0f + i * 5, nationA));
+        defenders.push_back(new CombatUnit("Tank", variantDefender, 150.0f + i * 3, 250.0f + i * 3, nationB));
     }
     bool groupResult = resolver.resolveGroupCombat(attackers, defenders);
     logEvent(std::string("Group Combat Result: ") + (groupResult ? "Attackers win." : "Defenders win."), "INFO");
@@ -286,7 +253,8 @@ int main() {
     for (auto unit : defenders)
         delete unit;
     
-    return 0;
+    logEvent("Combat test failures: " + std::to_string(failures), failures ? "ERROR" : "INFO");
+    return failures == 0 ? 0 : 1;
 }
 #endif
 
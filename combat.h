@@ -1,10 +1,91 @@
+/**************************************************************************************************
+ * combat.h
+ * Combat Resolution for Conqueror Engine (Header)
+ *
+ * Resolves one-on-one and group engagements from unit variant cost, subscription status and
+ * random battlefield factors. Attack and defense are scaled by the owning nation's combat
+ * multiplier, which the engine feeds from the folded combatEffectiveness stack (modifiers.h), so
+ * doctrines, policies and military events all reach the battlefield through one lookup.
+ *
+ * Exposed Types:
+ * - CombatUnit
+ * - CombatStats
+ * - CombatResolver
+ **************************************************************************************************/
+
 #ifndef COMBAT_H
 #define COMBAT_H
 
-// Combat module header
-// Declares functions for initializing, updating, and cleaning up the combat module.
-bool initCombat();
-void updateCombat();
-void cleanupCombat();
+#include "nations.h"
+#include "units.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+//-------------------------------------------------
+// Combatant
+//-------------------------------------------------
+struct CombatUnit {
+    std::string category;
+    UnitVariant variant;
+    float x, y;             // 2D position (for a placeholder 3D position, z could be added later)
+    NationId nation;
+
+    CombatUnit(const std::string& cat, const UnitVariant& var, float posX, float posY, NationId owner)
+        : category(cat), variant(var), x(posX), y(posY), nation(owner) {}
+};
+
+//-------------------------------------------------
+// Effective combat factors for one unit
+//-------------------------------------------------
+class CombatStats {
+public:
+    double attackStrength = 0;
+    double defenseStrength = 0;
+    double hitPoints = 100;
+
+    // Computes stats based on unit variant cost and subscription status.
+    // Formula:
+    //   attack = variant.cost / 100000 (plus a bonus if subscription required)
+    //   defense = variant.cost / 120000 (plus a bonus if subscription required)
+    //   hitPoints = max(50, variant.cost / 20000), with randomness added.
+    // combatMultiplier is the nation's precomputed combatEffectiveness product (1.0 = unmodified).
+    void computeStats(const CombatUnit& unit, double combatMultiplier = 1.0);
+
+    // Returns a formatted string summarizing the combat stats.
+    std::string toString() const;
+};
+
+//-------------------------------------------------
+// Combat Resolver
+//-------------------------------------------------
+class CombatResolver {
+public:
+    // Returns the combat multiplier for a unit's nation (e.g. a ModifierStacks lookup).
+    using MultiplierLookup = std::function<double(const CombatUnit&)>;
+
+    CombatResolver();
+
+    void setCombatMultiplier(MultiplierLookup lookup) { combatMultiplier = std::move(lookup); }
+    // The multiplier a unit fights with; 1.0 when no lookup is installed.
+    double multiplierFor(const CombatUnit& unit) const { return combatMultiplier ? combatMultiplier(unit) : 1.0; }
+
+    // Returns true if the attacker wins, false if the defender prevails.
+    bool resolveCombat(CombatUnit* attacker, CombatUnit* defender);
+    // Returns true if the attacking group wins, false otherwise.
+    bool resolveGroupCombat(const std::vector<CombatUnit*>& attackers, const std::vector<CombatUnit*>& defenders);
+    // Returns "attacker" if the attacker wins more rounds, or "defender" otherwise.
+    std::string simulateCombatRounds(CombatUnit* attacker, CombatUnit* defender, int rounds);
+    // Runs a series of group engagements and logs the attackers' win percentage.
+    void extendedCombatSimulation(const std::vector<CombatUnit*>& attackers, const std::vector<CombatUnit*>& defenders,
+                                  int engagements);
+
+private:
+    MultiplierLookup combatMultiplier;
+};
+
+// Logs a burst of random diagnostic values at DEBUG level.
+void extendedCombatDiagnostics();
 
 #endif // COMBAT_H
@@ -0,0 +1,358 @@
+/*
+ * diplomacy.cpp - Packed relationship matrix and vectorizable drift/decay passes.
+ */
+
+#include "diplomacy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// Stateless per-index hash, so each pair's random draw is independent of loop order and the
+// drift loop carries no RNG dependency between iterations.
+inline std::uint32_t hashIndex(std::uint32_t index, std::uint32_t salt) {
+    std::uint32_t h = (index ^ salt) * 0x9E3779B1u;
+    h ^= h >> 15;
+    h *= 0x85EBCA77u;
+    h ^= h >> 13;
+    h *= 0xC2B2AE3Du;
+    h ^= h >> 16;
+    return h;
+}
+
+inline DiplomacyCore::Fixed toFixed(double value) {
+    value = std::min(100.0, std::max(0.0, value));
+    return static_cast<DiplomacyCore::Fixed>(std::lround(value * DiplomacyCore::kFixedOne));
+}
+
+inline DiplomacyCore::Fixed clampFixed(std::int32_t value) {
+    return static_cast<DiplomacyCore::Fixed>(std::min<std::int32_t>(DiplomacyCore::kFixedMax, std::max<std::int32_t>(0, value)));
+}
+
+} // namespace
+
+void DiplomacyCore::reset(std::size_t nationCount, std::uint32_t seed) {
+    nations = nationCount;
+    rngSeed = seed;
+    cycle = 0;
+    rowOffset.assign(nations, 0);
+    std::uint32_t offset = 0;
+    for (std::size_t a = 0; a < nations; ++a) {
+        rowOffset[a] = offset;
+        offset += static_cast<std::uint32_t>(nations - a - 1);
+    }
+    statuses.assign(offset, static_cast<std::uint8_t>(RelationStatus::Neutral));
+    treaties.clear();
+    treatyGeneration.clear();
+    treatyLive.clear();
+    freeTreaties.clear();
+    expiryHeap = decltype(expiryHeap)();
+    pairTreaties.assign(static_cast<std::size_t>(offset) * kTreatyTypeCount, kNoTreaty);
+    treatyMasks.assign(offset, 0);
+    activeTreaties = 0;
+    now = 0;
+    trustValues.resize(offset);
+    hostilityValues.resize(offset);
+    for (std::uint32_t i = 0; i < offset; ++i) {
+        std::uint32_t h = hashIndex(i, seed);
+        trustValues[i] = static_cast<Fixed>((30 * kFixedOne) + ((h & 0xFFFF) * (40 * kFixedOne) >> 16));
+        hostilityValues[i] = static_cast<Fixed>((20 * kFixedOne) + ((h >> 16) * (30 * kFixedOne) >> 16));
+    }
+}
+
+double DiplomacyCore::trust(NationId a, NationId b) const {
+    if (a == b || a >= nations || b >= nations) return 100.0;
+    return trustValues[pairIndex(a, b)] / static_cast<double>(kFixedOne);
+}
+
+double DiplomacyCore::hostility(NationId a, NationId b) const {
+    if (a == b || a >= nations || b >= nations) return 0.0;
+    return hostilityValues[pairIndex(a, b)] / static_cast<double>(kFixedOne);
+}
+
+void DiplomacyCore::setStatus(NationId a, NationId b, RelationStatus newStatus) {
+    if (a == b || a >= nations || b >= nations) return;
+    std::uint8_t& slot = statuses[pairIndex(a, b)];
+    if (slot == static_cast<std::uint8_t>(newStatus)) return;
+    slot = static_cast<std::uint8_t>(newStatus);
+    if (onStatusChange) onStatusChange(a, b, newStatus);
+}
+
+void DiplomacyCore::adjust(NationId a, NationId b, double deltaTrust, double deltaHostility) {
+    if (a == b || a >= nations || b >= nations) return;
+    std::size_t i = pairIndex(a, b);
+    trustValues[i] = clampFixed(trustValues[i] + static_cast<std::int32_t>(std::lround(deltaTrust * kFixedOne)));
+    hostilityValues[i] = clampFixed(hostilityValues[i] + static_cast<std::int32_t>(std::lround(deltaHostility * kFixedOne)));
+}
+
+void DiplomacyCore::declareWar(NationId aggressor, NationId target) {
+    adjust(aggressor, target, -20, +30);
+    revokeTreaty(aggressor, target, TreatyType::Peace);
+    revokeTreaty(aggressor, target, TreatyType::Alliance);
+    setStatus(aggressor, target, RelationStatus::AtWar);
+}
+
+void DiplomacyCore::makePeace(NationId a, NationId b) {
+    adjust(a, b, +25, -25);
+    signTreaty(a, b, TreatyType::Peace, 180);
+    setStatus(a, b, RelationStatus::Neutral);
+}
+
+void DiplomacyCore::formAlliance(NationId a, NationId b) {
+    adjust(a, b, +30, -20);
+    signTreaty(a, b, TreatyType::Alliance, 365);
+    setStatus(a, b, RelationStatus::Ally);
+}
+
+void DiplomacyCore::breakAlliance(NationId a, NationId b) {
+    adjust(a, b, -30, +20);
+    revokeTreaty(a, b, TreatyType::Alliance);
+    if (allied(a, b)) setStatus(a, b, RelationStatus::Neutral);
+}
+
+void DiplomacyCore::signTradeAgreement(NationId a, NationId b) {
+    adjust(a, b, +10, -5);
+    signTreaty(a, b, TreatyType::Trade, 365);
+}
+
+TreatyId DiplomacyCore::signTreaty(NationId a, NationId b, TreatyType type, double durationDays) {
+    if (a == b || a >= nations || b >= nations) return kNoTreaty;
+    std::size_t pair = pairIndex(a, b);
+    std::uint64_t expiry = now + static_cast<std::uint64_t>(std::llround(durationDays * ticksPerDay));
+    TreatyId& slot = pairTreaties[pair * kTreatyTypeCount + static_cast<int>(type)];
+
+    if (slot != kNoTreaty) {
+        // Renewal: move the expiry; the old heap entry goes stale via the generation bump.
+        treaties[slot].expiryTick = expiry;
+        ++treatyGeneration[slot];
+    } else {
+        if (!freeTreaties.empty()) {
+            slot = freeTreaties.back();
+            freeTreaties.pop_back();
+        } else {
+            slot = static_cast<TreatyId>(treaties.size());
+            treaties.emplace_back();
+            treatyGeneration.push_back(0);
+            treatyLive.push_back(false);
+        }
+        treaties[slot] = Treaty{type, std::min(a, b), std::max(a, b), now, expiry};
+        treatyLive[slot] = true;
+        treatyMasks[pair] |= static_cast<std::uint8_t>(1u << static_cast<int>(type));
+        ++activeTreaties;
+    }
+    expiryHeap.push({expiry, slot, treatyGeneration[slot]});
+    return slot;
+}
+
+void DiplomacyCore::releaseTreaty(TreatyId id) {
+    const Treaty& t = treaties[id];
+    std::size_t pair = pairIndex(t.a, t.b);
+    pairTreaties[pair * kTreatyTypeCount + static_cast<int>(t.type)] = kNoTreaty;
+    treatyMasks[pair] &= static_cast<std::uint8_t>(~(1u << static_cast<int>(t.type)));
+    treatyLive[id] = false;
+    ++treatyGeneration[id];     // Invalidates any heap entry still pointing at this slot.
+    freeTreaties.push_back(id);
+    --activeTreaties;
+}
+
+bool DiplomacyCore::revokeTreaty(NationId a, NationId b, TreatyType type) {
+    TreatyId id = treatyBetween(a, b, type);
+    if (id == kNoTreaty) return false;
+    releaseTreaty(id);
+    return true;
+}
+
+TreatyId DiplomacyCore::treatyBetween(NationId a, NationId b, TreatyType type) const {
+    if (a == b || a >= nations || b >= nations) return kNoTreaty;
+    return pairTreaties[pairIndex(a, b) * kTreatyTypeCount + static_cast<int>(type)];
+}
+
+std::size_t DiplomacyCore::advanceTo(std::uint64_t tick) {
+    now = tick;
+    std::size_t expired = 0;
+    while (!expiryHeap.empty() && expiryHeap.top().expiryTick <= now) {
+        ExpiryEntry entry = expiryHeap.top();
+        expiryHeap.pop();
+        if (!treatyLive[entry.id] || treatyGeneration[entry.id] != entry.generation) continue; // Stale.
+        Treaty ended = treaties[entry.id];
+        releaseTreaty(entry.id);
+        ++expired;
+        // An alliance ending on schedule returns the pair to neutral.
+        if (ended.type == TreatyType::Alliance && allied(ended.a, ended.b))
+            setStatus(ended.a, ended.b, RelationStatus::Neutral);
+        if (onTreatyExpired) onTreatyExpired(ended);
+    }
+    return expired;
+}
+
+void DiplomacyCore::driftCycle(double maxDelta) {
+    const std::uint32_t salt = rngSeed ^ (++cycle * 0x27D4EB2Fu);
+    const std::int32_t span = static_cast<std::int32_t>(std::lround(2.0 * maxDelta * kFixedOne));
+    const std::int32_t half = span / 2;
+    const std::size_t n = trustValues.size();
+    Fixed* trustData = trustValues.data();
+    Fixed* hostilityData = hostilityValues.data();
+    for (std::size_t i = 0; i < n; ++i) {
+        std::uint32_t h = hashIndex(static_cast<std::uint32_t>(i), salt);
+        std::int32_t dt = static_cast<std::int32_t>(((h & 0xFFFFu) * static_cast<std::uint32_t>(span)) >> 16) - half;
+        std::int32_t dh = static_cast<std::int32_t>(((h >> 16) * static_cast<std::uint32_t>(span)) >> 16) - half;
+        trustData[i] = clampFixed(trustData[i] + dt);
+        hostilityData[i] = clampFixed(hostilityData[i] + dh);
+    }
+}
+
+void DiplomacyCore::decayCycle(double rate, double trustBaseline, double hostilityBaseline) {
+    const std::int32_t rateFixed = static_cast<std::int32_t>(std::lround(std::min(1.0, std::max(0.0, rate)) * kFixedOne));
+    const std::int32_t trustBase = toFixed(trustBaseline);
+    const std::int32_t hostilityBase = toFixed(hostilityBaseline);
+    const std::size_t n = trustValues.size();
+    Fixed* trustData = trustValues.data();
+    Fixed* hostilityData = hostilityValues.data();
+    for (std::size_t i = 0; i < n; ++i) {
+        std::int32_t t = trustData[i], h = hostilityData[i];
+        trustData[i] = static_cast<Fixed>(t + (((trustBase - t) * rateFixed) / kFixedOne));
+        hostilityData[i] = static_cast<Fixed>(h + (((hostilityBase - h) * rateFixed) / kFixedOne));
+    }
+}
+
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DDIPLOMACY_TEST)
+// Replays the standalone scenario from diplomacy.py, then times the drift pass.
+#ifdef DIPLOMACY_TEST
+#include <chrono>
+#include <iomanip>
+
+int main() {
+    NationRegistry registry;
+    NationId a = registry.intern("A", "NationA");
+    NationId b = registry.intern("B", "NationB");
+    NationId c = registry.intern("C", "NationC");
+
+    int failures = 0;
+    DiplomacyCore core;
+    core.reset(registry.count(), 42);
+    struct StatusEvent { NationId x, y; RelationStatus status; };
+    std::vector<StatusEvent> events;
+    core.setStatusListener([&](NationId x, NationId y, RelationStatus s) {
+        const char* names[] = {"neutral", "ally", "at_war"};
+        std::cout << "Status " << registry.name(x) << " - " << registry.name(y) << ": "
+                  << names[static_cast<int>(s)] << std::endl;
+        events.push_back({x, y, s});
+    });
+    auto expectEvent = [&](std::size_t index, NationId x, NationId y, RelationStatus s) {
+        failures += events.size() <= index || events[index].x != x || events[index].y != y || events[index].status != s;
+    };
+    // Drift moves each value by at most maxDelta (plus rounding) and keeps it in 0..100; decay
+    // moves it toward the baseline without overshooting.
+    auto pairValues = [&](std::vector<double>& out) {
+        out.clear();
+        for (NationId x = 0; x < core.nationCount(); ++x)
+            for (NationId y = x + 1; y < core.nationCount(); ++y) {
+                out.push_back(core.trust(x, y));
+                out.push_back(core.hostility(x, y));
+            }
+    };
+    std::vector<double> before, after;
+    auto checkDrift = [&](double maxDelta) {
+        pairValues(before);
+        core.driftCycle(maxDelta);
+        pairValues(after);
+        for (std::size_t i = 0; i < after.size(); ++i)
+            failures += after[i] < 0.0 || after[i] > 100.0 || std::fabs(after[i] - before[i]) > maxDelta + 1.0 / 256;
+    };
+    auto checkDecay = [&](double rate) {
+        pairValues(before);
+        core.decayCycle(rate);
+        pairValues(after);
+        for (std::size_t i = 0; i < after.size(); ++i) {
+            double base = i % 2 == 0 ? 50.0 : 35.0;
+            failures += std::fabs(after[i] - base) > std::fabs(before[i] - base) + 1.0 / 256;
+        }
+    };
+    auto dump = [&]() {
+        NationId ids[] = {a, b, c};
+        for (int i = 0; i < 3; ++i)
+            for (int j = i + 1; j < 3; ++j)
+                std::cout << "  " << registry.name(ids[i]) << " - " << registry.name(ids[j]) << std::fixed
+                          << std::setprecision(2) << ": trust " << core.trust(ids[i], ids[j])
+                          << ", hostility " << core.hostility(ids[i], ids[j]) << std::endl;
+    };
+
+    dump();
+    core.declareWar(a, b);
+    failures += !core.atWar(a, b) || !core.atWar(b, a);
+    expectEvent(0, a, b, RelationStatus::AtWar);
+    core.formAlliance(b, c);
+    failures += !core.allied(b, c);
+    expectEvent(1, b, c, RelationStatus::Ally);
+    core.signTradeAgreement(a, c);
+    failures += events.size() != 2 || core.status(a, c) != RelationStatus::Neutral;   // Trade keeps status.
+    for (int i = 0; i < 5; ++i) checkDrift(5.0);
+    core.makePeace(a, b);
+    failures += core.status(a, b) != RelationStatus::Neutral || !core.hasTreaty(a, b, TreatyType::Peace);
+    expectEvent(2, a, b, RelationStatus::Neutral);
+    core.breakAlliance(b, c);
+    failures += core.allied(b, c) || core.hasTreaty(b, c, TreatyType::Alliance);
+    expectEvent(3, b, c, RelationStatus::Neutral);
+    core.breakAlliance(b, c);                             // Already neutral: no second event.
+    failures += events.size() != 4;
+    checkDecay(0.5);
+    dump();
+
+    // Treaty expiry: one tick per day here, so the trade deal (365 days) outlives peace (180).
+    std::vector<std::pair<TreatyType, std::uint64_t>> endings;
+    core.setTreatyExpiryListener([&](const Treaty& t) {
+        const char* types[] = {"peace", "alliance", "trade"};
+        std::cout << "Treaty expired at tick " << core.currentTick() << ": " << types[static_cast<int>(t.type)]
+                  << " between " << registry.name(t.a) << " and " << registry.name(t.b) << std::endl;
+        endings.push_back({t.type, t.expiryTick});
+    });
+    core.formAlliance(a, c);
+    std::cout << "Active treaties: " << core.activeTreatyCount()
+              << ", A-C mask: " << static_cast<int>(core.treatyMask(a, c)) << std::endl;
+    TreatyId alliance = core.treatyBetween(a, c, TreatyType::Alliance);
+    failures += alliance == kNoTreaty || core.treaty(alliance).expiryTick != 365 || core.activeTreatyCount() != 3;
+    failures += core.advanceTo(200) != 1 || endings.size() != 1 || endings[0].first != TreatyType::Peace;
+    failures += core.advanceTo(364) != 0 || !core.allied(a, c);
+    failures += core.advanceTo(365) != 2 || core.allied(a, c) || core.hasTreaty(a, c, TreatyType::Alliance);
+    for (const auto& ending : endings) failures += ending.first == TreatyType::Alliance && ending.second != 365;
+    core.advanceTo(400);
+    failures += core.activeTreatyCount() != 0 || endings.size() != 3;
+    std::cout << "Active treaties after 400 days: " << core.activeTreatyCount()
+              << ", A-C allied: " << core.allied(a, c) << std::endl;
+
+    // Throughput: 200 nations (19,900 pairs), one drift + decay cycle per simulated day.
+    core.reset(200, 7);
+    const int cycles = 1000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < cycles; ++i) {
+        core.driftCycle();
+        core.decayCycle(0.01);
+    }
+    auto us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    checkDrift(5.0);
+    checkDecay(0.01);
+    std::cout << "Drift+decay over " << core.pairCount() << " pairs: " << std::setprecision(1)
+              << us / cycles << " us/cycle" << std::endl;
+
+    // Expiry throughput: 100k trade treaties with staggered durations, drained day by day.
+    core.setTreatyExpiryListener(nullptr);
+    for (int i = 0; i < 100000; ++i)
+        core.signTreaty(static_cast<NationId>(i % 200), static_cast<NationId>((i / 200 + i + 1) % 200),
+                        TreatyType::Trade, 1 + (i % 365));
+    std::size_t signedCount = core.activeTreatyCount();
+    t0 = std::chrono::steady_clock::now();
+    std::size_t expired = 0;
+    for (std::uint64_t day = 1; day <= 400; ++day) expired += core.advanceTo(day);
+    us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    failures += expired != signedCount || core.activeTreatyCount() != 0;
+    std::cout << "Expired " << expired << " of " << signedCount << " treaties in " << us << " us; failures: "
+              << failures << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+// End of diplomacy.cpp
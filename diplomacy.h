@@ -0,0 +1,170 @@
+/**************************************************************************************************
+ * diplomacy.h
+ * Diplomacy Core for Conqueror Engine (Header)
+ *
+ * Native counterpart of diplomacy.py / country_relations.py. Bilateral relations are stored in a
+ * packed upper-triangular matrix indexed by NationId instead of dicts keyed by frozensets or
+ * sorted name tuples:
+ *   - status     (RelationStatus, 1 byte)
+ *   - trust      (0..100 in 8.8 fixed point, 2 bytes)
+ *   - hostility  (0..100 in 8.8 fixed point, 2 bytes)
+ * Each field is its own contiguous array, so the per-cycle drift and decay passes are straight
+ * loops over integers that the compiler vectorizes. war/ally checks are one index computation and
+ * one byte load.
+ *
+ * Status changes are reported through a listener so derived state (movement passability masks)
+ * is updated incrementally.
+ *
+ * Treaties (diplomacy.py's Treaty) are kept in a slot array with a min-heap keyed by expiry tick,
+ * so advancing time costs O(log n) per expiring treaty instead of polling is_active() on every
+ * treaty. Each pair also has a treaty-id slot per type plus a bitmask, so "which treaties do A and
+ * B have" is O(1). A pair holds at most one treaty of each type; signing again renews it.
+ *
+ * Exposed Types:
+ * - TreatyType / Treaty
+ * - DiplomacyCore
+ **************************************************************************************************/
+
+#ifndef DIPLOMACY_H
+#define DIPLOMACY_H
+
+#include "nations.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+//-------------------------------------------------
+// Treaties
+//-------------------------------------------------
+enum class TreatyType : std::uint8_t {
+    Peace = 0,
+    Alliance = 1,
+    Trade = 2
+};
+constexpr int kTreatyTypeCount = 3;
+
+using TreatyId = std::uint32_t;
+constexpr TreatyId kNoTreaty = 0xFFFFFFFFu;
+
+struct Treaty {
+    TreatyType type;
+    NationId a, b;
+    std::uint64_t startTick;
+    std::uint64_t expiryTick;
+};
+
+class DiplomacyCore {
+public:
+    using Fixed = std::uint16_t;                     // 8.8 fixed point.
+    static constexpr int kFixedOne = 256;
+    static constexpr Fixed kFixedMax = 100 * kFixedOne;
+
+    using StatusListener = std::function<void(NationId, NationId, RelationStatus)>;
+    using TreatyListener = std::function<void(const Treaty&)>;   // Called when a treaty expires.
+
+    /**
+     * @brief Sizes the matrix for `nationCount` nations with neutral status.
+     * Initial trust is drawn from 30..70 and hostility from 20..50, as in DiplomaticRelation.
+     */
+    void reset(std::size_t nationCount, std::uint32_t seed = 1);
+
+    void setStatusListener(StatusListener listener) { onStatusChange = std::move(listener); }
+    void setTreatyExpiryListener(TreatyListener listener) { onTreatyExpired = std::move(listener); }
+
+    // Treaty durations are given in game days; this converts them to engine ticks.
+    void setTicksPerDay(std::uint64_t ticks) { ticksPerDay = ticks; }
+
+    // O(1) queries for combat and movement hot paths.
+    RelationStatus status(NationId a, NationId b) const {
+        return a == b || a >= nations || b >= nations ? RelationStatus::Neutral
+                                                      : static_cast<RelationStatus>(statuses[pairIndex(a, b)]);
+    }
+    bool atWar(NationId a, NationId b) const { return status(a, b) == RelationStatus::AtWar; }
+    bool allied(NationId a, NationId b) const { return status(a, b) == RelationStatus::Ally; }
+    double trust(NationId a, NationId b) const;
+    double hostility(NationId a, NationId b) const;
+
+    // Diplomatic actions (deltas match DiplomacyManager in diplomacy.py).
+    void setStatus(NationId a, NationId b, RelationStatus status);
+    void adjust(NationId a, NationId b, double deltaTrust, double deltaHostility);
+    void declareWar(NationId aggressor, NationId target);
+    void makePeace(NationId a, NationId b);
+    void formAlliance(NationId a, NationId b);
+    void breakAlliance(NationId a, NationId b);
+    void signTradeAgreement(NationId a, NationId b);
+
+    // Treaty bookkeeping. All per-pair queries are O(1).
+    TreatyId signTreaty(NationId a, NationId b, TreatyType type, double durationDays);
+    bool revokeTreaty(NationId a, NationId b, TreatyType type);
+    bool hasTreaty(NationId a, NationId b, TreatyType type) const {
+        return (treatyMask(a, b) >> static_cast<int>(type)) & 1u;
+    }
+    std::uint8_t treatyMask(NationId a, NationId b) const {
+        return a == b || a >= nations || b >= nations ? 0 : treatyMasks[pairIndex(a, b)];
+    }
+    TreatyId treatyBetween(NationId a, NationId b, TreatyType type) const;
+    const Treaty& treaty(TreatyId id) const { return treaties[id]; }
+    std::size_t activeTreatyCount() const { return activeTreaties; }
+
+    /**
+     * @brief Advances the diplomatic clock and expires every treaty due at or before `tick`.
+     * @return Number of treaties that expired.
+     */
+    std::size_t advanceTo(std::uint64_t tick);
+    std::uint64_t currentTick() const { return now; }
+
+    /**
+     * @brief One simulate_diplomatic_cycle step over every pair: uniform random drift of up to
+     * +/-maxDelta on trust and hostility, clamped to 0..100.
+     */
+    void driftCycle(double maxDelta = 5.0);
+
+    /**
+     * @brief Relaxes trust and hostility toward neutral baselines by `rate` (0..1) per call.
+     */
+    void decayCycle(double rate, double trustBaseline = 50.0, double hostilityBaseline = 35.0);
+
+    std::size_t nationCount() const { return nations; }
+    std::size_t pairCount() const { return statuses.size(); }
+
+private:
+    std::size_t nations = 0;
+    std::vector<std::uint32_t> rowOffset;            // Pair index of (a, a + 1).
+    std::vector<std::uint8_t> statuses;
+    std::vector<Fixed> trustValues;
+    std::vector<Fixed> hostilityValues;
+    std::uint32_t rngSeed = 1;
+    std::uint32_t cycle = 0;
+    StatusListener onStatusChange;
+
+    // Treaty storage: slots with generations, a lazy-deletion expiry heap, and per-pair indices.
+    struct ExpiryEntry {
+        std::uint64_t expiryTick;
+        TreatyId id;
+        std::uint32_t generation;
+        bool operator>(const ExpiryEntry& other) const { return expiryTick > other.expiryTick; }
+    };
+    std::vector<Treaty> treaties;
+    std::vector<std::uint32_t> treatyGeneration;
+    std::vector<bool> treatyLive;
+    std::vector<TreatyId> freeTreaties;
+    std::priority_queue<ExpiryEntry, std::vector<ExpiryEntry>, std::greater<ExpiryEntry>> expiryHeap;
+    std::vector<TreatyId> pairTreaties;              // pairCount * kTreatyTypeCount slots.
+    std::vector<std::uint8_t> treatyMasks;           // One bit per TreatyType per pair.
+    std::size_t activeTreaties = 0;
+    std::uint64_t now = 0;
+    std::uint64_t ticksPerDay = 1;
+    TreatyListener onTreatyExpired;
+
+    void releaseTreaty(TreatyId id);
+
+    std::size_t pairIndex(NationId a, NationId b) const {
+        if (a > b) { NationId t = a; a = b; b = t; }
+        return rowOffset[a] + (b - a - 1);
+    }
+};
+
+#endif // DIPLOMACY_H
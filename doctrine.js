@@ -126,6 +126,12 @@ export function applyDoctrine(nation, doctrineName) {
     nation.unitSurveillance = doctrine.modifiers.unitSurveillance;
   }
 
+  // The engine's modifier stacks feed combat and economy ticks; keep them in step when it is loaded.
+  const engine = globalThis.Module;
+  if (engine && engine.doctrines && !engine.doctrines.apply(nation.name, doctrineName)) {
+    console.warn(`Doctrine "${doctrineName}" was not registered with the engine for nation "${nation.name}".`);
+  }
+
   console.info(`Doctrine "${doctrineName}" applied to nation "${nation.name}".`);
   return true;
 }
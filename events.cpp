@@ -0,0 +1,384 @@
+/*
+ * events.cpp - Typed event pools, timer-wheel scheduling and per-nation effect batches.
+ */
+
+#include "events.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
+    std::cout << "[" << level << "] " << message << std::endl;
+}
+
+namespace {
+
+constexpr std::uint32_t kSlotMask = 0x3FFFFFFFu;
+
+inline EventHandle makeHandle(EventClass cls, std::uint32_t slot) {
+    return (static_cast<std::uint32_t>(cls) << 30) | slot;
+}
+
+inline std::uint32_t slotOf(EventHandle handle) { return handle & kSlotMask; }
+
+} // namespace
+
+void WorldEventEngine::reset(std::size_t nationCount, std::uint32_t seed, std::uint64_t minuteTicks) {
+    nations = nationCount;
+    ticksPerMinute = std::max<std::uint64_t>(1, minuteTicks);
+    now = 0;
+    rngState = seed ? seed : 1;
+    economic = Pool<EconomicParams>();
+    diplomatic = Pool<DiplomaticParams>();
+    environmental = Pool<EnvironmentalParams>();
+    military = Pool<MilitaryParams>();
+    descriptions.assign(1, std::string());
+    descriptionIds.clear();
+    wheel.assign(kWheelSlots, std::vector<Timer>());
+    pending.clear();
+    grouped.clear();
+    retiring.clear();
+    nationOffsets.assign(nations + 1, 0);
+}
+
+std::uint16_t WorldEventEngine::internDescription(const std::string& text) {
+    auto it = descriptionIds.find(text);
+    if (it != descriptionIds.end()) return it->second;
+    if (descriptions.size() > 0xFFFF) return 0;     // Table full: fall back to the empty description.
+    std::uint16_t id = static_cast<std::uint16_t>(descriptions.size());
+    descriptions.push_back(text);
+    descriptionIds.emplace(text, id);
+    return id;
+}
+
+template <typename Params>
+EventHandle WorldEventEngine::allocate(Pool<Params>& pool, EventClass cls, const Params& params,
+                                       const std::string& description, double durationMinutes, double delayMinutes) {
+    std::uint32_t slot;
+    if (!pool.freeSlots.empty()) {
+        slot = pool.freeSlots.back();
+        pool.freeSlots.pop_back();
+    } else {
+        if (pool.params.size() > kSlotMask) return kNoEvent;
+        slot = static_cast<std::uint32_t>(pool.params.size());
+        pool.params.emplace_back();
+        pool.timing.emplace_back();
+    }
+    pool.params[slot] = params;
+    Timing& t = pool.timing[slot];
+    std::uint64_t delay = static_cast<std::uint64_t>(std::llround(std::max(0.0, delayMinutes) * ticksPerMinute));
+    std::uint64_t duration = static_cast<std::uint64_t>(std::llround(std::max(0.0, durationMinutes) * ticksPerMinute));
+    t.startTick = now + 1 + delay;                  // Activates on the next advance at the earliest.
+    t.endTick = t.startTick + std::max<std::uint64_t>(1, duration);
+    t.descriptionId = internDescription(description);
+    t.state = SlotState::Scheduled;
+    ++pool.live;
+
+    EventHandle handle = makeHandle(cls, slot);
+    schedule(t.startTick, handle, t.generation, false);
+    return handle;
+}
+
+EventHandle WorldEventEngine::scheduleEconomic(const std::string& description, NationId nation, double durationMinutes,
+                                               double economicImpact, double delayMinutes) {
+    if (nation >= nations) return kNoEvent;
+    return allocate(economic, EventClass::Economic, EconomicParams{nation, static_cast<float>(economicImpact)},
+                    description, durationMinutes, delayMinutes);
+}
+
+EventHandle WorldEventEngine::scheduleDiplomatic(const std::string& description, NationId a, NationId b,
+                                                 double durationMinutes, double trustDelta, double hostilityDelta,
+                                                 double delayMinutes) {
+    if (a >= nations || b >= nations || a == b) return kNoEvent;
+    return allocate(diplomatic, EventClass::Diplomatic,
+                    DiplomaticParams{a, b, static_cast<float>(trustDelta), static_cast<float>(hostilityDelta)},
+                    description, durationMinutes, delayMinutes);
+}
+
+EventHandle WorldEventEngine::scheduleEnvironmental(const std::string& description, NationId nation,
+                                                    double durationMinutes, double damageFactor, double delayMinutes) {
+    if (nation >= nations) return kNoEvent;
+    return allocate(environmental, EventClass::Environmental,
+                    EnvironmentalParams{nation, static_cast<float>(damageFactor)}, description, durationMinutes,
+                    delayMinutes);
+}
+
+EventHandle WorldEventEngine::scheduleMilitary(const std::string& description, NationId nation, double durationMinutes,
+                                               double combatModifier, double delayMinutes) {
+    if (nation >= nations) return kNoEvent;
+    return allocate(military, EventClass::Military, MilitaryParams{nation, static_cast<float>(combatModifier)},
+                    description, durationMinutes, delayMinutes);
+}
+
+double WorldEventEngine::uniform(double lo, double hi) {
+    // xorshift32; deterministic per seed so replays and tests are reproducible.
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return lo + (hi - lo) * (rngState / 4294967296.0);
+}
+
+EventHandle WorldEventEngine::triggerRandomEvent() {
+    if (nations == 0) return kNoEvent;
+    auto randint = [this](int lo, int hi) { return lo + static_cast<int>(uniform(0, hi - lo + 1)); };
+    NationId nation = static_cast<NationId>(uniform(0, static_cast<double>(nations)));
+    double roll = uniform(0, 100);
+    if (roll < 30)
+        return scheduleEconomic("Global market fluctuation", nation, randint(5, 15), uniform(0.8, 1.2));
+    if (roll < 55) {
+        if (nations < 2) return kNoEvent;
+        NationId other = static_cast<NationId>((nation + 1 + static_cast<std::size_t>(uniform(0, nations - 1))) % nations);
+        return scheduleDiplomatic("Sudden diplomatic incident", nation, other, randint(5, 10), uniform(-10, 5),
+                                  uniform(5, 15));
+    }
+    if (roll < 75)
+        return scheduleEnvironmental("Severe drought affecting agriculture", nation, randint(10, 20), uniform(0.3, 0.7));
+    return scheduleMilitary("Localized border skirmish", nation, randint(3, 8), uniform(0.9, 1.1));
+}
+
+WorldEventEngine::Timing* WorldEventEngine::timingOf(EventHandle handle) {
+    return const_cast<Timing*>(static_cast<const WorldEventEngine*>(this)->timingOf(handle));
+}
+
+const WorldEventEngine::Timing* WorldEventEngine::timingOf(EventHandle handle) const {
+    if (handle == kNoEvent) return nullptr;
+    std::uint32_t slot = slotOf(handle);
+    const std::vector<Timing>* timing = nullptr;
+    switch (classOf(handle)) {
+        case EventClass::Economic: timing = &economic.timing; break;
+        case EventClass::Diplomatic: timing = &diplomatic.timing; break;
+        case EventClass::Environmental: timing = &environmental.timing; break;
+        case EventClass::Military: timing = &military.timing; break;
+    }
+    return slot < timing->size() ? &(*timing)[slot] : nullptr;
+}
+
+void WorldEventEngine::release(EventHandle handle) {
+    Timing* t = timingOf(handle);
+    t->state = SlotState::Retiring;
+    ++t->generation;                                // Any timer still in the wheel goes stale.
+    retiring.push_back(handle);
+    switch (classOf(handle)) {
+        case EventClass::Economic: --economic.live; break;
+        case EventClass::Diplomatic: --diplomatic.live; break;
+        case EventClass::Environmental: --environmental.live; break;
+        case EventClass::Military: --military.live; break;
+    }
+}
+
+void WorldEventEngine::recycleRetired() {
+    for (EventHandle handle : retiring) {
+        timingOf(handle)->state = SlotState::Free;
+        std::uint32_t slot = slotOf(handle);
+        switch (classOf(handle)) {
+            case EventClass::Economic: economic.freeSlots.push_back(slot); break;
+            case EventClass::Diplomatic: diplomatic.freeSlots.push_back(slot); break;
+            case EventClass::Environmental: environmental.freeSlots.push_back(slot); break;
+            case EventClass::Military: military.freeSlots.push_back(slot); break;
+        }
+    }
+    retiring.clear();
+}
+
+bool WorldEventEngine::cancel(EventHandle handle) {
+    Timing* t = timingOf(handle);
+    if (!t || t->state == SlotState::Free || t->state == SlotState::Retiring) return false;
+    if (t->state == SlotState::Active) emit(handle, false);
+    release(handle);
+    return true;
+}
+
+bool WorldEventEngine::isActive(EventHandle handle) const {
+    const Timing* t = timingOf(handle);
+    return t && t->state == SlotState::Active;
+}
+
+const std::string& WorldEventEngine::description(EventHandle handle) const {
+    const Timing* t = timingOf(handle);
+    return descriptions[t && t->state != SlotState::Free ? t->descriptionId : 0];
+}
+
+std::size_t WorldEventEngine::liveCount(EventClass cls) const {
+    switch (cls) {
+        case EventClass::Economic: return economic.live;
+        case EventClass::Diplomatic: return diplomatic.live;
+        case EventClass::Environmental: return environmental.live;
+        case EventClass::Military: return military.live;
+    }
+    return 0;
+}
+
+void WorldEventEngine::schedule(std::uint64_t deadline, EventHandle handle, std::uint32_t generation, bool expiry) {
+    wheel[deadline & (kWheelSlots - 1)].push_back(Timer{deadline, handle, generation, expiry});
+}
+
+void WorldEventEngine::emit(EventHandle handle, bool starting) {
+    std::uint32_t slot = slotOf(handle);
+    EventEffect effect{handle, classOf(handle), starting, kNoNation, 0.0f, 0.0f};
+    switch (effect.eventClass) {
+        case EventClass::Economic:
+            effect.value = economic.params[slot].economicImpact;
+            pending.push_back({economic.params[slot].nation, effect});
+            break;
+        case EventClass::Diplomatic: {
+            const DiplomaticParams& p = diplomatic.params[slot];
+            effect.value = p.trustDelta;
+            effect.value2 = p.hostilityDelta;
+            effect.other = p.b;
+            pending.push_back({p.a, effect});
+            effect.other = p.a;
+            pending.push_back({p.b, effect});
+            break;
+        }
+        case EventClass::Environmental:
+            effect.value = environmental.params[slot].damageFactor;
+            pending.push_back({environmental.params[slot].nation, effect});
+            break;
+        case EventClass::Military:
+            effect.value = military.params[slot].combatModifier;
+            pending.push_back({military.params[slot].nation, effect});
+            break;
+    }
+}
+
+void WorldEventEngine::fire(const Timer& timer) {
+    Timing* t = timingOf(timer.handle);
+    if (!t || t->generation != timer.generation) return;   // Cancelled or slot reused.
+    if (!timer.expiry && t->state == SlotState::Scheduled) {
+        t->state = SlotState::Active;
+        emit(timer.handle, true);
+        schedule(t->endTick, timer.handle, t->generation, true);
+    } else if (timer.expiry && t->state == SlotState::Active) {
+        emit(timer.handle, false);
+        release(timer.handle);
+    }
+}
+
+std::size_t WorldEventEngine::dispatch() {
+    std::size_t count = pending.size();
+    if (count == 0) {
+        recycleRetired();
+        return 0;
+    }
+    // Counting sort by nation keeps each nation's effects contiguous and in firing order.
+    std::fill(nationOffsets.begin(), nationOffsets.end(), 0);
+    for (const PendingEffect& p : pending) ++nationOffsets[p.nation + 1];
+    for (std::size_t n = 0; n < nations; ++n) nationOffsets[n + 1] += nationOffsets[n];
+    grouped.resize(count);
+    for (const PendingEffect& p : pending) grouped[nationOffsets[p.nation]++] = p.effect;
+    // nationOffsets[n] now holds the end of nation n's run.
+    std::uint32_t begin = 0;
+    for (std::size_t n = 0; n < nations; ++n) {
+        std::uint32_t end = nationOffsets[n];
+        if (end > begin && onEffects) onEffects(static_cast<NationId>(n), grouped.data() + begin, end - begin);
+        begin = end;
+    }
+    pending.clear();
+    recycleRetired();
+    return count;
+}
+
+std::size_t WorldEventEngine::advanceTo(std::uint64_t tick) {
+    std::size_t dispatched = dispatch();            // Expiries queued by cancel() since the last tick.
+    while (now < tick) {
+        ++now;
+        std::vector<Timer>& bucket = wheel[now & (kWheelSlots - 1)];
+        for (std::size_t i = 0; i < bucket.size();) {
+            if (bucket[i].deadline > now) { ++i; continue; }    // Due in a later round.
+            Timer timer = bucket[i];
+            bucket[i] = bucket.back();
+            bucket.pop_back();
+            fire(timer);
+        }
+        dispatched += dispatch();
+    }
+    return dispatched;
+}
+
+//-------------------------------------------------
+// Module entry points
+//-------------------------------------------------
+WorldEventEngine& worldEvents() {
+    static WorldEventEngine engine;
+    return engine;
+}
+
+bool initEvents() {
+    WorldEventEngine& engine = worldEvents();
+    if (engine.nationCount() == 0)
+        logEvent("Events: No nations registered; random events are disabled.", "WARNING");
+    logEvent("Events: World event engine initialized for " + std::to_string(engine.nationCount()) + " nations.");
+    return true;
+}
+
+void updateEvents() {
+    WorldEventEngine& engine = worldEvents();
+    // events.py rolls 30% every 2 seconds; at 30 ticks per second that is 0.5% per tick.
+    if (engine.nationCount() > 0 && rand() % 1000 < 5) engine.triggerRandomEvent();
+    engine.advanceTo(engine.currentTick() + 1);
+}
+
+void cleanupEvents() {
+    worldEvents().reset(0);
+    logEvent("Events: World event engine shut down.");
+}
+
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DEVENTS_TEST)
+// Schedules the predefined events from events.py, then times a large random workload.
+#ifdef EVENTS_TEST
+#include <chrono>
+
+int main() {
+    NationRegistry registry;
+    NationId a = registry.intern("A", "NationA");
+    NationId b = registry.intern("B", "NationB");
+    NationId c = registry.intern("C", "NationC");
+
+    WorldEventEngine engine;
+    engine.reset(registry.count(), 7, 1);           // One tick per minute keeps the log short.
+    const char* classNames[] = {"Economic", "Diplomatic", "Environmental", "Military"};
+    engine.setEffectHandler([&](NationId nation, const EventEffect* effects, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const EventEffect& e = effects[i];
+            std::cout << "t=" << engine.currentTick() << " " << registry.name(nation) << ": "
+                      << classNames[static_cast<int>(e.eventClass)] << (e.starting ? " begins" : " ends")
+                      << " (" << engine.description(e.event) << ", value " << e.value << ")" << std::endl;
+        }
+    });
+
+    engine.scheduleEconomic("Recession hits major economies", a, 10, 0.85);
+    engine.scheduleDiplomatic("Unexpected summit leads to improved relations", b, c, 8, +8, -5);
+    engine.scheduleEnvironmental("Massive wildfire devastates regions", c, 12, 0.6);
+    EventHandle naval = engine.scheduleMilitary("Naval confrontation in disputed waters", a, 7, 1.05, 2);
+    engine.advanceTo(5);
+    engine.cancel(naval);
+    engine.advanceTo(20);
+
+    std::size_t live = 0;
+    for (int cls = 0; cls < kEventClassCount; ++cls) live += engine.liveCount(static_cast<EventClass>(cls));
+    std::cout << "Live events after 20 minutes: " << live << std::endl;
+    int failures = live != 0;
+
+    // Throughput: 200 nations, 100k random events spread over ~6 hours of ticks at 30 Hz.
+    engine.reset(200, 99, 1800);
+    std::size_t effects = 0;
+    engine.setEffectHandler([&](NationId, const EventEffect*, std::size_t count) { effects += count; });
+    auto t0 = std::chrono::steady_clock::now();
+    for (std::uint64_t tick = 1; tick <= 650000; ++tick) {
+        if (tick % 6 == 0 && tick <= 600000) engine.triggerRandomEvent();
+        engine.advanceTo(tick);
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    live = 0;
+    for (int cls = 0; cls < kEventClassCount; ++cls) live += engine.liveCount(static_cast<EventClass>(cls));
+    std::cout << "650000 ticks, 100000 events, " << effects << " effects dispatched in " << ms << " ms ("
+              << live << " still live)" << std::endl;
+    failures += live != 0;
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+// End of events.cpp
@@ -1,7 +1,185 @@
+/**************************************************************************************************
+ * events.h
+ * World Event Engine for Conqueror Engine (Header)
+ *
+ * Native counterpart of events.py's WorldEventManager. Events are kept in one typed pool per event
+ * class (economic, diplomatic, environmental, military), so each class stores only its own
+ * parameters and slots are recycled through a free list instead of list.remove().
+ *
+ * Activation and expiry are driven by a hashed timer wheel: advancing one tick touches a single
+ * wheel slot, so cost scales with the number of events due rather than with every live event.
+ *
+ * Effects that fire during a tick are grouped by affected nation (a counting sort over NationId)
+ * and handed to the effect handler once per nation, so consumers (economy, diplomacy, combat) can
+ * apply a nation's changes together.
+ *
+ * Exposed Types:
+ * - EventClass / EventHandle / EventEffect
+ * - WorldEventEngine
+ *
+ * Module entry points (operate on the process-wide engine returned by worldEvents()):
+ * - initEvents / updateEvents / cleanupEvents
+ **************************************************************************************************/
+
 #ifndef EVENTS_H
 #define EVENTS_H
 
-// Events module header
+#include "nations.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//-------------------------------------------------
+// Event identity
+//-------------------------------------------------
+enum class EventClass : std::uint8_t {
+    Economic = 0,
+    Diplomatic = 1,
+    Environmental = 2,
+    Military = 3
+};
+constexpr int kEventClassCount = 4;
+
+// Handle layout: event class in the top 2 bits, pool slot in the low 30.
+using EventHandle = std::uint32_t;
+constexpr EventHandle kNoEvent = 0xFFFFFFFFu;
+
+//-------------------------------------------------
+// One effect delivered to a nation (activation or expiry of an event)
+//-------------------------------------------------
+struct EventEffect {
+    EventHandle event;
+    EventClass eventClass;
+    bool starting;              // true on activation, false on expiry.
+    NationId other;             // Counterpart nation for diplomatic events, else kNoNation.
+    float value;                // economic_impact / trust_delta / damage_factor / combat_modifier.
+    float value2;               // hostility_delta for diplomatic events, else 0.
+};
+
+//-------------------------------------------------
+// World Event Engine
+//-------------------------------------------------
+class WorldEventEngine {
+public:
+    // Called once per affected nation per tick with that nation's effects, in firing order.
+    using EffectHandler = std::function<void(NationId, const EventEffect*, std::size_t)>;
+
+    /**
+     * @brief Clears every pool and the timer wheel.
+     * @param ticksPerMinute Conversion used for the minute-based durations of events.py.
+     */
+    void reset(std::size_t nationCount, std::uint32_t seed = 1, std::uint64_t ticksPerMinute = 1800);
+
+    void setEffectHandler(EffectHandler handler) { onEffects = std::move(handler); }
+
+    // Scheduling (events.py's event classes). `delayMinutes` postpones activation.
+    EventHandle scheduleEconomic(const std::string& description, NationId nation, double durationMinutes,
+                                 double economicImpact, double delayMinutes = 0);
+    EventHandle scheduleDiplomatic(const std::string& description, NationId a, NationId b, double durationMinutes,
+                                   double trustDelta, double hostilityDelta, double delayMinutes = 0);
+    EventHandle scheduleEnvironmental(const std::string& description, NationId nation, double durationMinutes,
+                                      double damageFactor, double delayMinutes = 0);
+    EventHandle scheduleMilitary(const std::string& description, NationId nation, double durationMinutes,
+                                 double combatModifier, double delayMinutes = 0);
+
+    // Weighted random event (30/25/20/25) against random nations, as trigger_random_event().
+    EventHandle triggerRandomEvent();
+
+    // Removes an event early. An active event still delivers its expiry effect.
+    bool cancel(EventHandle handle);
+
+    /**
+     * @brief Advances to `tick`, firing due activations/expiries and dispatching grouped effects.
+     * @return Number of effects dispatched.
+     */
+    std::size_t advanceTo(std::uint64_t tick);
+
+    bool isActive(EventHandle handle) const;
+    EventClass classOf(EventHandle handle) const { return static_cast<EventClass>(handle >> 30); }
+    const std::string& description(EventHandle handle) const;
+    std::size_t liveCount(EventClass cls) const;
+    std::size_t nationCount() const { return nations; }
+    std::uint64_t currentTick() const { return now; }
+
+private:
+    // Retiring: finished, but kept readable until this tick's effects have been dispatched.
+    enum class SlotState : std::uint8_t { Free, Scheduled, Active, Retiring };
+
+    struct Timing {
+        std::uint64_t startTick = 0;
+        std::uint64_t endTick = 0;
+        std::uint32_t generation = 0;
+        std::uint16_t descriptionId = 0;
+        SlotState state = SlotState::Free;
+    };
+
+    // Per-class parameter records.
+    struct EconomicParams { NationId nation; float economicImpact; };
+    struct DiplomaticParams { NationId a, b; float trustDelta, hostilityDelta; };
+    struct EnvironmentalParams { NationId nation; float damageFactor; };
+    struct MilitaryParams { NationId nation; float combatModifier; };
+
+    template <typename Params>
+    struct Pool {
+        std::vector<Params> params;
+        std::vector<Timing> timing;
+        std::vector<std::uint32_t> freeSlots;
+        std::size_t live = 0;
+    };
+
+    struct Timer {
+        std::uint64_t deadline;
+        EventHandle handle;
+        std::uint32_t generation;
+        bool expiry;
+    };
+    static constexpr std::size_t kWheelSlots = 4096;   // Power of two; longer timers wait extra rounds.
+
+    std::size_t nations = 0;
+    std::uint64_t ticksPerMinute = 1800;
+    std::uint64_t now = 0;
+    std::uint32_t rngState = 1;
+
+    Pool<EconomicParams> economic;
+    Pool<DiplomaticParams> diplomatic;
+    Pool<EnvironmentalParams> environmental;
+    Pool<MilitaryParams> military;
+
+    std::vector<std::string> descriptions;          // Interned description strings.
+    std::unordered_map<std::string, std::uint16_t> descriptionIds;
+    std::vector<std::vector<Timer>> wheel;
+
+    // Per-tick effect batch, grouped by nation with a counting sort.
+    struct PendingEffect { NationId nation; EventEffect effect; };
+    std::vector<PendingEffect> pending;
+    std::vector<EventEffect> grouped;
+    std::vector<std::uint32_t> nationOffsets;
+    std::vector<EventHandle> retiring;
+    EffectHandler onEffects;
+
+    template <typename Params>
+    EventHandle allocate(Pool<Params>& pool, EventClass cls, const Params& params, const std::string& description,
+                         double durationMinutes, double delayMinutes);
+    Timing* timingOf(EventHandle handle);
+    const Timing* timingOf(EventHandle handle) const;
+    void release(EventHandle handle);
+    void recycleRetired();
+    void schedule(std::uint64_t deadline, EventHandle handle, std::uint32_t generation, bool expiry);
+    void fire(const Timer& timer);
+    void emit(EventHandle handle, bool starting);
+    std::size_t dispatch();
+    std::uint16_t internDescription(const std::string& text);
+    double uniform(double lo, double hi);
+};
+
+// Process-wide engine used by the module entry points below.
+WorldEventEngine& worldEvents();
+
+// Events module entry points.
 // Declares functions for initializing, updating, and cleaning up the events module.
 bool initEvents();
 void updateEvents();
@@ -12,7 +12,12 @@
  * - Combat Simulation: A placeholder for deterministic or probabilistic combat logic.
  * - Economic Model: Tracks and updates the national economy.
  * - Government & Policy: Simulates political changes and their effects.
- * - Thread-Safe Chat: A simple, non-blocking console chat system for player interaction.
+ * - AI: Garrison units driven by a shared, batched behavior tree (unit_ai.h); nation plans are
+ *   time-sliced under a per-tick budget with worker offload (ai_scheduler.h) and target cells come
+ *   from per-nation influence maps (influence.h). Nations recruit daily from the variant catalog
+ *   with a utility-based planner (recruitment.h). Units move as steered formations (steering.h)
+ *   and attack the enemy city nearest the chosen cell (city_index.h).
+ * - Thread-Safe Chat: Console chat posted through a lock-free lobby queue (chat.h) and drained per tick.
  *
  * This file is designed to be self-contained and provides a complete, runnable engine core.
  * Areas marked with `// TODO:` are intended for expansion with game-specific logic or
@@ -34,6 +39,7 @@
 #include <ctime>
 #include <limits>
 #include <algorithm>
+#include <random>
 #include <functional>
 #include <memory>
 #include <string>
@@ -41,6 +47,29 @@
 // C-style headers for specific functions
 #include <cfloat> // For FLT_MAX
 
+// Engine Subsystems
+#include "territory.h"
+#include "borders.h"
+#include "passability.h"
+#include "diplomacy.h"
+#include "events.h"
+#include "modifiers.h"
+#include "combat.h"
+#include "government.h"
+#include "cities.h"
+#include "city_index.h"
+#include "road_network.h"
+#include "worldpack.h"
+#include "chat.h"
+#include "ai_scheduler.h"
+#include "influence.h"
+#include "recruitment.h"
+#include "unit_ai.h"
+#include "territory_router.h"
+#include "marker_clusters.h"
+#include "movement.h"
+#include "geo.h"
+
 // Use a dedicated namespace to avoid polluting the global namespace.
 namespace GameEngine {
 
@@ -74,6 +103,9 @@ void logEvent(const std::string &msg) {
     // TODO: Replace with a more robust logging system (e.g., file or network logger).
 }
 
+// Simulation clock: kTicksPerGameDay and kHoursPerTick come from movement.h.
+constexpr std::uint64_t kTicksPerGameYear = 365 * kTicksPerGameDay;
+
 /**
  * @class Module
  * @brief Abstract base class for all engine subsystems.
@@ -101,16 +133,25 @@ public:
         int destX, destY; // Destination coordinates
         std::vector<std::pair<int, int>> path;
         bool isMoving;
+        NationId nation; // Owning nation; kNoNation for units that ignore borders.
 
-        Unit(const std::string &n, int h, int startX, int startY)
-            : name(n), health(h), x(startX), y(startY), destX(startX), destY(startY), isMoving(false) {}
+        Unit(const std::string &n, int h, int startX, int startY, NationId owner = kNoNation)
+            : name(n), health(h), x(startX), y(startY), destX(startX), destY(startY), isMoving(false), nation(owner) {}
     };
 
 private:
     std::vector<Unit> units;
     std::vector<std::vector<int>> grid; // Game world grid: 0 = traversable, 1 = obstacle
+    std::vector<NationId> cellOwners;   // Territory owner per grid cell (row-major), kNoNation = unclaimed
     int gridWidth, gridHeight;
+    // Where the grid lies on the map: cell (x, y) starts at latitude gridSouth + y * gridCellDegrees
+    // and longitude gridWest + x * gridCellDegrees. The demo grid spans northern France and its
+    // eastern neighbours.
+    double gridSouth = 44.0, gridWest = 0.0, gridCellDegrees = 0.5;
     std::mutex unitMutex; // Protects access to the units vector.
+    const PassabilityMasks* passability = nullptr; // Movement rules per nation; owned by TerritoryModule.
+    // Told the centre of every cell a unit steps onto (see TerritoryModule::captureAt).
+    std::function<void(double lat, double lng, NationId nation)> captureHandler;
 
     // A* Pathfinding Implementation
     struct Node {
@@ -133,9 +174,12 @@ private:
      * @param startY Starting Y coordinate.
      * @param goalX Destination X coordinate.
      * @param goalY Destination Y coordinate.
+     * @param enterable The moving unit's passability mask; cells owned by nations it may not
+     *                  enter (e.g. neutral nations) are treated as obstacles.
      * @return A vector of (x, y) pairs representing the path. Empty if no path is found.
      */
-    std::vector<std::pair<int, int>> computePath(int startX, int startY, int goalX, int goalY) {
+    std::vector<std::pair<int, int>> computePath(int startX, int startY, int goalX, int goalY,
+                                                 NationMask enterable = NationMask()) {
         auto heuristic = [&](int x, int y) {
             // Manhattan distance heuristic
             return static_cast<float>(std::abs(x - goalX) + std::abs(y - goalY));
@@ -174,6 +218,10 @@ private:
                 if (nx < 0 || nx >= gridWidth || ny < 0 || ny >= gridHeight || grid[ny][nx] == 1 || closedSet[ny][nx]) {
                     continue;
                 }
+                // Diplomatic passability: one owner load and one bit test per node.
+                if (!enterable.allows(cellOwners[ny * gridWidth + nx])) {
+                    continue;
+                }
 
                 float gNew = current.g + 1.0f;
                 if (gNew < allNodes[ny][nx].g) {
@@ -204,6 +252,7 @@ public:
         gridWidth = 20;
         gridHeight = 20;
         grid.assign(gridHeight, std::vector<int>(gridWidth, 0));
+        cellOwners.assign(gridWidth * gridHeight, kNoNation);
 
         // Create a simple obstacle wall
         for (int i = 5; i < 15; ++i) {
@@ -219,22 +268,32 @@ public:
     }
 
     void update() override {
-        std::lock_guard<std::mutex> lock(unitMutex);
-        for (auto &unit : units) {
-            if (unit.isMoving && !unit.path.empty()) {
-                auto nextStep = unit.path.front();
-                unit.path.erase(unit.path.begin());
-                unit.x = nextStep.first;
-                unit.y = nextStep.second;
-
-                logEvent("Unit " + unit.name + " moved to (" + std::to_string(unit.x) + "," + std::to_string(unit.y) + ")");
-
-                if (unit.path.empty()) {
-                    unit.isMoving = false;
-                    logEvent("Unit " + unit.name + " has reached its destination.");
+        std::vector<std::pair<std::size_t, NationId>> occupied; // Cells stepped onto, and by whom.
+        {
+            std::lock_guard<std::mutex> lock(unitMutex);
+            for (auto &unit : units) {
+                if (unit.isMoving && !unit.path.empty()) {
+                    auto nextStep = unit.path.front();
+                    unit.path.erase(unit.path.begin());
+                    unit.x = nextStep.first;
+                    unit.y = nextStep.second;
+                    occupied.push_back({static_cast<std::size_t>(unit.y * gridWidth + unit.x), unit.nation});
+
+                    logEvent("Unit " + unit.name + " moved to (" + std::to_string(unit.x) + "," + std::to_string(unit.y) + ")");
+
+                    if (unit.path.empty()) {
+                        unit.isMoving = false;
+                        logEvent("Unit " + unit.name + " has reached its destination.");
+                    }
                 }
             }
         }
+        // Outside the lock: a capture batch calls back into syncCellOwners().
+        if (!captureHandler) return;
+        for (const auto& step : occupied) {
+            int x = static_cast<int>(step.first % gridWidth), y = static_cast<int>(step.first / gridWidth);
+            captureHandler(gridSouth + (y + 0.5) * gridCellDegrees, gridWest + (x + 0.5) * gridCellDegrees, step.second);
+        }
     }
 
     void shutdown() override {
@@ -251,7 +310,8 @@ public:
         Unit &unit = units[unitIndex];
         unit.destX = destX;
         unit.destY = destY;
-        unit.path = computePath(unit.x, unit.y, destX, destY);
+        NationMask enterable = passability ? passability->enterMask(unit.nation) : NationMask();
+        unit.path = computePath(unit.x, unit.y, destX, destY, enterable);
         unit.isMoving = !unit.path.empty();
 
         if (unit.isMoving) {
@@ -261,6 +321,54 @@ public:
         }
     }
 
+    // Wires in the movement rules derived from diplomatic relations (see TerritoryModule).
+    void attachPassability(const PassabilityMasks* masks) {
+        std::lock_guard<std::mutex> lock(unitMutex);
+        passability = masks;
+    }
+
+    // Units occupy every cell they step onto; the handler decides whether that takes the ground.
+    void setCaptureHandler(std::function<void(double lat, double lng, NationId nation)> handler) {
+        std::lock_guard<std::mutex> lock(unitMutex);
+        captureHandler = std::move(handler);
+    }
+
+    // Places the grid on the map; takes effect at the next syncCellOwners().
+    void setGridFrame(double south, double west, double cellDegrees) {
+        std::lock_guard<std::mutex> lock(unitMutex);
+        gridSouth = south;
+        gridWest = west;
+        gridCellDegrees = cellDegrees;
+    }
+
+    // Copies the territory owner at every cell centre into the pathfinding grid. Call again
+    // whenever captures change hands (see TerritoryModule::setCaptureListener).
+    void syncCellOwners(const TerritoryIndex& territory) {
+        std::lock_guard<std::mutex> lock(unitMutex);
+        std::vector<double> lats(cellOwners.size()), lngs(cellOwners.size());
+        for (int y = 0; y < gridHeight; ++y) {
+            for (int x = 0; x < gridWidth; ++x) {
+                lats[y * gridWidth + x] = gridSouth + (y + 0.5) * gridCellDegrees;
+                lngs[y * gridWidth + x] = gridWest + (x + 0.5) * gridCellDegrees;
+            }
+        }
+        territory.ownersAt(lats.data(), lngs.data(), cellOwners.size(), cellOwners.data());
+    }
+
+    // Syncs the grid with the loaded territory; units created without a nation join the owner of
+    // the cell they stand on.
+    void attachTerritory(const TerritoryIndex& territory) {
+        syncCellOwners(territory);
+        std::lock_guard<std::mutex> lock(unitMutex);
+        for (auto &unit : units) {
+            if (unit.nation == kNoNation) unit.nation = cellOwners[unit.y * gridWidth + unit.x];
+        }
+    }
+
+    NationId cellOwner(int x, int y) const { return cellOwners[y * gridWidth + x]; }
+    // Caller must not hold a reference across setDestination() or update().
+    const Unit& unitAt(size_t unitIndex) const { return units[unitIndex]; }
+
     void printStatus() const {
         // Use a const_cast or a mutable mutex if you need to lock in a const function.
         // Or, better, make the calling context responsible for locking if needed.
@@ -281,8 +389,17 @@ public:
 
 class CombatModule : public Module {
     std::mutex combatMutex;
+    const ModifierStacks& modifiers;
+    CombatResolver combat;
 public:
+    explicit CombatModule(const ModifierStacks& modifierStacks) : modifiers(modifierStacks) {}
+
     bool init() override {
+        // Attack and defense scale with the nation's folded combatEffectiveness stack, so doctrines,
+        // policies and military events reach every engagement the resolver settles.
+        combat.setCombatMultiplier([this](const CombatUnit& unit) {
+            return static_cast<double>(modifiers.multiplier(unit.nation, ModifierStat::CombatEffectiveness));
+        });
         logEvent("CombatModule: Initialized.");
         // TODO: Load weapon stats, armor types, and damage formulas from data files (e.g., JSON, XML).
         return true;
@@ -304,31 +421,52 @@ public:
         logEvent("CombatModule: Shutdown complete.");
         // TODO: Clean up any allocated combat resources.
     }
+
+    CombatResolver& resolver() { return combat; }
 };
 
 /*************** Stage 4: Economy Module ****************/
 
 class EconomyModule : public Module {
-    double nationalTreasury;
+    static constexpr double kResourceShare = 0.5; // Resources (materials) gathered per unit of income.
+    std::vector<double> treasuries;           // Per nation, indexed by NationId.
+    std::vector<double> resources;            // Per nation stockpile paid into unit resource costs.
     std::mutex econMutex;
+    const ModifierStacks& modifiers;          // Folded event/doctrine/policy multipliers (ModifierModule).
+    const CitySystem& cities;                 // Per-nation city production (CityModule).
+    NationId treasuryNation = kNoNation;      // Nation reported in logs; kNoNation reports the world total.
 public:
+    static constexpr double kStartingTreasury = 10000.0;
+    static constexpr double kStartingResources = 5000.0;
+
+    EconomyModule(const ModifierStacks& modifierStacks, const CitySystem& citySystem)
+        : modifiers(modifierStacks), cities(citySystem) {}
+
     bool init() override {
-        nationalTreasury = 10000.0;
-        logEvent("EconomyModule: Initialized with treasury of " + std::to_string(nationalTreasury));
+        treasuries.assign(modifiers.nationCount(), kStartingTreasury);
+        resources.assign(modifiers.nationCount(), kStartingResources);
+        logEvent("EconomyModule: Initialized " + std::to_string(treasuries.size()) +
+                 " national treasuries of " + std::to_string(kStartingTreasury));
         return true;
     }
 
     void update() override {
         std::lock_guard<std::mutex> lock(econMutex);
-        // TODO: Implement a more sophisticated economic model.
-        //  - Income: Taxes from population, trade tariffs, resource sales.
-        //  - Expenses: Unit upkeep, building maintenance, research costs.
-        //  - Growth: Factors like infrastructure, policies, and events should affect GDP.
-        double growth = (rand() % 20 - 5) * 0.5; // Simulate minor fluctuations
-        nationalTreasury += growth;
+        // Income: annual city production per nation, scaled by the folded DailyIncome multiplier.
+        // TODO: Expenses (unit upkeep, building maintenance, research costs).
+        const std::size_t n = std::min(treasuries.size(), cities.nationCount());
+        const double* income = cities.nationIncome();
+        const float* multiplier = modifiers.column(ModifierStat::DailyIncome);
+        const double yearsPerTick = 1.0 / kTicksPerGameYear;
+        double* treasury = treasuries.data();
+        double* stock = resources.data();
+        for (std::size_t i = 0; i < n; ++i) {
+            treasury[i] += income[i] * multiplier[i] * yearsPerTick;
+            stock[i] += income[i] * kResourceShare * yearsPerTick;
+        }
 
         if (rand() % 150 < 10) { // Occasional log
-            logEvent("Economy: Treasury updated to " + std::to_string(nationalTreasury));
+            logEvent("Economy: Treasury updated to " + std::to_string(reportedTreasury()));
         }
     }
 
@@ -336,111 +474,801 @@ public:
         // Persist final economic state to a file.
         std::ofstream ofs("economy_shutdown_state.txt");
         if (ofs) {
-            ofs << "Final National Treasury: " << nationalTreasury << std::endl;
+            ofs << "Final National Treasury: " << reportedTreasury() << std::endl;
         }
         logEvent("EconomyModule: Shutdown complete. State saved.");
     }
+
+    void setTreasuryNation(NationId nation) {
+        std::lock_guard<std::mutex> lock(econMutex);
+        treasuryNation = nation;
+    }
+
+    double treasuryOf(NationId nation) const { return nation < treasuries.size() ? treasuries[nation] : 0.0; }
+    double resourcesOf(NationId nation) const { return nation < resources.size() ? resources[nation] : 0.0; }
+    std::size_t nationCount() const { return treasuries.size(); }
+    // Columns for batched planners (index = NationId).
+    const double* treasuryColumn() const { return treasuries.data(); }
+    const double* resourceColumn() const { return resources.data(); }
+
+    // Charges a purchase; fails without charging if either stock is short.
+    bool spend(NationId nation, double money, double materials) {
+        std::lock_guard<std::mutex> lock(econMutex);
+        if (nation >= treasuries.size() || treasuries[nation] < money || resources[nation] < materials) return false;
+        treasuries[nation] -= money;
+        resources[nation] -= materials;
+        return true;
+    }
+
+private:
+    double reportedTreasury() const {
+        if (treasuryNation < treasuries.size()) return treasuries[treasuryNation];
+        double total = 0.0;
+        for (double t : treasuries) total += t;
+        return total;
+    }
 };
 
 /*************** Stage 5: Government Module ****************/
 
 class GovernmentModule : public Module {
-    std::string currentPolicy;
-    int ticksSinceLastChange;
+    const NationRegistry& registry;         // Filled by TerritoryModule before this module initializes.
+    ModifierStacks& modifiers;
     std::mutex govMutex;
 public:
+    GovernmentModule(const NationRegistry& nationRegistry, ModifierStacks& modifierStacks)
+        : registry(nationRegistry), modifiers(modifierStacks) {}
+
     bool init() override {
-        currentPolicy = "Neutral";
-        ticksSinceLastChange = 0;
-        logEvent("GovernmentModule: Initialized with policy: " + currentPolicy);
-        return true;
+        GovernmentSystem& system = governments();
+        system.reset(registry.count(), static_cast<std::uint32_t>(time(nullptr)));
+        // Policy changes arrive as events; only the affected nation's modifiers are refreshed.
+        system.setPolicyListener([this](const PolicyChange& change) {
+            refreshModifiers(change.nation);
+            logEvent("Government: " + registry.name(change.nation) + " shifted policy from '" +
+                     GovernmentSystem::policyName(change.from) + "' to '" + GovernmentSystem::policyName(change.to) + "'.");
+        });
+        for (std::size_t n = 0; n < system.nationCount(); ++n) refreshModifiers(static_cast<NationId>(n));
+        return initGovernment();
     }
 
     void update() override {
         std::lock_guard<std::mutex> lock(govMutex);
-        ticksSinceLastChange++;
-        // TODO: Base policy changes on game events, player choices, or internal pressures (e.g., low stability).
-        if (ticksSinceLastChange > 200) {
-            currentPolicy = (currentPolicy == "Neutral") ? "Expansionist" : "Neutral";
-            logEvent("Government: Policy has shifted to '" + currentPolicy + "'.");
-            ticksSinceLastChange = 0;
-        }
+        updateGovernment();
     }
 
     void shutdown() override {
+        cleanupGovernment();
         logEvent("GovernmentModule: Shutdown complete.");
-        // TODO: Save final government state if necessary.
+    }
+
+    // change_government() for one nation; re-derives its economy and combat modifiers.
+    void changeGovernment(NationId nation, GovernmentType type) {
+        std::lock_guard<std::mutex> lock(govMutex);
+        governments().setGovernment(nation, type);
+        refreshModifiers(nation);
+    }
+
+private:
+    // Government bonuses are percentages; they enter the modifier stacks as multipliers.
+    void refreshModifiers(NationId nation) {
+        const GovernmentSystem& system = governments();
+        modifiers.removeSource(nation, ModifierSource::Policy);
+        modifiers.add(nation, ModifierStat::DailyIncome, 1.0 + system.economicBonus(nation) / 100.0,
+                      ModifierSource::Policy, 0);
+        modifiers.add(nation, ModifierStat::CombatEffectiveness, 1.0 + system.militaryBonus(nation) / 100.0,
+                      ModifierSource::Policy, 0);
     }
 };
 
 /*************** Stage 6: Chat Module (Console Text Chat) ****************/
 
 class ChatModule : public Module {
-    std::vector<std::string> messageQueue;
-    std::mutex chatMutex;
-    std::thread inputThread;
-    std::atomic<bool> isRunning;
+    // Input is polled once per tick from a non-blocking channel (stdin natively, the page's message
+    // port in WASM) and posted through the hub's lock-free queue; no thread waits on input.
+    ChatHub hub;
+    ChatLobbyId lobby = kNoLobby;
+    std::unique_ptr<ChatInput> input;
+    std::vector<std::string> lines;
 public:
     bool init() override {
-        isRunning.store(true);
-        // Start a detached thread to handle blocking console input without pausing the engine.
-        inputThread = std::thread(&ChatModule::inputLoop, this);
+        lobby = hub.openLobby("ROOM-0");   // config.json "lobbyDefault"
+        input = makeChatInput();
+        if (!input->open()) {
+            logEvent("ChatModule: Warning: chat input unavailable.");
+        }
         logEvent("ChatModule: Initialized. Type '/exit' in the console to stop chat input.");
         return true;
     }
 
-    void inputLoop() {
-        std::string line;
-        while (isRunning.load()) {
-            std::cout << "> ";
-            if (std::getline(std::cin, line)) {
-                if (!line.empty()) {
-                    if (line == "/exit") {
-                        logEvent("Chat input thread exiting.");
-                        break; // Exit the loop but don't stop the whole module yet
-                    }
-                    // TODO: In a networked game, send this message to a server.
-                    addMessage("Player: " + line);
-                }
-            } else {
-                 // Check if the main module is shutting down
-                if (!isRunning.load()) break;
-                // Sleep briefly to prevent busy-waiting if cin fails
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    void pollInput() {
+        lines.clear();
+        if (!input || !input->poll(lines)) return;
+        for (const std::string &line : lines) {
+            if (line.empty()) continue;
+            if (line == "/exit") {
+                logEvent("Chat input closed.");
+                input->close(); // Stop reading input but keep the chat module running
+                break;
             }
+            addMessage(line);
         }
     }
 
     void addMessage(const std::string &msg) {
-        std::lock_guard<std::mutex> lock(chatMutex);
-        messageQueue.push_back(msg);
+        if (!hub.post(lobby, "Player", msg))
+            logEvent("ChatModule: Warning: chat queue full, message dropped.");
     }
 
     void update() override {
-        std::lock_guard<std::mutex> lock(chatMutex);
-        if (!messageQueue.empty()) {
+        pollInput();
+        // One batch per tick; this is the handoff point for the network layer.
+        // TODO: In a networked game, send the batch to the server instead of printing it.
+        hub.pump([](const ChatMessage* messages, std::size_t count) {
             std::cout << "\n------ Chat Log ------" << std::endl;
-            for (const auto &msg : messageQueue) {
-                std::cout << getTimestamp() << " " << msg << std::endl;
+            for (std::size_t i = 0; i < count; ++i) {
+                std::cout << getTimestamp() << " " << messages[i].from() << ": " << messages[i].body() << std::endl;
             }
-             std::cout << "----------------------" << std::endl;
-            messageQueue.clear();
+            std::cout << "----------------------" << std::endl;
+        });
+    }
+
+    void shutdown() override {
+        // Nothing to unblock: closing the channel is immediate.
+        if (input) input->close();
+        input.reset();
+        logEvent("ChatModule: Shutdown complete.");
+    }
+};
+
+/*************** Stage 6a: Territory Module ****************/
+
+class TerritoryModule : public Module {
+    NationRegistry nations;
+    TerritoryIndex territory;
+    BorderMap borders{territory};
+    PassabilityMasks passability;
+    std::uint64_t epoch = 0;   // Bumped whenever a batch of captures changes ownership.
+    std::function<void()> captureListener; // Told after each such batch.
+    std::mutex territoryMutex; // Guards the capture queue against calls from other threads.
+public:
+    bool init() override {
+        // Outlines come from the prebuilt world pack when present (no parsing); the GeoJSON is
+        // the fallback. A missing outline file leaves the grid empty (every point unclaimed)
+        // rather than failing the engine, matching how the resource loader treats absent assets.
+        bool packed = worldPack().open("world.pack") && territory.loadPack(worldPack(), nations);
+        if (!packed && !territory.loadGeoJson("countries.geo.json", nations)) {
+            logEvent("TerritoryModule: countries.geo.json unavailable; all land is unclaimed.");
+        }
+        borders.rebuild();
+        passability.reset(nations.count());
+        logEvent("TerritoryModule: Initialized.");
+        return true;
+    }
+
+    void update() override {
+        std::lock_guard<std::mutex> lock(territoryMutex);
+        // Apply this tick's captures as one batch of cell flips.
+        std::size_t flipped = borders.applyCaptures();
+        if (flipped > 0) {
+            ++epoch;
+            logEvent("Territory: " + std::to_string(flipped) + " cells changed hands.");
+            if (captureListener) captureListener();
         }
     }
 
     void shutdown() override {
-        isRunning.store(false);
-        // A clean way to unblock getline is needed, but for console it's tricky.
-        // Prompting the user to press enter is a simple workaround.
-        std::cout << "Press ENTER to fully shut down chat module." << std::endl;
-        if (inputThread.joinable()) {
-            inputThread.join();
+        logEvent("TerritoryModule: Shutdown complete.");
+    }
+
+    NationRegistry& registry() { return nations; }
+    const TerritoryIndex& index() const { return territory; }
+    const BorderMap& borderMap() const { return borders; }
+    const PassabilityMasks& passabilityMasks() const { return passability; }
+    std::uint64_t captureEpoch() const { return epoch; }
+    void setCaptureListener(std::function<void()> listener) { captureListener = std::move(listener); }
+
+    // O(1) owner lookup for movement, combat and economy checks.
+    NationId ownerAt(double lat, double lng) const { return territory.ownerAt(lat, lng); }
+
+    // Queues a capture for the next update(). Captures of territory the nation may not take
+    // (own, allied, neutral) are ignored.
+    void captureAt(double lat, double lng, NationId nation) {
+        std::lock_guard<std::mutex> lock(territoryMutex);
+        if (!passability.canCapture(nation, territory.ownerAt(lat, lng))) return;
+        borders.queueCapture(lat, lng, nation);
+    }
+
+    // Applies a relationship change to the movement masks (two bits per nation pair).
+    // Call from the engine thread; pathfinding reads the masks without locking.
+    void setRelation(NationId a, NationId b, RelationStatus status) {
+        passability.setRelation(a, b, status);
+    }
+};
+
+/*************** Stage 6b: Diplomacy Module ****************/
+
+class DiplomacyModule : public Module {
+    TerritoryModule& territory;
+    DiplomacyCore core;
+    long long ticks = 0;
+    static constexpr int kTicksPerCycle = 150; // One diplomatic cycle every ~5 seconds.
+public:
+    explicit DiplomacyModule(TerritoryModule& territoryModule) : territory(territoryModule) {}
+
+    bool init() override {
+        // Relations are indexed by the nation ids the territory module interned at load time.
+        core.reset(territory.registry().count(), static_cast<std::uint32_t>(time(nullptr)));
+        core.setStatusListener([this](NationId a, NationId b, RelationStatus status) {
+            territory.setRelation(a, b, status);
+        });
+        core.setTicksPerDay(kTicksPerGameDay);
+        core.setTreatyExpiryListener([this](const Treaty& treaty) {
+            static const char* kTypeNames[] = {"Peace", "Alliance", "Trade"};
+            logEvent(std::string("DiplomacyModule: ") + kTypeNames[static_cast<int>(treaty.type)] + " treaty between " +
+                     territory.registry().name(treaty.a) + " and " + territory.registry().name(treaty.b) + " expired.");
+        });
+        logEvent("DiplomacyModule: Initialized " + std::to_string(core.pairCount()) + " bilateral relations.");
+        return true;
+    }
+
+    void update() override {
+        // Only treaties that are actually due are popped from the expiry heap.
+        core.advanceTo(static_cast<std::uint64_t>(++ticks));
+        // Drift and decay are vectorized passes over the packed matrix.
+        if (ticks % kTicksPerCycle == 0) {
+            core.driftCycle();
+            core.decayCycle(0.01);
+        }
+    }
+
+    void shutdown() override {
+        logEvent("DiplomacyModule: Shutdown complete.");
+    }
+
+    // O(1) status checks for combat and movement.
+    bool atWar(NationId a, NationId b) const { return core.atWar(a, b); }
+    bool allied(NationId a, NationId b) const { return core.allied(a, b); }
+
+    DiplomacyCore& relations() { return core; }
+};
+
+
+/*************** Stage 6c: Modifier Module ****************/
+
+class ModifierModule : public Module {
+    TerritoryModule& territory;
+    ModifierStacks stacks;
+public:
+    explicit ModifierModule(TerritoryModule& territoryModule) : territory(territoryModule) {}
+
+    bool init() override {
+        stacks.reset(territory.registry().count());
+        stacks.exposeToPage(territory.registry());
+        logEvent("ModifierModule: Initialized modifier stacks for " + std::to_string(stacks.nationCount()) + " nations.");
+        return true;
+    }
+
+    // Products are refolded when modifiers change, never per tick.
+    void update() override {}
+
+    void shutdown() override {
+        logEvent("ModifierModule: Shutdown complete.");
+    }
+
+    ModifierStacks& modifiers() { return stacks; }
+    float multiplier(NationId nation, ModifierStat stat) const { return stacks.multiplier(nation, stat); }
+};
+
+
+/*************** Stage 6d: World Event Module ****************/
+
+class EventModule : public Module {
+    TerritoryModule& territory;
+    DiplomacyModule& diplomacy;
+    ModifierModule& modifiers;
+public:
+    EventModule(TerritoryModule& territoryModule, DiplomacyModule& diplomacyModule, ModifierModule& modifierModule)
+        : territory(territoryModule), diplomacy(diplomacyModule), modifiers(modifierModule) {}
+
+    bool init() override {
+        WorldEventEngine& engine = worldEvents();
+        engine.reset(territory.registry().count(), static_cast<std::uint32_t>(time(nullptr)), 30 * 60);
+        // Effects arrive grouped per nation once per tick.
+        engine.setEffectHandler([this](NationId nation, const EventEffect* effects, std::size_t count) {
+            applyEffects(nation, effects, count);
+        });
+        return initEvents();
+    }
+
+    void update() override {
+        updateEvents();
+    }
+
+    void shutdown() override {
+        cleanupEvents();
+        logEvent("EventModule: Shutdown complete.");
+    }
+
+private:
+    void applyEffects(NationId nation, const EventEffect* effects, std::size_t count) {
+        const WorldEventEngine& engine = worldEvents();
+        ModifierStacks& stacks = modifiers.modifiers();
+        for (std::size_t i = 0; i < count; ++i) {
+            const EventEffect& effect = effects[i];
+            if (!effect.starting) {
+                // Everything an event contributed is keyed by its handle.
+                stacks.removeSource(nation, ModifierSource::Event, effect.event);
+                continue;
+            }
+            switch (effect.eventClass) {
+                case EventClass::Economic:
+                    stacks.add(nation, ModifierStat::DailyIncome, effect.value, ModifierSource::Event, effect.event);
+                    break;
+                case EventClass::Military:
+                    stacks.add(nation, ModifierStat::CombatEffectiveness, effect.value, ModifierSource::Event, effect.event);
+                    break;
+                case EventClass::Environmental:
+                    stacks.add(nation, ModifierStat::InfrastructureEfficiency, 1.0 - effect.value, ModifierSource::Event,
+                               effect.event);
+                    break;
+                case EventClass::Diplomatic:
+                    // Delivered to both parties; apply the deltas once per pair.
+                    if (nation > effect.other) continue;
+                    diplomacy.relations().adjust(nation, effect.other, effect.value, effect.value2);
+                    break;
+            }
+            logEvent("Events: " + engine.description(effect.event) + " (" + territory.registry().name(nation) + ").");
         }
-        logEvent("ChatModule: Shutdown complete.");
     }
 };
 
 
+/*************** Stage 6e: City Module ****************/
+
+class CityModule : public Module {
+    TerritoryModule& territory;
+    CitySystem cities;
+    CityIndex index;                    // Positions never change, so it is built once at load.
+    RoadNetwork roads;                  // Same cities; re-customized as infrastructure and roads change.
+    std::uint64_t ownersEpoch = 0;
+public:
+    explicit CityModule(TerritoryModule& territoryModule) : territory(territoryModule) {}
+
+    bool init() override {
+        const NationRegistry& registry = territory.registry();
+        // Owners come from the territory grid; cities off the grid fall back to their listed
+        // country if the registry knows it. New nations are never interned here, since the
+        // per-nation tables of the other modules are already sized.
+        auto resolveOwner = [this, &registry](const std::string& code, const std::string& country,
+                                              double lat, double lng) {
+            NationId owner = territory.ownerAt(lat, lng);
+            if (owner == kNoNation) owner = registry.find(country);
+            if (owner == kNoNation) owner = registry.find(code);
+            return owner;
+        };
+        std::uint32_t seed = static_cast<std::uint32_t>(time(nullptr));
+        bool packed = worldPack().isOpen() && cities.loadPack(worldPack(), resolveOwner, seed);
+        if (!packed && !cities.loadJson("data/cities.json", resolveOwner, seed)) {
+            logEvent("CityModule: data/cities.json unavailable; no cities simulated.");
+        }
+        cities.setYearsPerStep(1.0 / kTicksPerGameYear);
+        cities.aggregateIncome(registry.count());
+        index.build(cities);
+        roads.build(cities, index);
+        logEvent("CityModule: Initialized " + std::to_string(cities.count()) + " cities and " +
+                 std::to_string(roads.roadCount()) + " roads (" + std::to_string(roads.arcCount() - roads.roadCount()) +
+                 " route shortcuts).");
+        return true;
+    }
+
+    void update() override {
+        // Captured cities change owner (and income destination) on the tick their cell flips.
+        if (territory.captureEpoch() != ownersEpoch) {
+            ownersEpoch = territory.captureEpoch();
+            for (std::size_t i = 0; i < cities.count(); ++i) {
+                NationId owner = territory.ownerAt(cities.lat(i), cities.lng(i));
+                if (owner != kNoNation) cities.setOwner(i, owner);
+            }
+        }
+        // One pass over the SoA columns, then a per-nation income sum.
+        cities.step(territory.registry().count());
+    }
+
+    void shutdown() override {
+        logEvent("CityModule: Shutdown complete.");
+    }
+
+    // Invests in a city's infrastructure; a new level speeds up every road into the city.
+    bool improveInfrastructure(std::uint32_t city, double investment) {
+        if (!cities.improveInfrastructure(city, investment)) return false;
+        roads.setInfrastructure(city, cities.infrastructure(city));
+        return true;
+    }
+
+    // Destroys (or rebuilds) the road between two cities. False if they have no road.
+    bool setRoadOpen(std::uint32_t a, std::uint32_t b, bool open) {
+        std::uint32_t road = roads.findRoad(a, b);
+        if (road == RoadNetwork::kNoRoad) return false;
+        roads.setRoadOpen(road, open);
+        return true;
+    }
+
+    const CitySystem& system() const { return cities; }
+    const CityIndex& spatialIndex() const { return index; }
+    RoadNetwork& roadNetwork() { return roads; }
+};
+
+
+/*************** Stage 6f: AI Module ****************/
+
+class AIModule : public Module {
+    static constexpr int kTicksPerSurvey = 30;              // Look for idle nations once a second.
+    static constexpr std::uint32_t kPlanBudgetMicros = 2000; // Planning share of the 33 ms tick.
+    static constexpr double kValueRestamp = 0.05;           // Relative production change that restamps a city.
+    static constexpr std::size_t kTargetCandidates = 8;     // Cities near an attack cell checked for an enemy.
+    static constexpr int kTicksPerClusterSync = 6;          // Map clusters refresh five times a second.
+    static constexpr int kClusterMinZoom = 0, kClusterMaxZoom = 14;
+    // Outcome of one nation's plan: its cities, neediest (threat minus own strength) first, and the
+    // cell to attack if it is at war.
+    struct NationPlan {
+        std::vector<std::uint32_t> cities;
+        std::uint32_t attackCell = kNoCell;
+    };
+    static constexpr std::uint32_t kNoCell = 0xFFFFFFFFu;
+
+    TerritoryModule& territory;
+    const CitySystem& cities;
+    const CityIndex& cityIndex;
+    const DiplomacyCore& diplomacy;
+    EconomyModule& economy;
+    const ModifierStacks& modifiers;
+    UnitAiSystem ai;
+    TerritoryRouter router;                                 // Formation routes around closed borders.
+    std::vector<std::pair<float, float>> route;             // Scratch for router.route().
+    AiScheduler scheduler;
+    InfluenceMaps influence;
+    RecruitmentPlanner recruitment;
+    MarkerClusters clusters;
+    std::uint16_t garrisonCategory = 0;                     // Cluster category of the starting garrisons.
+    std::vector<PurchaseOrder> orders;
+    std::vector<std::vector<std::uint32_t>> citiesByNation;
+    std::vector<std::vector<std::uint32_t>> unitsByNation;
+    std::uint64_t ownersEpoch = 0;                          // Capture epoch citiesByNation reflects.
+    std::vector<std::uint32_t> unitCells, cityCells;
+    std::vector<NationId> stampedOwners;                    // Value stamped per city, and for whom.
+    std::vector<float> stampedValues;
+    double valueScale = 1.0;                                // Makes the mean city worth 1.
+    std::vector<char> planning;                             // Nation has a plan queued or in flight.
+    std::mt19937 rng;
+    long long ticks = 0;
+
+    // Runs on the worker against an influence snapshot: threat is everyone else's strength weighted
+    // by hostility; opportunity is the economic value of nations we are at war with.
+    static NationPlan rankTargets(const InfluenceView& view, NationId nation, const std::vector<std::uint32_t>& own,
+                                  const std::vector<std::uint32_t>& ownCells, const std::vector<float>& threatWeights,
+                                  const std::vector<float>& warWeights, bool atWar) {
+        std::vector<float> threat;
+        view.weightedSum(InfluenceLayer::Strength, threatWeights, threat);
+        const float* strength = view.grid(InfluenceLayer::Strength, nation);
+        std::vector<std::pair<float, std::uint32_t>> need(own.size());
+        for (std::size_t i = 0; i < own.size(); ++i)
+            need[i] = {threat[ownCells[i]] - (strength ? strength[ownCells[i]] : 0.0f), own[i]};
+        std::sort(need.begin(), need.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+        NationPlan plan;
+        for (const auto& entry : need) plan.cities.push_back(entry.second);
+        if (atWar) {
+            std::vector<float> opportunity;
+            view.weightedSum(InfluenceLayer::Value, warWeights, opportunity);
+            for (std::size_t i = 0; i < opportunity.size(); ++i) opportunity[i] -= threat[i];
+            std::size_t best = InfluenceView::argmax(opportunity);
+            if (best != SIZE_MAX) plan.attackCell = static_cast<std::uint32_t>(best);
+        }
+        return plan;
+    }
+
+    // AIManager.plan_group_strategy for one nation: weigh the other nations, rank targets off the
+    // tick thread, then send every other idle unit at the war target (if any) and the rest to the
+    // neediest quarter of the nation's cities, one formation per destination.
+    void planNation(NationId nation) {
+        std::vector<float> threatWeights(influence.nationCount(), 0.0f), warWeights(influence.nationCount(), 0.0f);
+        bool atWar = false;
+        for (NationId other = 0; other < threatWeights.size(); ++other) {
+            if (other == nation || diplomacy.allied(nation, other)) continue;
+            bool war = diplomacy.atWar(nation, other);
+            threatWeights[other] = war ? 1.0f : static_cast<float>(diplomacy.hostility(nation, other) / 100.0);
+            warWeights[other] = war ? 1.0f : 0.0f;
+            atWar = atWar || war;
+        }
+        std::vector<std::uint32_t> ownCells;
+        for (std::uint32_t city : citiesByNation[nation]) ownCells.push_back(cityCells[city]);
+        scheduler.offload<NationPlan>(
+            [view = influence.view(), nation, own = citiesByNation[nation], ownCells = std::move(ownCells),
+             threatWeights = std::move(threatWeights), warWeights = std::move(warWeights), atWar]() {
+                return rankTargets(view, nation, own, ownCells, threatWeights, warWeights, atWar);
+            },
+            [this, nation](NationPlan& plan) {
+                planning[nation] = 0;
+                // Cities lost while the plan was ranked are no longer ours to defend.
+                plan.cities.erase(std::remove_if(plan.cities.begin(), plan.cities.end(),
+                                                 [this, nation](std::uint32_t city) { return cities.owner(city) != nation; }),
+                                  plan.cities.end());
+                if (plan.cities.empty()) return;
+                std::size_t front = std::max<std::size_t>(1, plan.cities.size() / 4);
+                bool attack = plan.attackCell != kNoCell;
+                float attackLat = 0.0f, attackLng = 0.0f;
+                if (attack) aimAt(nation, plan.attackCell, attackLat, attackLng);
+                std::vector<std::uint32_t> attackers;
+                std::vector<std::vector<std::uint32_t>> defenders(front);
+                for (std::uint32_t unit : unitsByNation[nation]) {
+                    if (ai.hasTarget(unit)) continue;
+                    if (attack) attackers.push_back(unit);
+                    else defenders[rng() % front].push_back(unit);
+                    attack = !attack && plan.attackCell != kNoCell;
+                }
+                sendFormation(nation, attackers, attackLat, attackLng);
+                for (std::size_t i = 0; i < front; ++i) {
+                    std::uint32_t city = plan.cities[i];
+                    sendFormation(nation, defenders[i], static_cast<float>(cities.lat(city)), static_cast<float>(cities.lng(city)));
+                }
+            });
+    }
+
+    // Marches units as one formation along a route that keeps off ground the nation may not enter
+    // (neutral nations), mustering at the member nearest their centroid. Units without a route
+    // stay idle and are planned again at the next survey.
+    void sendFormation(NationId nation, const std::vector<std::uint32_t>& members, float lat, float lng) {
+        if (members.empty()) return;
+        float meanX = 0.0f, meanY = 0.0f;
+        for (std::uint32_t unit : members) {
+            meanX += ai.x(unit);
+            meanY += ai.y(unit);
+        }
+        meanX /= members.size();
+        meanY /= members.size();
+        std::uint32_t muster = members.front();
+        float best = FLT_MAX;
+        for (std::uint32_t unit : members) {
+            float dx = ai.x(unit) - meanX, dy = ai.y(unit) - meanY;
+            if (dx * dx + dy * dy < best) {
+                best = dx * dx + dy * dy;
+                muster = unit;
+            }
+        }
+        if (!router.route(ai.y(muster), ai.x(muster), lat, lng, territory.passabilityMasks().enterMask(nation), route))
+            return;
+        ai.march(members.data(), members.size(), route);
+    }
+
+    // The enemy city closest to an attack cell (the cell centre if none of the nearest is hostile).
+    void aimAt(NationId nation, std::uint32_t cell, float& lat, float& lng) const {
+        lat = static_cast<float>(influence.cellLat(cell));
+        lng = static_cast<float>(influence.cellLng(cell));
+        std::uint32_t near[kTargetCandidates];
+        std::size_t found = cityIndex.nearest(lat, lng, kTargetCandidates, near);
+        for (std::size_t i = 0; i < found; ++i) {
+            NationId owner = cities.owner(near[i]);
+            if (owner == kNoNation || owner == nation || !diplomacy.atWar(nation, owner)) continue;
+            lat = static_cast<float>(cities.lat(near[i]));
+            lng = static_cast<float>(cities.lng(near[i]));
+            return;
+        }
+    }
+
+    // A new unit at a city: on the board, in the nation's list, in the Strength layer and on the map.
+    void spawn(NationId nation, std::uint32_t city, std::uint16_t category) {
+        float lat = static_cast<float>(cities.lat(city)), lng = static_cast<float>(cities.lng(city));
+        unitsByNation[nation].push_back(ai.registerUnit(nation, lng, lat));
+        unitCells.push_back(cityCells[city]);
+        influence.add(InfluenceLayer::Strength, nation, cityCells[city], 1.0f);
+        clusters.add(nation, category, lat, lng);
+    }
+
+    // Regroups the cities by their current owner, growing the per-nation lists for nations that
+    // held no city before.
+    void listCities() {
+        for (auto& list : citiesByNation) list.clear();
+        for (std::size_t i = 0; i < cities.count(); ++i) {
+            NationId owner = cities.owner(i);
+            if (owner == kNoNation) continue;
+            if (owner >= citiesByNation.size()) {
+                citiesByNation.resize(owner + 1);
+                unitsByNation.resize(owner + 1);
+                planning.resize(owner + 1, 0);
+            }
+            citiesByNation[owner].push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+
+    // Keeps the Value layers in step with city production and ownership.
+    void stampCities() {
+        for (std::size_t i = 0; i < cities.count(); ++i) {
+            NationId owner = cities.owner(i);
+            float value = owner == kNoNation ? 0.0f : static_cast<float>(cities.production(i) * valueScale);
+            if (owner == stampedOwners[i] && std::fabs(value - stampedValues[i]) <= kValueRestamp * stampedValues[i]) continue;
+            influence.add(InfluenceLayer::Value, stampedOwners[i], cityCells[i], -stampedValues[i]);
+            influence.add(InfluenceLayer::Value, owner, cityCells[i], value);
+            stampedOwners[i] = owner;
+            stampedValues[i] = value;
+        }
+    }
+
+    // Daily purchases: one scoring pass over the variant catalog for every nation, then the batched
+    // orders are charged and spawned as garrison units at the nation's first city.
+    void recruit() {
+        if (recruitment.variantCount() == 0) return;
+        const std::size_t n = std::min(economy.nationCount(), unitsByNation.size());
+        std::vector<float> strength(n), threat(n, 0.0f), aggression(n, 0.0f);
+        std::vector<double> treasury(economy.treasuryColumn(), economy.treasuryColumn() + n);
+        for (std::size_t i = 0; i < n; ++i) strength[i] = static_cast<float>(unitsByNation[i].size());
+        // Threat: hostility-weighted average strength of the other nations relative to our own.
+        for (NationId a = 0; a < n; ++a) {
+            if (citiesByNation[a].empty()) {
+                treasury[a] = 0.0;          // Nowhere to muster units.
+                continue;
+            }
+            double hostile = 0.0, weight = 0.0;
+            for (NationId b = 0; b < n; ++b) {
+                if (b == a || diplomacy.allied(a, b)) continue;
+                bool war = diplomacy.atWar(a, b);
+                double w = war ? 1.0 : diplomacy.hostility(a, b) / 100.0;
+                hostile += w * strength[b];
+                weight += w;
+                if (war) aggression[a] = 1.0f;
+            }
+            threat[a] = weight > 0.0 ? static_cast<float>(hostile / weight / std::max(1.0f, strength[a])) : 0.0f;
+        }
+        RecruitmentInputs in;
+        in.nations = n;
+        in.treasury = treasury.data();
+        in.resources = economy.resourceColumn();
+        in.threat = threat.data();
+        in.aggression = aggression.data();
+        in.costMultiplier = modifiers.column(ModifierStat::UnitCost);
+        in.combatMultiplier = modifiers.column(ModifierStat::CombatEffectiveness);
+        in.surveillance = modifiers.column(ModifierStat::UnitSurveillance);
+        orders.clear();
+        recruitment.plan(in, orders);
+
+        std::size_t spawned = 0;
+        for (const PurchaseOrder& order : orders) {
+            if (!economy.spend(order.nation, order.cost, order.resourceCost)) continue;
+            std::uint32_t city = citiesByNation[order.nation].front();
+            std::uint16_t category = static_cast<std::uint16_t>(recruitment.categoryOf(order.variant));
+            for (std::uint32_t i = 0; i < order.count; ++i) spawn(order.nation, city, category);
+            spawned += order.count;
+        }
+        if (spawned > 0)
+            logEvent("AIModule: " + std::to_string(orders.size()) + " purchase orders recruited " +
+                     std::to_string(spawned) + " units.");
+    }
+
+    // Queues a plan for every nation with idle units; nations with more idle units go first.
+    void survey() {
+        stampCities();
+        influence.update();
+        for (NationId nation = 0; nation < unitsByNation.size(); ++nation) {
+            if (planning[nation] || unitsByNation[nation].empty()) continue;
+            std::size_t idle = 0;
+            for (std::uint32_t unit : unitsByNation[nation]) idle += !ai.hasTarget(unit);
+            if (idle == 0) continue;
+            planning[nation] = 1;
+            scheduler.request(nation, static_cast<double>(idle), [this, nation]() { planNation(nation); });
+        }
+    }
+
+public:
+    AIModule(TerritoryModule& territoryModule, const CitySystem& citySystem, const CityIndex& cityLookup,
+             const DiplomacyCore& relations, EconomyModule& economyModule, const ModifierStacks& modifierStacks)
+        : territory(territoryModule), cities(citySystem), cityIndex(cityLookup), diplomacy(relations),
+          economy(economyModule), modifiers(modifierStacks), rng(static_cast<std::uint32_t>(time(nullptr))) {}
+
+    bool init() override {
+        // One AI garrison per owned city; all of them share the unit behavior tree and move as
+        // steered formations routed around closed borders. Steering runs in geographic mode: each
+        // unit steers in its local frame (longitude scaled by cos(latitude), wrapped at the date
+        // line), so distances are degrees of latitude at any latitude and heading. The formations
+        // march at MovementSystem's speed for a Garrison (no listed category, 40 km/h) over one
+        // tick of game time, hold a 2 km spacing, and slow down and arrive within half an hour's
+        // march.
+        MovementSystem speeds;
+        const double kmPerDegree = kEarthRadiusKm * 3.14159265358979323846 / 180.0;
+        const double kmh = speeds.categorySpeed(speeds.category("Garrison"));
+        const float degreesPerTick = static_cast<float>(kmh * kHoursPerTick / kmPerDegree);
+        const float halfHourMarch = static_cast<float>(0.5 * kmh / kmPerDegree);
+        SteeringParams steering;
+        steering.geographic = true;
+        steering.neighborRadius = static_cast<float>(50.0 / kmPerDegree);
+        steering.separationRadius = static_cast<float>(2.0 / kmPerDegree);
+        steering.maxSpeed = degreesPerTick;
+        steering.maxForce = 0.4f * degreesPerTick;
+        steering.slowRadius = halfHourMarch;
+        steering.waypointRadius = halfHourMarch;
+        steering.arriveRadius = halfHourMarch;
+        ai.enableSteering(steering);
+        scheduler.setBudgetMicros(kPlanBudgetMicros);
+        // The variant catalog ships in the world pack; without one the AI keeps its garrisons only.
+        if (!worldPack().isOpen() || !recruitment.loadPack(worldPack()))
+            logEvent("AIModule: No unit variant catalog (world.pack); AI nations will not recruit.");
+        // Catalog prices assume units.cpp's 10 million treasuries; convert them to city production.
+        recruitment.scalePrices(EconomyModule::kStartingTreasury / RecruitmentPlanner::kCatalogTreasury);
+        // Map clusters group units by the catalog's categories, plus one for the garrisons.
+        std::vector<std::string> categoryNames;
+        for (std::size_t i = 0; i < recruitment.categoryCount(); ++i) categoryNames.push_back(recruitment.categoryName(i));
+        garrisonCategory = static_cast<std::uint16_t>(categoryNames.size());
+        categoryNames.push_back("Garrison");
+        clusters.reset(kClusterMinZoom, kClusterMaxZoom, categoryNames.size());
+        clusters.exposeToPage(categoryNames);
+        router.refresh(territory.index());
+        influence.reset(diplomacy.nationCount());
+        double totalProduction = 0.0;
+        for (std::size_t i = 0; i < cities.count(); ++i) {
+            cityCells.push_back(influence.cellOf(cities.lat(i), cities.lng(i)));
+            totalProduction += cities.production(i);
+        }
+        ownersEpoch = territory.captureEpoch();
+        listCities();
+        for (std::size_t i = 0; i < cities.count(); ++i) {
+            if (cities.owner(i) != kNoNation) spawn(cities.owner(i), static_cast<std::uint32_t>(i), garrisonCategory);
+        }
+        if (totalProduction > 0.0) valueScale = static_cast<double>(cities.count()) / totalProduction;
+        stampedOwners.assign(cities.count(), kNoNation);
+        stampedValues.assign(cities.count(), 0.0f);
+        stampCities();
+        influence.rebuild();
+        logEvent("AIModule: " + std::to_string(ai.count()) + " AI units registered on a " +
+                 std::to_string(influence.width()) + "x" + std::to_string(influence.height()) + " influence grid, " +
+                 std::to_string(clusters.clusterCount(kClusterMinZoom)) + " map clusters at zoom " +
+                 std::to_string(kClusterMinZoom) + ".");
+        return true;
+    }
+
+    void update() override {
+        // CityModule has already moved captured cities to their new owners this tick, and this
+        // tick's capture batch is still in the border map.
+        if (territory.captureEpoch() != ownersEpoch) {
+            ownersEpoch = territory.captureEpoch();
+            listCities();
+            const std::vector<std::uint32_t>& changed = territory.borderMap().changedCells();
+            router.refreshCells(territory.index(), changed.data(), changed.size());
+        }
+        if (ticks % kTicksPerSurvey == 0) survey();
+        if (ticks % kTicksPerGameDay == 0) recruit();
+        ++ticks;
+        scheduler.runSlice();
+        ai.update();
+        // Units that crossed into another cell move their strength with them, and like units that
+        // reached their target they occupy the ground under them. Captures the nation may not make
+        // (own, allied or neutral ground) are dropped by the territory module; the rest flip at
+        // its next update.
+        for (std::uint32_t unit = 0; unit < ai.count(); ++unit) {
+            std::uint32_t cell = influence.cellOf(ai.y(unit), ai.x(unit));
+            if (cell == unitCells[unit]) continue;
+            influence.move(InfluenceLayer::Strength, ai.nation(unit), unitCells[unit], cell, 1.0f);
+            unitCells[unit] = cell;
+            territory.captureAt(ai.y(unit), ai.x(unit), ai.nation(unit));
+        }
+        for (std::uint32_t unit : ai.arrivals()) territory.captureAt(ai.y(unit), ai.x(unit), ai.nation(unit));
+        // Map clusters follow the board a few times a second and answer the page's latest view.
+        if (ticks % kTicksPerClusterSync == 0) {
+            clusters.sync(ai.ys(), ai.xs(), ai.count());
+            clusters.publishViewport();
+        }
+    }
+
+    void shutdown() override {
+        // Pending applies reference this module; let the worker finish before it is destroyed.
+        scheduler.waitIdle();
+        logEvent("AIModule: Shutdown complete (" + std::to_string(scheduler.plansRun()) + " plans, " +
+                 std::to_string(scheduler.overruns()) + " slices over budget).");
+    }
+
+    UnitAiSystem& units() { return ai; }
+    AiScheduler& planner() { return scheduler; }
+    const InfluenceMaps& influenceMaps() const { return influence; }
+    MarkerClusters& markerClusters() { return clusters; }
+};
+
 /*************** Stage 7: GameEngine Orchestrator ****************/
 
 class GameEngineController {
@@ -458,9 +1286,26 @@ public:
     bool init() {
         // Use smart pointers for automatic memory management.
         modules.push_back(std::make_unique<UnitModule>());
-        modules.push_back(std::make_unique<CombatModule>());
-        modules.push_back(std::make_unique<EconomyModule>());
-        modules.push_back(std::make_unique<GovernmentModule>());
+        auto territory = std::make_unique<TerritoryModule>();
+        TerritoryModule& territoryRef = *territory;
+        modules.push_back(std::move(territory));
+        auto cities = std::make_unique<CityModule>(territoryRef);
+        CityModule& citiesRef = *cities;
+        modules.push_back(std::move(cities));
+        auto diplomacy = std::make_unique<DiplomacyModule>(territoryRef);
+        DiplomacyModule& diplomacyRef = *diplomacy;
+        modules.push_back(std::move(diplomacy));
+        auto modifiers = std::make_unique<ModifierModule>(territoryRef);
+        ModifierModule& modifiersRef = *modifiers;
+        modules.push_back(std::move(modifiers));
+        modules.push_back(std::make_unique<EventModule>(territoryRef, diplomacyRef, modifiersRef));
+        modules.push_back(std::make_unique<CombatModule>(modifiersRef.modifiers()));
+        auto economy = std::make_unique<EconomyModule>(modifiersRef.modifiers(), citiesRef.system());
+        EconomyModule& economyRef = *economy;
+        modules.push_back(std::move(economy));
+        modules.push_back(std::make_unique<GovernmentModule>(territoryRef.registry(), modifiersRef.modifiers()));
+        modules.push_back(std::make_unique<AIModule>(territoryRef, citiesRef.system(), citiesRef.spatialIndex(),
+                                                     diplomacyRef.relations(), economyRef, modifiersRef.modifiers()));
         modules.push_back(std::make_unique<ChatModule>());
 
         for (const auto& mod : modules) {
@@ -469,6 +1314,16 @@ public:
                 return false;
             }
         }
+        // Pathfinding consults the territory module's per-nation passability masks, units capture
+        // the ground they march onto, and the grid follows the owners as captures change them.
+        if (auto um = getModule<UnitModule>()) {
+            if (auto tm = getModule<TerritoryModule>()) {
+                um->attachPassability(&tm->passabilityMasks());
+                um->attachTerritory(tm->index());
+                um->setCaptureHandler([tm](double lat, double lng, NationId nation) { tm->captureAt(lat, lng, nation); });
+                tm->setCaptureListener([um, tm]() { um->syncCellOwners(tm->index()); });
+            }
+        }
         isEngineRunning.store(true);
         logEvent("GameEngineController: All modules initialized successfully.");
         return true;
@@ -551,6 +1406,110 @@ public:
 
 } // namespace GameEngine
 
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DGAME_ENGINE_TEST)
+// A* on the unit grid must treat a neutral nation's cells as walls and detour around them, use
+// the shortest path once the nations are at war, and follow captures into the grid. On the world
+// map (world.pack or countries.geo.json in the working directory), a French tank marching into
+// Germany at war must capture the German cells it steps onto and see the grid follow. A doctrine
+// adopted through the modifier stacks must reach the combat resolver's multiplier.
+//   g++ -std=c++17 -O2 -pthread -DGAME_ENGINE_TEST game_engine.cpp <ENGINE_SOURCES from build.sh> -o engine-test
+#ifdef GAME_ENGINE_TEST
+int main() {
+    using namespace GameEngine;
+    NationRegistry registry;
+    NationId home = registry.intern("HOM", "Home");
+    NationId neutral = registry.intern("NEU", "Neutral");
+    // One degree per cell over [0, 20] x [0, 20]: Home holds both flanks, Neutral the middle
+    // columns 8..11 from the south edge up to row 16; rows 17..19 there are unclaimed.
+    TerritoryIndex territory;
+    territory.addPolygon(home, {{0, 0, 8, 0, 8, 20, 0, 20, 0, 0}});
+    territory.addPolygon(home, {{12, 0, 20, 0, 20, 20, 12, 20, 12, 0}});
+    territory.addPolygon(neutral, {{8, 0, 12, 0, 12, 17, 8, 17, 8, 0}});
+    territory.build();
+    PassabilityMasks masks;
+    masks.reset(registry.count());
+
+    UnitModule units;
+    units.init();
+    units.setGridFrame(0.0, 0.0, 1.0);
+    units.attachPassability(&masks);
+    units.attachTerritory(territory);
+    int failures = 0;
+    failures += units.unitAt(0).nation != home || units.cellOwner(9, 5) != neutral || units.cellOwner(9, 18) != kNoNation;
+
+    // Infantry at (1, 1) to (18, 1): 17 steps straight through Neutral, 49 over the top.
+    auto crossesNeutral = [&](const std::vector<std::pair<int, int>>& path) {
+        for (const auto& step : path) {
+            if (units.cellOwner(step.first, step.second) == neutral) return true;
+        }
+        return false;
+    };
+    units.setDestination(0, 18, 1);
+    std::size_t detour = units.unitAt(0).path.size();
+    failures += detour != 49 || crossesNeutral(units.unitAt(0).path);
+
+    masks.setRelation(home, neutral, RelationStatus::AtWar);
+    units.setDestination(0, 18, 1);
+    std::size_t direct = units.unitAt(0).path.size();
+    failures += direct != 17;
+
+    // Peace again, but Home has taken the bottom row of the middle strip.
+    masks.setRelation(home, neutral, RelationStatus::Neutral);
+    for (int x = 8; x < 12; ++x) territory.setCellOwner(territory.cellIndex(0.5, x + 0.5), home);
+    units.syncCellOwners(territory);
+    units.setDestination(0, 18, 1);
+    std::size_t captured = units.unitAt(0).path.size();
+    failures += captured != 19 || crossesNeutral(units.unitAt(0).path);
+
+    // End to end, wired as GameEngineController::init does: units occupy cells, the territory
+    // module flips enemy ones in its next update and the grid follows through the listener.
+    TerritoryModule world;
+    world.init();
+    UnitModule army;
+    army.init();
+    army.attachPassability(&world.passabilityMasks());
+    army.attachTerritory(world.index());
+    army.setCaptureHandler([&world](double lat, double lng, NationId nation) { world.captureAt(lat, lng, nation); });
+    world.setCaptureListener([&world, &army]() { army.syncCellOwners(world.index()); });
+    NationId france = world.registry().find("FRA"), germany = world.registry().find("DEU");
+    failures += army.unitAt(1).nation != france || army.cellOwner(16, 9) != germany;
+    army.setDestination(1, 16, 9);  // Germany is closed to France at peace.
+    failures += army.unitAt(1).isMoving;
+    world.setRelation(france, germany, RelationStatus::AtWar);
+    army.setDestination(1, 16, 9);  // Tank from (2, 2) over the Rhine.
+    std::vector<std::pair<int, int>> route = army.unitAt(1).path;
+    std::uint64_t german = 0;
+    for (const auto& step : route) german += army.cellOwner(step.first, step.second) == germany;
+    int marched = 0;
+    for (; marched < 64 && army.unitAt(1).isMoving; ++marched) {
+        army.update();
+        world.update();
+    }
+    // French cells on the way are not captures; each German one flips in its own batch.
+    std::uint64_t batches = world.captureEpoch();
+    failures += army.unitAt(1).isMoving || german == 0 || batches != german || world.ownerAt(48.75, 8.25) != france;
+    for (const auto& step : route) failures += army.cellOwner(step.first, step.second) != france;
+
+    // Military Innovation: combatEffectiveness 1.15 for Home only.
+    ModifierStacks stacks;
+    stacks.reset(registry.count());
+    CombatModule combat(stacks);
+    combat.init();
+    UnitVariant tank = {"Tank", "M1 Abrams", 1000000, 500000, false, "icons/tank_m1.png"};
+    CombatUnit homeTank("Tank", tank, 1.0f, 1.0f, home);
+    CombatUnit neutralTank("Tank", tank, 9.0f, 1.0f, neutral);
+    failures += combat.resolver().multiplierFor(homeTank) != 1.0;
+    failures += !stacks.applyDoctrine(home, "Military Innovation");
+    double doctrine = combat.resolver().multiplierFor(homeTank);
+    failures += std::fabs(doctrine - 1.15) > 1e-6 || combat.resolver().multiplierFor(neutralTank) != 1.0;
+
+    std::cout << "Neutral: detour " << detour << " steps; at war: " << direct << " steps; after capture: "
+              << captured << " steps; march into Germany: " << marched << " steps, " << batches
+              << " capture batches; doctrine combat multiplier: " << doctrine << "; failures: " << failures << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+#else
 /*************** Stage 8: Main Application Entry Point ****************/
 
 int main() {
@@ -569,7 +1528,7 @@ int main() {
 
     // Example of interacting with a module post-initialization
     if (auto unitModule = engine->getModule<GameEngine::UnitModule>()) {
-        unitModule->setDestination(0, 18, 18); // Send Infantry to a corner
+        unitModule->setDestination(0, 14, 9);  // Send Infantry east, around neutral Switzerland
         unitModule->setDestination(1, 8, 9);  // Send Tank towards the wall
     }
 
@@ -582,3 +1541,4 @@ int main() {
     GameEngine::logEvent("NationBuilder Game Engine terminated.");
     return 0;
 }
+#endif
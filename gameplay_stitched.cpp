@@ -2,7 +2,7 @@
  * gameplay_stitched.cpp
  *
  * This file is the single entry point loaded from index.html. It is responsible for:
- *   • Loading every required external file (assets, configuration files, etc.)
+ *   • Loading external files (assets, configuration files, etc.) on demand, by asset id
  *   • Initializing and orchestrating all engine modules (units, combat, economy, government,
  *     text chat, diagnostics, etc.)
  *   • Running the overall game logic and updating all subsystems.
@@ -27,6 +27,13 @@
 #include <limits>
 #include <algorithm>
 #include <functional>
+#include <cfloat> // For FLT_MAX
+
+#include "resource_loader.h"
+#include "resource_cache.h"
+#include "asset_store.h"
+#include "chat.h"
+#include "json_reader.h"
 using namespace std;
 
 /************************************
@@ -45,37 +52,13 @@ void logEvent(const string &msg) {
     // NETWORK PLACEHOLDER: Replace with robust logging to file or network service if needed.
 }
 
-/************************************
- * Resource Loader
- ************************************/
-class ResourceLoader {
-public:
-    bool loadResource(const string &filename, string &data) {
-        ifstream file(filename.c_str());
-        if (!file.is_open()) return false;
-        stringstream buffer;
-        buffer << file.rdbuf();
-        data = buffer.str();
-        return true;
-    }
-    void loadAllResources(const vector<string>& filenames) {
-        for (const auto &fname : filenames) {
-            string content;
-            if (loadResource(fname, content)) {
-                logEvent("Loaded resource: " + fname + " (" + to_string(content.size()) + " bytes)");
-                // Here you could process the resource (e.g., parse config, load assets, etc.)
-            } else {
-                logEvent("Warning: Failed to load resource: " + fname);
-            }
-        }
-    }
-};
-
 /************************************
  * Module Base Class
  ************************************/
 class Module {
 public:
+    // Assets this module reads in init(); the engine starts it once all have arrived.
+    virtual vector<AssetRequest> dependencies() const { return {}; }
     virtual bool init() = 0;
     virtual void update() = 0;
     virtual void shutdown() = 0;
@@ -165,6 +148,9 @@ private:
     }
     
 public:
+    vector<AssetRequest> dependencies() const override {
+        return {{"units", ResourcePriority::High}, {"levels", ResourcePriority::High}};
+    }
     bool init() override {
         gridWidth = 20; gridHeight = 20;
         grid.resize(gridHeight, vector<int>(gridWidth, 0));
@@ -224,6 +210,9 @@ public:
 class CombatModule : public Module {
     mutex mtx;
 public:
+    vector<AssetRequest> dependencies() const override {
+        return {{"ai_rules", ResourcePriority::Normal}};
+    }
     bool init() override { return true; }
     void update() override {
         lock_guard<mutex> lock(mtx);
@@ -242,6 +231,9 @@ class EconomyModule : public Module {
     int economyValue;
     mutex mtx;
 public:
+    vector<AssetRequest> dependencies() const override {
+        return {{"payments", ResourcePriority::Normal}};
+    }
     bool init() override {
         economyValue = 1000;
         return true;
@@ -290,50 +282,52 @@ public:
  * Chat Module (Text Chat via Console)
  ************************************/
 class ChatModule : public Module {
-    vector<string> messages;
-    mutex mtx;
-    thread inputThread;
-    atomic<bool> running;
+    // Input is polled from a non-blocking channel each tick (stdin natively, the page's message
+    // port in WASM) and posted through the hub's lock-free queue; update() drains it.
+    ChatHub hub;
+    ChatLobbyId lobby = kNoLobby;
+    unique_ptr<ChatInput> input;
+    vector<string> lines;
 public:
+    vector<AssetRequest> dependencies() const override {
+        return {{"lobby", ResourcePriority::Normal}, {"chat_log", ResourcePriority::Low}};
+    }
     bool init() override {
-        running.store(true);
-        inputThread = thread([this]() { this->inputLoop(); });
+        lobby = hub.openLobby("ROOM-0");   // config.json "lobbyDefault"
+        input = makeChatInput();
+        if (input->open())
+            cout << "Chat Module Active. Type messages (type '/exit' to quit):" << endl;
         return true;
     }
-    void inputLoop() {
-        cout << "Chat Module Active. Type messages (type '/exit' to quit):" << endl;
-        string line;
-        while (running.load()) {
-            if (getline(cin, line)) {
-                if (line == "/exit") {
-                    running.store(false);
-                    break;
-                }
-                // NETWORK PLACEHOLDER: Send message to network server if required.
-                addMessage(line);
-            } else {
-                this_thread::sleep_for(chrono::milliseconds(50));
+    void pollInput() {
+        lines.clear();
+        if (!input || !input->poll(lines)) return;
+        for (const auto &line : lines) {
+            if (line == "/exit") {
+                input->close();
+                break;
             }
+            addMessage(line);
         }
     }
     void addMessage(const string &msg) {
-        lock_guard<mutex> lock(mtx);
-        messages.push_back(msg);
+        if (!hub.post(lobby, "Player", msg))
+            logEvent("ChatModule: Warning: chat queue full, message dropped.");
     }
     void update() override {
-        lock_guard<mutex> lock(mtx);
-        if (!messages.empty()) {
+        pollInput();
+        // NETWORK PLACEHOLDER: Hand the batch to the network layer instead of printing it.
+        hub.pump([](const ChatMessage *messages, size_t count) {
             cout << "------ Chat Messages ------" << endl;
-            for (const auto &msg : messages)
-                cout << msg << endl;
+            for (size_t i = 0; i < count; i++)
+                cout << messages[i].from() << ": " << messages[i].body() << endl;
             cout << "---------------------------" << endl;
-            messages.clear();
-        }
+        });
     }
     void shutdown() override {
-        running.store(false);
-        if (inputThread.joinable())
-            inputThread.join();
+        if (input)
+            input->close();
+        input.reset();
     }
 };
 
@@ -343,6 +337,9 @@ public:
 class MiscModule : public Module {
     int diagCounter;
 public:
+    vector<AssetRequest> dependencies() const override {
+        return {{"profile", ResourcePriority::Low}};
+    }
     bool init() override { diagCounter = 0; return true; }
     void update() override {
         diagCounter++;
@@ -362,10 +359,29 @@ public:
 private:
     atomic<bool> engineRunning;
     thread mainLoopThread;
+    AssetStore *assets = nullptr;   // Delivers assets to waiting modules each frame.
+    vector<size_t> waiting;         // Outstanding assets per module.
+    vector<bool> started;
+    vector<vector<function<void(Module*)>>> onStart;
+    
+    void start(size_t index) {
+        if (!modules[index]->init()) {
+            logEvent("GameEngine: Failed to initialize a module; it stays stopped.");
+            return;
+        }
+        started[index] = true;
+        for (auto &callback : onStart[index])
+            callback(modules[index]);
+        onStart[index].clear();
+    }
 public:
     GameEngine() { engineRunning.store(false); }
     
-    bool init() {
+    // Requests every module's assets and returns without waiting for them: modules without
+    // dependencies start now, the rest start from the frame loop as their assets arrive, so the
+    // first frame does not wait on asset I/O.
+    bool init(AssetStore &store) {
+        assets = &store;
         // Instantiate all modules.
         modules.push_back(new UnitModule());
         modules.push_back(new CombatModule());
@@ -373,16 +389,31 @@ public:
         modules.push_back(new GovernmentModule());
         modules.push_back(new ChatModule());
         modules.push_back(new MiscModule());
-        for (Module* mod : modules) {
-            if (!mod->init()) {
-                logEvent("GameEngine: Failed to initialize a module.");
-                return false;
+        waiting.assign(modules.size(), 0);
+        started.assign(modules.size(), false);
+        onStart.assign(modules.size(), {});
+        for (size_t i = 0; i < modules.size(); i++) {
+            vector<AssetRequest> deps = modules[i]->dependencies();
+            waiting[i] = deps.size();
+            for (const auto &dep : deps) {
+                // Missing assets are reported by the store; the module starts regardless.
+                store.acquire(dep.id, dep.priority, [this, i](const ResourceHandle &) {
+                    if (--waiting[i] == 0) start(i);
+                });
             }
         }
+        for (size_t i = 0; i < modules.size(); i++)
+            if (waiting[i] == 0 && !started[i]) start(i);
         engineRunning.store(true);
         return true;
     }
     
+    // Runs `callback` once the module has started (immediately if it already has). Call before run().
+    void whenStarted(size_t index, function<void(Module*)> callback) {
+        if (started[index]) callback(modules[index]);
+        else onStart[index].push_back(move(callback));
+    }
+    
     void run() {
         mainLoopThread = thread([this]() { this->mainLoop(); });
     }
@@ -390,8 +421,10 @@ public:
     void mainLoop() {
         int iter = 0;
         while (engineRunning.load()) {
-            for (Module* mod : modules)
-                mod->update();
+            if (assets)
+                assets->update();
+            for (size_t i = 0; i < modules.size(); i++)
+                if (started[i]) modules[i]->update();
             // Every 100 iterations, print unit status.
             if (iter % 100 == 0) {
                 UnitModule *um = dynamic_cast<UnitModule*>(modules[0]);
@@ -409,9 +442,9 @@ public:
     void shutdown() {
         if (mainLoopThread.joinable())
             mainLoopThread.join();
-        for (Module* mod : modules) {
-            mod->shutdown();
-            delete mod;
+        for (size_t i = 0; i < modules.size(); i++) {
+            if (started[i]) modules[i]->shutdown();
+            delete modules[i];
         }
         modules.clear();
     }
@@ -426,39 +459,74 @@ int main() {
     
     /***********************************************************************
      * Resource Loading Section
-     * This section loads every external file required by the engine.
+     * Declares the engine's assets; they are loaded when first requested.
      * Replace the file names with the actual resource files used in your game.
      ***********************************************************************/
-    ResourceLoader loader;
-    vector<string> resourceFiles = {
-        "assets/units.dat",
-        "assets/levels.xml",
-        "assets/lobby.json",
-        "assets/payments.cfg",
-        "assets/profile.ini",
-        "assets/chat.txt",
-        "assets/ai_rules.dat"
-        // Add every other required asset file here.
-    };
-    loader.loadAllResources(resourceFiles);
+    // Content-addressed cache: files whose hash in resources.manifest is already cached are read
+    // from there (IndexedDB in the browser) instead of being fetched again.
+    ResourceCache cache;
+#ifdef __EMSCRIPTEN__
+    cache.open("/cache");
+#else
+    cache.open(".cache/resources");
+#endif
+    if (!cache.loadManifest("resources.manifest"))
+        logEvent("Warning: resources.manifest missing; resource cache disabled.");
+    ResourceLoader loader(2);
+    loader.setCache(&cache);
+    // Nothing is preloaded: assets are requested by id when a module first needs them. The
+    // catalog below maps ids to files; config.json's "assets" object, when present, replaces it.
+    AssetStore assets(loader);
+    assets.declare("units", "assets/units.dat");
+    assets.declare("levels", "assets/levels.xml");
+    assets.declare("lobby", "assets/lobby.json");
+    assets.declare("payments", "assets/payments.cfg");
+    assets.declare("profile", "assets/profile.ini");
+    assets.declare("chat_log", "assets/chat.txt");
+    assets.declare("ai_rules", "assets/ai_rules.dat");
+    vector<string> prefetchIds;
+    ResourceHandle config = loader.request("config.json", ResourcePriority::Critical).get();
+    loader.release("config.json");
+    JsonValue configRoot;
+    if (config->ok() && parseJson(string(config->view()), configRoot)) {
+        if (const JsonValue *catalog = configRoot.find("assets"))
+            assets.declareCatalog(*catalog);
+        if (const JsonValue *hints = configRoot.find("prefetch"); hints && hints->isArray())
+            for (const auto &entry : hints->array)
+                if (entry.isString()) prefetchIds.push_back(entry.string);
+        double budgetMB = configRoot.numberOr("assetBudgetMB", 0.0);
+        if (budgetMB > 0.0)
+            assets.setBudget(static_cast<size_t>(budgetMB * 1024.0 * 1024.0));
+    }
+    // Prefetch hints are read at low priority behind anything a module is waiting for.
+    assets.prefetch(prefetchIds);
     
     /***********************************************************************
      * Engine Initialization and Run
      ***********************************************************************/
     GameEngine engine;
-    if (!engine.init()) {
+    if (!engine.init(assets)) {
         logEvent("GameplayStitched: Engine initialization failed.");
         return 1;
     }
     
-    // Example: Set a destination for the first unit.
-    UnitModule *um = dynamic_cast<UnitModule*>(engine.modules[0]);
-    if (um)
-        um->setDestination(0, 15, 15);
+    // Example: Set a destination for the first unit once its module has its data.
+    engine.whenStarted(0, [](Module *mod) {
+        UnitModule *um = dynamic_cast<UnitModule*>(mod);
+        if (um)
+            um->setDestination(0, 15, 15);
+    });
     
     engine.run();
     engine.shutdown();
     
+    // Drop objects for resources that changed since the last run and flush new ones.
+    loader.waitAll();
+    cache.prune();
+    cache.persist();
+    logEvent("Resources: " + to_string(loader.cacheHits()) + " served from cache, " +
+             to_string(assets.evictions()) + " assets evicted.");
+    
     logEvent("GameplayStitched Engine Terminated.");
     return 0;
 }
@@ -0,0 +1,331 @@
+/*
+ * geo.cpp - Haversine / equirectangular distances, scalar and batched over SoA lat/lng columns.
+ */
+
+#include "geo.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
+    std::cout << "[" << level << "] " << message << std::endl;
+}
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kDegToRad = kPi / 180.0;
+constexpr float kKmPerRadian = static_cast<float>(kEarthRadiusKm);
+
+constexpr float kHalfRadPerDegree = static_cast<float>(kDegToRad * 0.5);
+
+// sin(x) for |x| <= pi/2 (Taylor to x^13, |error| < 1e-9).
+inline float sinPoly(float x) {
+    float x2 = x * x;
+    float p = 1.0f / 6227020800.0f;
+    p = p * x2 - 1.0f / 39916800.0f;
+    p = p * x2 + 1.0f / 362880.0f;
+    p = p * x2 - 1.0f / 5040.0f;
+    p = p * x2 + 1.0f / 120.0f;
+    p = p * x2 - 1.0f / 6.0f;
+    return x + x * x2 * p;
+}
+
+// asin(x) for x in [0, 1] (the Cephes asinf polynomial, about 1e-7 relative): the polynomial in
+// x^2 up to 0.5, and pi/2 - 2 asin(sqrt((1 - x) / 2)) above. Both branches are evaluated and one
+// selected, so loops calling it vectorize.
+inline float asinPoly(float x) {
+    const bool upper = x > 0.5f;
+    float z = upper ? 0.5f * (1.0f - x) : x * x;
+    float r = upper ? std::sqrt(z) : x;
+    float p = 4.2163199048e-2f;
+    p = p * z + 2.4181311049e-2f;
+    p = p * z + 4.5470025998e-2f;
+    p = p * z + 7.4953002686e-2f;
+    p = p * z + 1.6666752422e-1f;
+    float a = r + r * z * p;
+    return upper ? 1.5707963268f - 2.0f * a : a;
+}
+
+inline float wrapDelta(float d) {
+    d = d >= 180.0f ? d - 360.0f : d;
+    return d < -180.0f ? d + 360.0f : d;
+}
+
+// Haversine term h for one pair; cosProduct = cos(lat1) * cos(lat2).
+inline float haversineTerm(float dLat, float dLng, float cosProduct) {
+    float a = sinPoly(dLat * kHalfRadPerDegree);
+    float b = sinPoly(wrapDelta(dLng) * kHalfRadPerDegree);
+    return a * a + cosProduct * b * b;
+}
+
+// Great-circle km for one pair. asin(sqrt(h)) loses precision as h approaches 1 (near-antipodal
+// pairs), so past h = 0.5 the distance is taken from the antipode of the second point instead:
+// its term is 1 - h, evaluated directly from the latitude sum and cos(dLng / 2).
+inline float pairKm(float lat1, float lng1, float lat2, float lng2, float cosProduct) {
+    float dLng = wrapDelta(lng2 - lng1);
+    float a = sinPoly((lat2 - lat1) * kHalfRadPerDegree);
+    float b = sinPoly(dLng * kHalfRadPerDegree);
+    float h = a * a + cosProduct * b * b;
+    float s = sinPoly((lat1 + lat2) * kHalfRadPerDegree);
+    float c = sinPoly((180.0f - std::fabs(dLng)) * kHalfRadPerDegree);
+    float anti = s * s + cosProduct * c * c;
+    float nearKm = 2.0f * kKmPerRadian * asinPoly(std::sqrt(h));
+    float farKm = kKmPerRadian * (3.14159265f - 2.0f * asinPoly(std::sqrt(anti)));
+    return h <= 0.5f ? nearKm : farKm;
+}
+
+double wrapDegrees(double d) {
+    return d - 360.0 * std::floor((d + 180.0) / 360.0);
+}
+
+} // namespace
+
+//-------------------------------------------------
+// Scalar
+//-------------------------------------------------
+double haversineKm(double lat1, double lng1, double lat2, double lng2) {
+    const double p1 = lat1 * kDegToRad, p2 = lat2 * kDegToRad;
+    const double sLat = std::sin((p2 - p1) * 0.5), sLng = std::sin((lng2 - lng1) * kDegToRad * 0.5);
+    const double h = sLat * sLat + std::cos(p1) * std::cos(p2) * sLng * sLng;
+    return 2.0 * kEarthRadiusKm * std::asin(std::min(1.0, std::sqrt(h)));
+}
+
+double equirectangularKm(double lat1, double lng1, double lat2, double lng2) {
+    const double x = wrapDegrees(lng2 - lng1) * kDegToRad * std::cos((lat1 + lat2) * 0.5 * kDegToRad);
+    const double y = (lat2 - lat1) * kDegToRad;
+    return kEarthRadiusKm * std::sqrt(x * x + y * y);
+}
+
+std::vector<std::pair<float, float>> greatCircleRoute(double lat1, double lng1, double lat2, double lng2,
+                                                      double maxLegKm) {
+    // Spherical interpolation between the unit vectors of both ends.
+    const double a0 = lat1 * kDegToRad, b0 = lng1 * kDegToRad, a1 = lat2 * kDegToRad, b1 = lng2 * kDegToRad;
+    const double a[3] = {std::cos(a0) * std::cos(b0), std::cos(a0) * std::sin(b0), std::sin(a0)};
+    const double b[3] = {std::cos(a1) * std::cos(b1), std::cos(a1) * std::sin(b1), std::sin(a1)};
+    const double angle = std::acos(std::min(1.0, std::max(-1.0, a[0] * b[0] + a[1] * b[1] + a[2] * b[2])));
+    const int legs = maxLegKm > 0.0 ? std::max(1, static_cast<int>(std::ceil(angle * kEarthRadiusKm / maxLegKm))) : 1;
+
+    std::vector<std::pair<float, float>> route;
+    route.reserve(legs);
+    const double sinAngle = std::sin(angle);
+    for (int k = 1; k < legs; ++k) {
+        double t = static_cast<double>(k) / legs;
+        double wa = std::sin((1.0 - t) * angle) / sinAngle, wb = std::sin(t * angle) / sinAngle;
+        double p[3] = {wa * a[0] + wb * b[0], wa * a[1] + wb * b[1], wa * a[2] + wb * b[2]};
+        route.emplace_back(static_cast<float>(std::atan2(p[2], std::hypot(p[0], p[1])) / kDegToRad),
+                           static_cast<float>(wrapDegrees(std::atan2(p[1], p[0]) / kDegToRad)));
+    }
+    route.emplace_back(static_cast<float>(lat2), static_cast<float>(wrapDegrees(lng2)));
+    return route;
+}
+
+void equirectangularKmBatch(float lat, float lng, const float* lats, const float* lngs, std::size_t n, float* outKm) {
+    const float scale = static_cast<float>(std::cos(lat * kDegToRad));
+    const float toKm = static_cast<float>(kDegToRad * kEarthRadiusKm);
+    for (std::size_t i = 0; i < n; ++i) {
+        float dx = lngs[i] - lng;
+        dx = dx >= 180.0f ? dx - 360.0f : dx;
+        dx = dx < -180.0f ? dx + 360.0f : dx;
+        dx *= scale;
+        float dy = lats[i] - lat;
+        outKm[i] = toKm * std::sqrt(dx * dx + dy * dy);
+    }
+}
+
+//-------------------------------------------------
+// Geo Points
+//-------------------------------------------------
+void GeoPoints::clear() {
+    lats.clear();
+    lngs.clear();
+    cosLats.clear();
+}
+
+void GeoPoints::reserve(std::size_t n) {
+    lats.reserve(n);
+    lngs.reserve(n);
+    cosLats.reserve(n);
+}
+
+std::size_t GeoPoints::add(double lat, double lng) {
+    lats.push_back(static_cast<float>(lat));
+    lngs.push_back(static_cast<float>(wrapDegrees(lng)));
+    cosLats.push_back(static_cast<float>(std::cos(lat * kDegToRad)));
+    return lats.size() - 1;
+}
+
+void GeoPoints::assign(const float* latitudes, const float* longitudes, std::size_t n) {
+    clear();
+    reserve(n);
+    for (std::size_t i = 0; i < n; ++i) add(latitudes[i], longitudes[i]);
+}
+
+void GeoPoints::distancesKm(double lat, double lng, float* outKm) const {
+    const float qLat = static_cast<float>(lat), qLng = static_cast<float>(wrapDegrees(lng));
+    const float qCos = static_cast<float>(std::cos(lat * kDegToRad));
+    const float* la = lats.data();
+    const float* lo = lngs.data();
+    const float* co = cosLats.data();
+    for (std::size_t i = 0; i < lats.size(); ++i)
+        outKm[i] = pairKm(qLat, qLng, la[i], lo[i], qCos * co[i]);
+}
+
+void GeoPoints::distancesKm(const GeoPoints& from, float* outKm) const {
+    const std::size_t n = lats.size();
+    const float* la = lats.data();
+    const float* lo = lngs.data();
+    const float* co = cosLats.data();
+    for (std::size_t r = 0; r < from.size(); ++r) {
+        const float qLat = from.lats[r], qLng = from.lngs[r], qCos = from.cosLats[r];
+        float* row = outKm + r * n;
+        for (std::size_t i = 0; i < n; ++i)
+            row[i] = pairKm(qLat, qLng, la[i], lo[i], qCos * co[i]);
+    }
+}
+
+std::size_t GeoPoints::within(double lat, double lng, double km, std::uint8_t* mask) const {
+    const float qLat = static_cast<float>(lat), qLng = static_cast<float>(wrapDegrees(lng));
+    const float qCos = static_cast<float>(std::cos(lat * kDegToRad));
+    const double half = std::sin(std::min(kPi, km / kEarthRadiusKm) * 0.5);
+    const float limit = static_cast<float>(half * half);
+    const float* la = lats.data();
+    const float* lo = lngs.data();
+    const float* co = cosLats.data();
+    const std::size_t n = lats.size();
+    for (std::size_t i = 0; i < n; ++i)
+        mask[i] = haversineTerm(la[i] - qLat, lo[i] - qLng, qCos * co[i]) <= limit;
+    // Counted in a second pass: mixing the byte mask and a wide counter keeps the loop above scalar.
+    std::size_t inside = 0;
+    for (std::size_t i = 0; i < n; ++i) inside += mask[i];
+    return inside;
+}
+
+std::size_t GeoPoints::nearest(double lat, double lng) const {
+    const float qLat = static_cast<float>(lat), qLng = static_cast<float>(wrapDegrees(lng));
+    const float qCos = static_cast<float>(std::cos(lat * kDegToRad));
+    std::size_t best = SIZE_MAX;
+    float bestTerm = 2.0f;      // Above the largest h (1).
+    for (std::size_t i = 0; i < lats.size(); ++i) {
+        float h = haversineTerm(lats[i] - qLat, lngs[i] - qLng, qCos * cosLats[i]);
+        if (h < bestTerm) {
+            bestTerm = h;
+            best = i;
+        }
+    }
+    return best;
+}
+
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DGEO_TEST)
+// Batched distances must stay within 5 cm (plus 1e-6 relative) of the double haversine over
+// random pairs at every scale, radius masks must agree with the reference away from the boundary,
+// and the batched kernels are timed against the scalar reference.
+// GCC only vectorizes the sqrt and float selects without errno and trapping-math semantics, which
+// clang already drops for the wasm build:
+//   g++ -std=c++17 -O3 -fno-math-errno -fno-trapping-math -DGEO_TEST geo.cpp -o geo
+#ifdef GEO_TEST
+#include <chrono>
+#include <random>
+
+int main() {
+    int failures = 0;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> latDist(-89.0f, 89.0f), lngDist(-180.0f, 179.99f);
+    std::uniform_real_distribution<float> jitter(-0.01f, 0.01f);
+    auto ms = [](std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    };
+
+    // Known distance: London to Paris is about 343.5 km.
+    failures += std::fabs(haversineKm(51.5074, -0.1278, 48.8566, 2.3522) - 343.5) > 1.0;
+
+    // Accuracy: random far pairs and close pairs (jittered by up to ~1 km), against the reference.
+    const std::size_t n = 200000;
+    std::vector<float> lats(n), lngs(n);
+    const float qLat = 48.0f, qLng = 11.0f;
+    for (std::size_t i = 0; i < n; ++i) {
+        bool close = i % 2 == 0;
+        lats[i] = close ? qLat + jitter(rng) : latDist(rng);
+        lngs[i] = close ? qLng + jitter(rng) : lngDist(rng);
+    }
+    GeoPoints points;
+    points.assign(lats.data(), lngs.data(), n);
+    std::vector<float> km(n);
+    points.distancesKm(qLat, qLng, km.data());
+    double worst = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        double ref = haversineKm(qLat, qLng, lats[i], lngs[i]);
+        double err = std::fabs(km[i] - ref);
+        worst = std::max(worst, err);
+        failures += err > 5e-5 + 1e-6 * ref;
+    }
+    std::cout << "One-to-many: worst error " << worst * 1000.0 << " m over " << n << " points" << std::endl;
+
+    // Equirectangular stays close to haversine over short ranges only.
+    std::vector<float> flat(n);
+    equirectangularKmBatch(qLat, qLng, lats.data(), lngs.data(), n, flat.data());
+    for (std::size_t i = 0; i < n; i += 2) failures += std::fabs(flat[i] - km[i]) > 0.01f;
+
+    // Radius mask versus the reference, skipping points within 1 m of the boundary.
+    std::vector<std::uint8_t> mask(n);
+    const double radius = 0.8;
+    std::size_t inside = points.within(qLat, qLng, radius, mask.data());
+    std::size_t maskErrors = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        double ref = haversineKm(qLat, qLng, lats[i], lngs[i]);
+        if (std::fabs(ref - radius) < 1e-3) continue;
+        maskErrors += (ref <= radius) != (mask[i] != 0);
+    }
+    failures += maskErrors > 0 || inside == 0;
+    std::cout << "Within " << radius << " km: " << inside << " points, " << maskErrors << " disagreements" << std::endl;
+
+    // Many-to-many over a city-sized set, spot-checked against the reference.
+    GeoPoints cities;
+    for (int i = 0; i < 1000; ++i) cities.add(latDist(rng), lngDist(rng));
+    std::vector<float> matrix(cities.size() * cities.size());
+    auto t0 = std::chrono::steady_clock::now();
+    cities.distancesKm(cities, matrix.data());
+    double matrixMs = ms(t0);
+    for (std::size_t r = 0; r < cities.size(); r += 97)
+        for (std::size_t c = 0; c < cities.size(); c += 89) {
+            double ref = haversineKm(cities.lat(r), cities.lng(r), cities.lat(c), cities.lng(c));
+            failures += std::fabs(matrix[r * cities.size() + c] - ref) > 5e-5 + 1e-6 * ref;
+        }
+    failures += cities.nearest(cities.lat(123), cities.lng(123)) != 123;
+
+    // Great-circle route: legs no longer than asked, ending on the destination.
+    auto route = greatCircleRoute(35.7, 139.7, 37.8, -122.4, 500.0);
+    double prevLat = 35.7, prevLng = 139.7, longest = 0.0;
+    for (const auto& p : route) {
+        longest = std::max(longest, haversineKm(prevLat, prevLng, p.first, p.second));
+        prevLat = p.first;
+        prevLng = p.second;
+    }
+    failures += longest > 500.5 || route.back().second != -122.4f;
+
+    // Throughput: batched one-to-many versus the scalar double reference.
+    const int reps = 20;
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r) points.distancesKm(qLat + r * 0.01f, qLng, km.data());
+    double batchMs = ms(t0) / reps;
+    t0 = std::chrono::steady_clock::now();
+    double sink = 0.0;
+    for (int r = 0; r < reps; ++r)
+        for (std::size_t i = 0; i < n; ++i) sink += haversineKm(qLat + r * 0.01f, qLng, lats[i], lngs[i]);
+    double scalarMs = ms(t0) / reps;
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r) inside += points.within(qLat + r * 0.01f, qLng, radius, mask.data());
+    double withinMs = ms(t0) / reps;
+    std::cout << "Per " << n << " points: batched " << batchMs << " ms (" << n / batchMs / 1000.0
+              << " M/s), scalar " << scalarMs << " ms, radius mask " << withinMs << " ms; 1000x1000 matrix "
+              << matrixMs << " ms (checksum " << static_cast<long long>(sink) % 10 << "); failures: " << failures
+              << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+// End of geo.cpp
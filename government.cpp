@@ -0,0 +1,285 @@
+/*
+ * government.cpp - SoA government state, vectorizable stability pass and policy-change events.
+ */
+
+#include "government.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
+    std::cout << "[" << level << "] " << message << std::endl;
+}
+
+namespace {
+
+struct GovernmentDefinition {
+    const char* name;
+    float stability;
+    float economicBonus;
+    float militaryBonus;
+    Policy preferredPolicy;
+};
+
+// Government_types from government.py, plus the policy each type drifts toward when stable.
+const GovernmentDefinition kGovernments[kGovernmentTypeCount] = {
+    {"Democracy", 80, 5, 5, Policy::Reform},
+    {"Republic", 75, 7, 4, Policy::Mercantile},
+    {"Oligarchy", 65, 4, 6, Policy::Mercantile},
+    {"Monarchy", 70, 5, 7, Policy::Expansionist},
+    {"Dictatorship", 60, 3, 10, Policy::Expansionist},
+    {"Technocracy", 85, 10, 5, Policy::Reform},
+    {"Plutocracy", 55, 8, 4, Policy::Mercantile},
+};
+
+struct PolicyDefinition {
+    const char* name;
+    float economicBonusDelta;
+    float militaryBonusDelta;
+    float stabilityDelta;       // Shifts the stability target while the policy is active.
+};
+
+const PolicyDefinition kPolicies[kPolicyCount] = {
+    {"Neutral", 0, 0, 0},
+    {"Expansionist", -1, 3, -3},
+    {"Mercantile", 3, -1, 0},
+    {"Reform", 1, 0, 4},
+};
+
+// Stability thresholds with hysteresis, so a nation does not flip policies every tick.
+constexpr float kAdoptPolicyStability = 70.0f;
+constexpr float kAbandonPolicyStability = 35.0f;
+
+inline std::uint32_t hashIndex(std::uint32_t index, std::uint32_t salt) {
+    std::uint32_t h = (index ^ salt) * 0x9E3779B1u;
+    h ^= h >> 15;
+    h *= 0x85EBCA77u;
+    h ^= h >> 13;
+    return h;
+}
+
+inline float clampStability(double value) {
+    return static_cast<float>(std::min(100.0, std::max(0.0, value)));
+}
+
+} // namespace
+
+const char* GovernmentSystem::typeName(GovernmentType type) { return kGovernments[static_cast<int>(type)].name; }
+const char* GovernmentSystem::policyName(Policy policy) { return kPolicies[static_cast<int>(policy)].name; }
+
+void GovernmentSystem::reset(std::size_t nationCount, std::uint32_t seed, std::int32_t electionIntervalTicks) {
+    nations = nationCount;
+    rngSeed = seed;
+    draws = 0;
+    elections = 0;
+    electionInterval = std::max<std::int32_t>(1, electionIntervalTicks);
+    types.assign(nations, 0);
+    policies.assign(nations, static_cast<std::uint8_t>(Policy::Neutral));
+    desiredPolicies.assign(nations, static_cast<std::uint8_t>(Policy::Neutral));
+    preferredPolicies.assign(nations, static_cast<std::uint8_t>(Policy::Neutral));
+    stabilities.assign(nations, 0.0f);
+    targetStabilities.assign(nations, 0.0f);
+    economicBonuses.assign(nations, 0.0f);
+    militaryBonuses.assign(nations, 0.0f);
+    electionCountdown.assign(nations, 0);
+    for (std::size_t n = 0; n < nations; ++n) {
+        std::uint32_t h = hashIndex(static_cast<std::uint32_t>(n), seed);
+        const GovernmentDefinition& def = kGovernments[h % kGovernmentTypeCount];
+        types[n] = static_cast<std::uint8_t>(h % kGovernmentTypeCount);
+        preferredPolicies[n] = static_cast<std::uint8_t>(def.preferredPolicy);
+        stabilities[n] = targetStabilities[n] = def.stability;
+        economicBonuses[n] = def.economicBonus;
+        militaryBonuses[n] = def.militaryBonus;
+        electionCountdown[n] = 1 + static_cast<std::int32_t>((h >> 8) % static_cast<std::uint32_t>(electionInterval));
+        // Governments that start out stable already follow their preferred policy (no event).
+        if (def.stability >= kAdoptPolicyStability) {
+            const PolicyDefinition& p = kPolicies[static_cast<int>(def.preferredPolicy)];
+            policies[n] = desiredPolicies[n] = static_cast<std::uint8_t>(def.preferredPolicy);
+            economicBonuses[n] += p.economicBonusDelta;
+            militaryBonuses[n] += p.militaryBonusDelta;
+            targetStabilities[n] += p.stabilityDelta;
+        }
+    }
+}
+
+double GovernmentSystem::uniform(double lo, double hi) {
+    std::uint32_t h = hashIndex(++draws, rngSeed ^ 0xA5A5A5A5u);
+    return lo + (hi - lo) * (h / 4294967296.0);
+}
+
+void GovernmentSystem::applyPolicy(NationId nation, Policy policy) {
+    Policy from = static_cast<Policy>(policies[nation]);
+    if (from == policy) return;
+    const PolicyDefinition& oldDef = kPolicies[static_cast<int>(from)];
+    const PolicyDefinition& newDef = kPolicies[static_cast<int>(policy)];
+    economicBonuses[nation] += newDef.economicBonusDelta - oldDef.economicBonusDelta;
+    militaryBonuses[nation] += newDef.militaryBonusDelta - oldDef.militaryBonusDelta;
+    targetStabilities[nation] += newDef.stabilityDelta - oldDef.stabilityDelta;
+    policies[nation] = desiredPolicies[nation] = static_cast<std::uint8_t>(policy);
+    if (onPolicyChange) onPolicyChange(PolicyChange{nation, from, policy, stabilities[nation]});
+}
+
+void GovernmentSystem::setGovernment(NationId nation, GovernmentType type) {
+    if (nation >= nations) return;
+    applyPolicy(nation, Policy::Neutral);       // A new government starts without the old agenda.
+    const GovernmentDefinition& def = kGovernments[static_cast<int>(type)];
+    types[nation] = static_cast<std::uint8_t>(type);
+    preferredPolicies[nation] = static_cast<std::uint8_t>(def.preferredPolicy);
+    stabilities[nation] = targetStabilities[nation] = def.stability;
+    economicBonuses[nation] = def.economicBonus;
+    militaryBonuses[nation] = def.militaryBonus;
+}
+
+void GovernmentSystem::setPolicy(NationId nation, Policy policy) {
+    if (nation >= nations) return;
+    applyPolicy(nation, policy);
+}
+
+void GovernmentSystem::applyPolicyEffect(NationId nation, double economicBonusDelta, double militaryBonusDelta,
+                                         double stabilityDelta) {
+    if (nation >= nations) return;
+    economicBonuses[nation] += static_cast<float>(economicBonusDelta);
+    militaryBonuses[nation] += static_cast<float>(militaryBonusDelta);
+    adjustStability(nation, stabilityDelta);
+}
+
+void GovernmentSystem::adjustStability(NationId nation, double delta) {
+    if (nation >= nations) return;
+    stabilities[nation] = clampStability(stabilities[nation] + delta);
+}
+
+void GovernmentSystem::holdElection(NationId nation) {
+    if (nation >= nations) return;
+    adjustStability(nation, uniform(-10, 15));
+    ++elections;
+}
+
+std::size_t GovernmentSystem::step() {
+    const std::size_t n = nations;
+    float* stability = stabilities.data();
+    const float* target = targetStabilities.data();
+    const float relax = relaxRate;
+    // Pass 1: stability relaxation (straight float loop).
+    for (std::size_t i = 0; i < n; ++i) stability[i] += (target[i] - stability[i]) * relax;
+
+    // Pass 2: election countdowns.
+    std::int32_t* countdown = electionCountdown.data();
+    for (std::size_t i = 0; i < n; ++i) countdown[i] -= 1;
+
+    // Pass 3: desired policy as a branchless select on stability.
+    const std::uint8_t* current = policies.data();
+    const std::uint8_t* preferred = preferredPolicies.data();
+    std::uint8_t* desired = desiredPolicies.data();
+    for (std::size_t i = 0; i < n; ++i) {
+        std::uint8_t adopt = (current[i] == 0) & (stability[i] >= kAdoptPolicyStability);
+        std::uint8_t abandon = (current[i] != 0) & (stability[i] < kAbandonPolicyStability);
+        std::uint8_t next = adopt ? preferred[i] : current[i];
+        desired[i] = abandon ? 0 : next;
+    }
+
+    // Sparse follow-up: only nations with an election due or a policy to change.
+    due.clear();
+    for (std::size_t i = 0; i < n; ++i)
+        if ((countdown[i] <= 0) | (desired[i] != current[i])) due.push_back(static_cast<NationId>(i));
+
+    std::size_t changes = 0;
+    for (NationId nation : due) {
+        if (electionCountdown[nation] <= 0) {
+            holdElection(nation);
+            electionCountdown[nation] += electionInterval;
+        }
+        if (desiredPolicies[nation] != policies[nation]) {
+            applyPolicy(nation, static_cast<Policy>(desiredPolicies[nation]));
+            ++changes;
+        }
+    }
+    return changes;
+}
+
+//-------------------------------------------------
+// Module entry points
+//-------------------------------------------------
+GovernmentSystem& governments() {
+    static GovernmentSystem system;
+    return system;
+}
+
+bool initGovernment() {
+    GovernmentSystem& system = governments();
+    if (system.nationCount() == 0)
+        logEvent("Government: No nations registered; nothing to simulate.", "WARNING");
+    logEvent("Government: Initialized governments for " + std::to_string(system.nationCount()) + " nations.");
+    return true;
+}
+
+void updateGovernment() {
+    governments().step();
+}
+
+void cleanupGovernment() {
+    GovernmentSystem& system = governments();
+    logEvent("Government: Shut down after " + std::to_string(system.electionsHeld()) + " elections.");
+    system.reset(0);
+}
+
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DGOVERNMENT_TEST)
+// Replays government.py's standalone scenario, then times the per-tick pass.
+#ifdef GOVERNMENT_TEST
+#include <chrono>
+#include <iomanip>
+
+int main() {
+    NationRegistry registry;
+    NationId testLand = registry.intern("TL", "TestLand");
+    NationId horizon = registry.intern("NH", "New Horizon");
+    NationId empire = registry.intern("OE", "Old Empire");
+
+    GovernmentSystem gov;
+    gov.reset(registry.count(), 3, 100);
+    gov.setPolicyListener([&](const PolicyChange& c) {
+        std::cout << registry.name(c.nation) << ": policy " << GovernmentSystem::policyName(c.from) << " -> "
+                  << GovernmentSystem::policyName(c.to) << " at stability " << c.stability << std::endl;
+    });
+    auto dump = [&]() {
+        std::cout << "---- National Government Status ----" << std::endl;
+        for (NationId n = 0; n < registry.count(); ++n)
+            std::cout << registry.name(n) << ": " << GovernmentSystem::typeName(gov.type(n)) << " (Stability: "
+                      << std::fixed << std::setprecision(1) << gov.stability(n) << ", Economy Bonus: "
+                      << gov.economicBonus(n) << "%, Military Bonus: " << gov.militaryBonus(n) << "%, Policy: "
+                      << GovernmentSystem::policyName(gov.policy(n)) << ")" << std::endl;
+    };
+
+    gov.setGovernment(testLand, GovernmentType::Republic);
+    gov.setGovernment(horizon, GovernmentType::Technocracy);
+    gov.setGovernment(empire, GovernmentType::Monarchy);
+    dump();
+    for (NationId n : {testLand, horizon, empire}) gov.holdElection(n);
+    gov.setGovernment(empire, GovernmentType::Dictatorship);
+    gov.applyPolicyEffect(testLand, +2, -1, +5);
+    for (int t = 0; t < 300; ++t) gov.step();
+    dump();
+
+    // Crisis: a collapse in stability forces the policy back to Neutral on the next pass.
+    int failures = 0;
+    Policy before = gov.policy(horizon);
+    gov.adjustStability(horizon, -100);
+    gov.step();
+    failures += before != Policy::Neutral && gov.policy(horizon) != Policy::Neutral;
+
+    // Throughput: 200 nations.
+    gov.setPolicyListener(nullptr);
+    gov.reset(200, 11, 18000);
+    const int ticks = 100000;
+    std::size_t changes = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int t = 0; t < ticks; ++t) changes += gov.step();
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Government pass over 200 nations: " << std::setprecision(3) << us / ticks << " us/tick ("
+              << gov.electionsHeld() << " elections, " << changes << " policy changes)" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+// End of government.cpp
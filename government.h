@@ -1,7 +1,140 @@
+/**************************************************************************************************
+ * government.h
+ * Government Subsystem for Conqueror Engine (Header)
+ *
+ * Native counterpart of government.py. Every nation's government is a row in structure-of-arrays
+ * columns (type, policy, stability, economic/military bonus, election countdown), so one update
+ * is a single vectorizable pass over all nations:
+ *   - stability relaxes toward the government type's baseline plus the active policy's shift,
+ *   - election countdowns tick down,
+ *   - the desired policy is recomputed from stability (stable nations adopt their government's
+ *     preferred policy, unstable ones fall back to Neutral).
+ * Only nations whose election is due or whose desired policy differs are then visited, and each
+ * policy change is reported as a PolicyChange event instead of comparing strings every tick.
+ *
+ * Exposed Types:
+ * - GovernmentType / Policy / PolicyChange
+ * - GovernmentSystem
+ *
+ * Module entry points (operate on the process-wide system returned by governments()):
+ * - initGovernment / updateGovernment / cleanupGovernment
+ **************************************************************************************************/
+
 #ifndef GOVERNMENT_H
 #define GOVERNMENT_H
 
-// Government module header
+#include "nations.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+//-------------------------------------------------
+// Government types (government.py's Government_types) and policies
+//-------------------------------------------------
+enum class GovernmentType : std::uint8_t {
+    Democracy = 0,
+    Republic,
+    Oligarchy,
+    Monarchy,
+    Dictatorship,
+    Technocracy,
+    Plutocracy
+};
+constexpr int kGovernmentTypeCount = 7;
+
+enum class Policy : std::uint8_t {
+    Neutral = 0,
+    Expansionist,
+    Mercantile,
+    Reform
+};
+constexpr int kPolicyCount = 4;
+
+struct PolicyChange {
+    NationId nation;
+    Policy from;
+    Policy to;
+    float stability;            // Stability at the moment of the change.
+};
+
+//-------------------------------------------------
+// Government System
+//-------------------------------------------------
+class GovernmentSystem {
+public:
+    using PolicyListener = std::function<void(const PolicyChange&)>;
+
+    /**
+     * @brief Assigns every nation a government (spread over the types by a seeded hash) with the
+     * type's baseline stats and the Neutral policy. Elections are staggered over one interval.
+     */
+    void reset(std::size_t nationCount, std::uint32_t seed = 1, std::int32_t electionIntervalTicks = 30 * 60 * 10);
+
+    void setPolicyListener(PolicyListener listener) { onPolicyChange = std::move(listener); }
+
+    // change_government(): swaps the type and resets stats to the new type's baseline.
+    void setGovernment(NationId nation, GovernmentType type);
+    // Explicit policy choice (player or AI); emits a PolicyChange if the policy differs.
+    void setPolicy(NationId nation, Policy policy);
+    // apply_policy_effect(): one-off bonus/stability deltas.
+    void applyPolicyEffect(NationId nation, double economicBonusDelta, double militaryBonusDelta, double stabilityDelta);
+    // update_stability(): clamped to 0..100.
+    void adjustStability(NationId nation, double delta);
+    // simulate_election(): stability swings by -10..+15.
+    void holdElection(NationId nation);
+
+    /**
+     * @brief Advances every nation by one tick (single SoA pass), then resolves due elections and
+     * pending policy changes.
+     * @return Number of policy changes emitted.
+     */
+    std::size_t step();
+
+    GovernmentType type(NationId nation) const { return static_cast<GovernmentType>(types[nation]); }
+    Policy policy(NationId nation) const { return static_cast<Policy>(policies[nation]); }
+    float stability(NationId nation) const { return stabilities[nation]; }
+    float economicBonus(NationId nation) const { return economicBonuses[nation]; }   // Percent.
+    float militaryBonus(NationId nation) const { return militaryBonuses[nation]; }   // Percent.
+    std::size_t nationCount() const { return nations; }
+    std::size_t electionsHeld() const { return elections; }
+
+    static const char* typeName(GovernmentType type);
+    static const char* policyName(Policy policy);
+
+    // Stability relaxation per tick toward the target (fraction of the gap).
+    float relaxRate = 0.0005f;
+
+private:
+    std::size_t nations = 0;
+    std::uint32_t rngSeed = 1;
+    std::uint32_t draws = 0;
+    std::int32_t electionInterval = 1;
+    std::size_t elections = 0;
+
+    // SoA columns, one entry per nation.
+    std::vector<std::uint8_t> types;
+    std::vector<std::uint8_t> policies;
+    std::vector<std::uint8_t> desiredPolicies;
+    std::vector<std::uint8_t> preferredPolicies;  // Policy the government type adopts when stable.
+    std::vector<float> stabilities;
+    std::vector<float> targetStabilities;       // Type baseline + active policy shift.
+    std::vector<float> economicBonuses;
+    std::vector<float> militaryBonuses;
+    std::vector<std::int32_t> electionCountdown;
+
+    std::vector<NationId> due;                  // Scratch: nations with an election or policy change.
+    PolicyListener onPolicyChange;
+
+    void applyPolicy(NationId nation, Policy policy);
+    double uniform(double lo, double hi);
+};
+
+// Process-wide government system used by the module entry points below.
+GovernmentSystem& governments();
+
+// Government module entry points.
 // Declares functions for initializing, updating, and cleaning up the government module.
 bool initGovernment();
 void updateGovernment();
@@ -0,0 +1,131 @@
+/**************************************************************************************************
+ * influence.h
+ * Per-Nation Influence Maps for Conqueror Engine (Header)
+ *
+ * Coarse world grids (default 4 degrees per cell, row 0 at the north pole) that let nation-level
+ * AI pick targets with a max-query instead of scanning every foreign unit or city:
+ *   - two raw layers per nation: Strength (units) and Value (city production). Unit moves and city
+ *     changes are stamped into the raw grids as they happen; each stamp only marks the 8x8-cell
+ *     tile it lands in as dirty;
+ *   - update() re-blurs just the dirty tiles (plus the kernel radius around them) with a separable
+ *     falloff kernel: one horizontal and one vertical pass, each a sequence of multiply-adds over
+ *     contiguous rows that the compiler vectorizes;
+ *   - view() hands out the blurred layers as immutable shared snapshots, so planners can derive
+ *     per-nation threat (other nations' strength weighted by hostility) and opportunity (enemy
+ *     value) on a worker thread while the tick keeps stamping. A layer that is still referenced by
+ *     a view is copied before it is re-blurred.
+ * Layers are allocated on first use, so nations that never field units or own cities cost nothing.
+ * Longitude does not wrap; influence fades out at the date line.
+ *
+ * Exposed Types:
+ * - InfluenceLayer
+ * - InfluenceView
+ * - InfluenceMaps
+ **************************************************************************************************/
+
+#ifndef INFLUENCE_H
+#define INFLUENCE_H
+
+#include "nations.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+enum class InfluenceLayer : std::uint8_t {
+    Strength = 0,   // Military presence (unit strength).
+    Value = 1       // Economic value (city production).
+};
+constexpr int kInfluenceLayerCount = 2;
+
+using InfluenceGrid = std::shared_ptr<const std::vector<float>>;
+
+//-------------------------------------------------
+// Influence View (immutable, thread-safe snapshot)
+//-------------------------------------------------
+struct InfluenceView {
+    int width = 0, height = 0;
+    double cellDegrees = 0.0;
+    std::vector<InfluenceGrid> layers[kInfluenceLayerCount];   // Per nation; null = all zero.
+
+    std::size_t cellCount() const { return static_cast<std::size_t>(width) * height; }
+    const float* grid(InfluenceLayer layer, NationId nation) const;
+
+    /**
+     * @brief out = sum over nations of weights[nation] * layer(nation). Nations with zero weight
+     * or no layer are skipped (e.g. threat = hostility-weighted strength of everyone else).
+     */
+    void weightedSum(InfluenceLayer layer, const std::vector<float>& weights, std::vector<float>& out) const;
+
+    // Index of the largest score, or SIZE_MAX if every score is <= floor.
+    static std::size_t argmax(const std::vector<float>& score, float floor = 0.0f);
+};
+
+//-------------------------------------------------
+// Influence Maps
+//-------------------------------------------------
+class InfluenceMaps {
+public:
+    static constexpr double kDefaultCellDegrees = 4.0;
+    static constexpr int kDefaultBlurRadius = 2;
+    static constexpr int kTileCells = 8;         // Dirty-tracking tile edge, in cells.
+
+    /**
+     * @brief Clears every layer and sizes the grid.
+     * @param blurRadius Kernel radius in cells; weights fall off as exp(-d^2 / radius^2).
+     */
+    void reset(std::size_t nationCount, double cellDegrees = kDefaultCellDegrees, int blurRadius = kDefaultBlurRadius);
+
+    int width() const { return gridWidth; }
+    int height() const { return gridHeight; }
+    std::size_t nationCount() const { return nations.size(); }
+    std::uint32_t cellOf(double lat, double lng) const;
+    double cellLat(std::uint32_t cell) const;     // Cell centre.
+    double cellLng(std::uint32_t cell) const;
+
+    // Incremental stamps into the raw layers (negative amounts remove influence).
+    void add(InfluenceLayer layer, NationId nation, std::uint32_t cell, float amount);
+    void add(InfluenceLayer layer, NationId nation, double lat, double lng, float amount) {
+        add(layer, nation, cellOf(lat, lng), amount);
+    }
+    void move(InfluenceLayer layer, NationId nation, std::uint32_t from, std::uint32_t to, float amount);
+
+    /**
+     * @brief Re-blurs the dirty tiles of every changed layer.
+     * @return Number of tiles re-blurred.
+     */
+    std::size_t update();
+    // Re-blurs every layer from scratch (reference for the incremental path).
+    void rebuild();
+
+    // Blurred value after the last update().
+    float at(InfluenceLayer layer, NationId nation, std::uint32_t cell) const;
+    float raw(InfluenceLayer layer, NationId nation, std::uint32_t cell) const;
+    InfluenceView view() const;
+
+private:
+    struct Layer {
+        std::vector<float> raw;
+        std::shared_ptr<std::vector<float>> blurred;
+        std::vector<std::uint8_t> tileDirty;
+        std::vector<std::uint32_t> dirtyTiles;
+    };
+    struct Nation {
+        Layer layers[kInfluenceLayerCount];
+    };
+
+    int gridWidth = 0, gridHeight = 0;
+    int tilesWide = 0, tilesHigh = 0;
+    double degrees = kDefaultCellDegrees;
+    int radius = kDefaultBlurRadius;
+    std::vector<float> kernel;                   // kernel[d] for |offset| d = 0..radius.
+    std::vector<float> scratch;                  // Horizontal pass output.
+    std::vector<Nation> nations;
+
+    Layer& layerFor(InfluenceLayer layer, NationId nation);
+    void detach(Layer& layer);
+    void blur(Layer& layer, int x0, int y0, int x1, int y1);
+};
+
+#endif // INFLUENCE_H
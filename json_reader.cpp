@@ -0,0 +1,183 @@
+/*
+ * json_reader.cpp - Minimal lenient JSON parser for Conqueror Engine data files.
+ */
+
+#include "json_reader.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : src(text), pos(0) {}
+
+    bool parseDocument(JsonValue& out, std::string* error) {
+        skipWhitespace();
+        if (!parseValue(out)) return fail(error);
+        skipWhitespace();
+        if (pos != src.size()) {
+            message = "unexpected trailing data";
+            return fail(error);
+        }
+        return true;
+    }
+
+private:
+    const std::string& src;
+    std::size_t pos;
+    std::string message;
+
+    bool fail(std::string* error) {
+        if (error) *error = message + " at offset " + std::to_string(pos);
+        return false;
+    }
+
+    void skipWhitespace() {
+        while (pos < src.size() &&
+               (src[pos] == ' ' || src[pos] == '\t' || src[pos] == '\n' || src[pos] == '\r'))
+            ++pos;
+    }
+
+    bool consume(char c) {
+        skipWhitespace();
+        if (pos < src.size() && src[pos] == c) { ++pos; return true; }
+        return false;
+    }
+
+    bool parseValue(JsonValue& out) {
+        skipWhitespace();
+        if (pos >= src.size()) { message = "unexpected end of input"; return false; }
+        char c = src[pos];
+        if (c == '{') return parseObject(out);
+        if (c == '[') return parseArray(out);
+        if (c == '"') { out.type = JsonValue::Type::String; return parseString(out.string); }
+        if (c == 't' || c == 'f' || c == 'n') return parseLiteral(out);
+        return parseNumber(out);
+    }
+
+    bool parseObject(JsonValue& out) {
+        out.type = JsonValue::Type::Object;
+        ++pos; // '{'
+        if (consume('}')) return true;
+        while (true) {
+            skipWhitespace();
+            std::string key;
+            if (pos >= src.size() || src[pos] != '"') { message = "expected object key"; return false; }
+            if (!parseString(key)) return false;
+            if (!consume(':')) { message = "expected ':'"; return false; }
+            out.object.emplace_back(std::move(key), JsonValue());
+            if (!parseValue(out.object.back().second)) return false;
+            if (consume('}')) return true;
+            if (!consume(',')) { message = "expected ',' or '}'"; return false; }
+            if (consume('}')) return true; // trailing comma
+        }
+    }
+
+    bool parseArray(JsonValue& out) {
+        out.type = JsonValue::Type::Array;
+        ++pos; // '['
+        if (consume(']')) return true;
+        while (true) {
+            out.array.emplace_back();
+            if (!parseValue(out.array.back())) return false;
+            if (consume(']')) return true;
+            if (!consume(',')) { message = "expected ',' or ']'"; return false; }
+            if (consume(']')) return true; // trailing comma
+        }
+    }
+
+    bool parseString(std::string& out) {
+        ++pos; // opening quote
+        while (pos < src.size()) {
+            char c = src[pos++];
+            if (c == '"') return true;
+            if (c != '\\') { out.push_back(c); continue; }
+            if (pos >= src.size()) break;
+            char esc = src[pos++];
+            switch (esc) {
+                case 'n': out.push_back('\n'); break;
+                case 't': out.push_back('\t'); break;
+                case 'r': out.push_back('\r'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'u': {
+                    if (pos + 4 > src.size()) { message = "bad unicode escape"; return false; }
+                    unsigned code = static_cast<unsigned>(std::strtoul(src.substr(pos, 4).c_str(), nullptr, 16));
+                    pos += 4;
+                    // Encode the BMP code point as UTF-8 (surrogate pairs are passed through as-is).
+                    if (code < 0x80) {
+                        out.push_back(static_cast<char>(code));
+                    } else if (code < 0x800) {
+                        out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                    } else {
+                        out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                    }
+                    break;
+                }
+                default: out.push_back(esc); break; // '"', '\\', '/'
+            }
+        }
+        message = "unterminated string";
+        return false;
+    }
+
+    bool parseLiteral(JsonValue& out) {
+        if (src.compare(pos, 4, "true") == 0) { out.type = JsonValue::Type::Bool; out.boolean = true; pos += 4; return true; }
+        if (src.compare(pos, 5, "false") == 0) { out.type = JsonValue::Type::Bool; out.boolean = false; pos += 5; return true; }
+        if (src.compare(pos, 4, "null") == 0) { out.type = JsonValue::Type::Null; pos += 4; return true; }
+        message = "invalid literal";
+        return false;
+    }
+
+    bool parseNumber(JsonValue& out) {
+        const char* begin = src.c_str() + pos;
+        char* end = nullptr;
+        double value = std::strtod(begin, &end);
+        if (end == begin) { message = "invalid value"; return false; }
+        out.type = JsonValue::Type::Number;
+        out.number = value;
+        pos += static_cast<std::size_t>(end - begin);
+        return true;
+    }
+};
+
+} // namespace
+
+const JsonValue* JsonValue::find(const std::string& key) const {
+    if (type != Type::Object) return nullptr;
+    for (const auto& member : object)
+        if (member.first == key) return &member.second;
+    return nullptr;
+}
+
+double JsonValue::numberOr(const std::string& key, double fallback) const {
+    const JsonValue* v = find(key);
+    return (v && v->isNumber()) ? v->number : fallback;
+}
+
+std::string JsonValue::stringOr(const std::string& key, const std::string& fallback) const {
+    const JsonValue* v = find(key);
+    return (v && v->isString()) ? v->string : fallback;
+}
+
+bool parseJson(const std::string& text, JsonValue& out, std::string* error) {
+    out = JsonValue();
+    JsonParser parser(text);
+    return parser.parseDocument(out, error);
+}
+
+bool loadJsonFile(const std::string& path, JsonValue& out, std::string* error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return parseJson(text, out, error);
+}
@@ -0,0 +1,63 @@
+/**************************************************************************************************
+ * json_reader.h
+ * Minimal JSON Reader for Conqueror Engine (Header)
+ *
+ * A small DOM-style JSON parser used to read the engine's data files (countries.geo.json,
+ * data/cities.json, config.json) without pulling a third-party dependency into the WASM build.
+ * The parser is lenient about trailing commas, which the hand-edited data files contain.
+ *
+ * Exposed Types:
+ * - JsonValue
+ * - parseJson / loadJsonFile
+ **************************************************************************************************/
+
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+//-------------------------------------------------
+// JSON Value (DOM node)
+//-------------------------------------------------
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type = Type::Null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    bool isNull() const { return type == Type::Null; }
+    bool isNumber() const { return type == Type::Number; }
+    bool isString() const { return type == Type::String; }
+    bool isArray() const { return type == Type::Array; }
+    bool isObject() const { return type == Type::Object; }
+
+    // Returns the member with the given key, or nullptr if absent / not an object.
+    const JsonValue* find(const std::string& key) const;
+
+    // Convenience accessors with fallbacks for missing or mistyped members.
+    double numberOr(const std::string& key, double fallback) const;
+    std::string stringOr(const std::string& key, const std::string& fallback) const;
+};
+
+/**
+ * @brief Parses a JSON document.
+ * @param text The document text.
+ * @param out Receives the root value.
+ * @param error Optional; receives a message with the byte offset on failure.
+ * @return True on success.
+ */
+bool parseJson(const std::string& text, JsonValue& out, std::string* error = nullptr);
+
+/**
+ * @brief Reads and parses a JSON file.
+ * @return True on success; false if the file is missing or malformed.
+ */
+bool loadJsonFile(const std::string& path, JsonValue& out, std::string* error = nullptr);
+
+#endif // JSON_READER_H
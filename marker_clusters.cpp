@@ -0,0 +1,471 @@
+/*
+ * marker_clusters.cpp - Nested per-zoom grid clusters of units with a triple-buffered viewport export.
+ */
+
+#include "marker_clusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#endif
+
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
+    std::cout << "[" << level << "] " << message << std::endl;
+}
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kMaxMercatorLat = 85.0511287798;   // Leaflet's (EPSG:3857) latitude limit.
+
+// Web-mercator position in [0, 1): x grows east from the date line, y grows south from the top.
+double mercatorX(double lng) {
+    double x = (lng + 180.0) / 360.0;
+    return x - std::floor(x);
+}
+
+double mercatorY(double lat) {
+    double s = std::sin(std::clamp(lat, -kMaxMercatorLat, kMaxMercatorLat) * kPi / 180.0);
+    return 0.5 - std::log((1.0 + s) / (1.0 - s)) / (4.0 * kPi);
+}
+
+// Cells per axis at a zoom level: the world is 256 * 2^zoom pixels wide.
+std::uint32_t cellsAt(int zoom) {
+    return static_cast<std::uint32_t>(std::ldexp(256.0 / MarkerClusters::kCellPixels, zoom));
+}
+
+std::uint32_t cellIndex(double position, std::uint32_t cells) {
+    double cell = std::floor(position * cells);
+    return static_cast<std::uint32_t>(std::clamp(cell, 0.0, static_cast<double>(cells - 1)));
+}
+
+std::uint64_t clusterKey(NationId nation, std::uint32_t x, std::uint32_t y) {
+    return (static_cast<std::uint64_t>(nation) << 48) | (static_cast<std::uint64_t>(x) << 24) | y;
+}
+} // namespace
+
+//----- Units -----
+
+void MarkerClusters::reset(int minZoom, int maxZoom, std::size_t categoryCount) {
+    zoomMax = std::clamp(maxZoom, 0, kMaxZoomLimit);
+    zoomMin = std::clamp(minZoom, 0, zoomMax);
+    categories = std::max<std::size_t>(1, categoryCount);
+    levels.assign(static_cast<std::size_t>(zoomMax - zoomMin + 1), Level{});
+    nations.clear();
+    unitCategories.clear();
+    lats.clear();
+    lngs.clear();
+    cellXs.clear();
+    cellYs.clear();
+    unitSlots.clear();
+}
+
+void MarkerClusters::cellOf(float lat, float lng, std::uint32_t& x, std::uint32_t& y) const {
+    std::uint32_t cells = cellsAt(zoomMax);
+    x = cellIndex(mercatorX(lng), cells);
+    y = cellIndex(mercatorY(lat), cells);
+}
+
+std::uint32_t MarkerClusters::add(NationId nation, std::uint16_t category, float lat, float lng) {
+    category = static_cast<std::uint16_t>(std::min<std::size_t>(category, categories - 1));
+    std::uint32_t x, y;
+    cellOf(lat, lng, x, y);
+    std::uint32_t unit = static_cast<std::uint32_t>(nations.size());
+    nations.push_back(nation);
+    unitCategories.push_back(category);
+    lats.push_back(lat);
+    lngs.push_back(lng);
+    cellXs.push_back(x);
+    cellYs.push_back(y);
+    const std::size_t n = levels.size();
+    for (std::size_t level = 0; level < n; ++level) {
+        int shift = static_cast<int>(n - 1 - level);
+        unitSlots.push_back(attach(levels[level], clusterKey(nation, x >> shift, y >> shift), lat, lng, category));
+    }
+    return unit;
+}
+
+void MarkerClusters::move(std::uint32_t unit, float lat, float lng) {
+    std::uint32_t x, y;
+    cellOf(lat, lng, x, y);
+    const float oldLat = lats[unit], oldLng = lngs[unit];
+    const std::uint32_t oldX = cellXs[unit], oldY = cellYs[unit];
+    const NationId nation = nations[unit];
+    const std::uint16_t category = unitCategories[unit];
+    const std::size_t n = levels.size();
+    std::uint32_t* slots = &unitSlots[unit * n];
+
+    // Finest levels first: re-home the unit while its cell differs. Once a level keeps its cell,
+    // every coarser one does too, and only the centroid sums shift.
+    std::size_t level = n;
+    for (; level > 0; --level) {
+        int shift = static_cast<int>(n - level);
+        if ((x >> shift) == (oldX >> shift) && (y >> shift) == (oldY >> shift)) break;
+        Level& grid = levels[level - 1];
+        detach(grid, slots[level - 1], oldLat, oldLng, category);
+        slots[level - 1] = attach(grid, clusterKey(nation, x >> shift, y >> shift), lat, lng, category);
+    }
+    const double dLat = static_cast<double>(lat) - oldLat, dLng = static_cast<double>(lng) - oldLng;
+    for (; level > 0; --level) {
+        Level& grid = levels[level - 1];
+        grid.sumLat[slots[level - 1]] += dLat;
+        grid.sumLng[slots[level - 1]] += dLng;
+    }
+    lats[unit] = lat;
+    lngs[unit] = lng;
+    cellXs[unit] = x;
+    cellYs[unit] = y;
+}
+
+std::size_t MarkerClusters::sync(const float* latColumn, const float* lngColumn, std::size_t count) {
+    const std::size_t n = std::min(count, size());
+    std::size_t moved = 0;
+    for (std::size_t unit = 0; unit < n; ++unit) {
+        if (latColumn[unit] == lats[unit] && lngColumn[unit] == lngs[unit]) continue;
+        move(static_cast<std::uint32_t>(unit), latColumn[unit], lngColumn[unit]);
+        ++moved;
+    }
+    return moved;
+}
+
+//----- Slot Table -----
+
+std::size_t MarkerClusters::SlotTable::home(std::uint64_t key) const {
+    // Fibonacci hashing spreads the packed (nation, x, y) bits over the power-of-two table.
+    return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & (keys.size() - 1);
+}
+
+std::uint32_t MarkerClusters::SlotTable::find(std::uint64_t key) const {
+    if (keys.empty()) return kNoSlot;
+    const std::size_t mask = keys.size() - 1;
+    for (std::size_t i = home(key);; i = (i + 1) & mask) {
+        if (keys[i] == key) return slots[i];
+        if (keys[i] == kEmpty) return kNoSlot;
+    }
+}
+
+void MarkerClusters::SlotTable::insert(std::uint64_t key, std::uint32_t slot) {
+    if (2 * (used + 1) > keys.size()) grow();       // Keep the load at or under one half.
+    const std::size_t mask = keys.size() - 1;
+    std::size_t i = home(key);
+    while (keys[i] != kEmpty) i = (i + 1) & mask;
+    keys[i] = key;
+    slots[i] = slot;
+    ++used;
+}
+
+void MarkerClusters::SlotTable::erase(std::uint64_t key) {
+    const std::size_t mask = keys.size() - 1;
+    std::size_t hole = home(key);
+    while (keys[hole] != key) hole = (hole + 1) & mask;
+    // Backward shift: pull later entries of the run into the hole unless that would move them
+    // in front of their home position.
+    for (std::size_t next = (hole + 1) & mask; keys[next] != kEmpty; next = (next + 1) & mask) {
+        std::size_t want = home(keys[next]);
+        if (((next - want) & mask) < ((next - hole) & mask)) continue;
+        keys[hole] = keys[next];
+        slots[hole] = slots[next];
+        hole = next;
+    }
+    keys[hole] = kEmpty;
+    --used;
+}
+
+void MarkerClusters::SlotTable::grow() {
+    std::vector<std::uint64_t> oldKeys(std::max<std::size_t>(64, keys.size() * 2), kEmpty);
+    std::vector<std::uint32_t> oldSlots(oldKeys.size());
+    oldKeys.swap(keys);
+    oldSlots.swap(slots);
+    used = 0;
+    for (std::size_t i = 0; i < oldKeys.size(); ++i)
+        if (oldKeys[i] != kEmpty) insert(oldKeys[i], oldSlots[i]);
+}
+
+//----- Clusters -----
+
+std::uint32_t MarkerClusters::attach(Level& level, std::uint64_t key, float lat, float lng, std::uint16_t category) {
+    std::uint32_t slot = level.slots.find(key);
+    if (slot == kNoSlot) {
+        if (!level.freeSlots.empty()) {
+            slot = level.freeSlots.back();
+            level.freeSlots.pop_back();
+            level.sumLat[slot] = level.sumLng[slot] = 0.0;
+        } else {
+            slot = static_cast<std::uint32_t>(level.keys.size());
+            level.keys.push_back(0);
+            level.counts.push_back(0);
+            level.sumLat.push_back(0.0);
+            level.sumLng.push_back(0.0);
+            level.histogram.resize(level.histogram.size() + categories, 0);
+        }
+        level.keys[slot] = key;
+        level.slots.insert(key, slot);
+    }
+    ++level.counts[slot];
+    level.sumLat[slot] += lat;
+    level.sumLng[slot] += lng;
+    ++level.histogram[slot * categories + category];
+    return slot;
+}
+
+void MarkerClusters::detach(Level& level, std::uint32_t slot, float lat, float lng, std::uint16_t category) {
+    --level.histogram[slot * categories + category];
+    level.sumLat[slot] -= lat;
+    level.sumLng[slot] -= lng;
+    if (--level.counts[slot] > 0) return;
+    // Emptied: the histogram row is all zero again, ready for the next cluster in this slot.
+    level.slots.erase(level.keys[slot]);
+    level.freeSlots.push_back(slot);
+}
+
+std::size_t MarkerClusters::clusterCount(int zoom) const {
+    if (levels.empty() || zoom < zoomMin || zoom > zoomMax) return 0;
+    return levels[static_cast<std::size_t>(zoom - zoomMin)].slots.size();
+}
+
+std::size_t MarkerClusters::query(int zoom, double south, double west, double north, double east,
+                                  std::vector<MarkerCluster>& out, NationId nation) const {
+    if (levels.empty()) return 0;
+    zoom = std::clamp(zoom, zoomMin, zoomMax);
+    const Level& level = levels[static_cast<std::size_t>(zoom - zoomMin)];
+    const std::uint32_t cells = cellsAt(zoom);
+    const std::uint32_t top = cellIndex(mercatorY(north), cells), bottom = cellIndex(mercatorY(south), cells);
+    // Column range; a view across the date line wraps into two ranges (left > right). The east
+    // edge is measured from the west one so that 180 stays the right edge of the map.
+    std::uint32_t left = 0, right = cells - 1;
+    double span = (east >= west ? east - west : east + 360.0 - west) / 360.0;
+    if (span < 1.0) {
+        double x = mercatorX(west);
+        left = cellIndex(x, cells);
+        right = cellIndex(x + span > 1.0 ? x + span - 1.0 : x + span, cells);
+    }
+    const bool wraps = left > right;
+
+    const std::size_t before = out.size();
+    for (std::size_t slot = 0; slot < level.keys.size(); ++slot) {
+        if (level.counts[slot] == 0) continue;
+        const std::uint64_t key = level.keys[slot];
+        const NationId owner = static_cast<NationId>(key >> 48);
+        const std::uint32_t x = static_cast<std::uint32_t>(key >> 24) & 0xFFFFFFu;
+        const std::uint32_t y = static_cast<std::uint32_t>(key) & 0xFFFFFFu;
+        if (nation != kNoNation && owner != nation) continue;
+        if (y < top || y > bottom) continue;
+        if (wraps ? (x < left && x > right) : (x < left || x > right)) continue;
+        const std::uint32_t* row = &level.histogram[slot * categories];
+        const std::uint32_t count = level.counts[slot];
+        MarkerCluster cluster;
+        cluster.lat = static_cast<float>(level.sumLat[slot] / count);
+        cluster.lng = static_cast<float>(level.sumLng[slot] / count);
+        cluster.count = count;
+        cluster.nation = owner;
+        cluster.category = static_cast<std::uint16_t>(std::max_element(row, row + categories) - row);
+        out.push_back(cluster);
+    }
+    return out.size() - before;
+}
+
+//----- Viewport Export -----
+
+void MarkerClusters::requestViewport(int zoom, double south, double west, double north, double east) {
+    // The bounds are separate atomics; a view torn by a concurrent request is replaced by the next one.
+    viewSouth.store(static_cast<float>(south), std::memory_order_relaxed);
+    viewWest.store(static_cast<float>(west), std::memory_order_relaxed);
+    viewNorth.store(static_cast<float>(north), std::memory_order_relaxed);
+    viewEast.store(static_cast<float>(east), std::memory_order_relaxed);
+    viewZoom.store(std::max(0, zoom), std::memory_order_release);
+}
+
+bool MarkerClusters::publishViewport() {
+    int zoom = viewZoom.load(std::memory_order_acquire);
+    if (zoom < 0) return false;
+    std::vector<MarkerCluster>& frame = frames[back];
+    frame.clear();
+    query(zoom, viewSouth.load(std::memory_order_relaxed), viewWest.load(std::memory_order_relaxed),
+          viewNorth.load(std::memory_order_relaxed), viewEast.load(std::memory_order_relaxed), frame);
+    back = middle.exchange(back | kFresh, std::memory_order_acq_rel) & ~kFresh;
+    return true;
+}
+
+const std::vector<MarkerCluster>& MarkerClusters::acquire() {
+    if (middle.load(std::memory_order_acquire) & kFresh)
+        front = middle.exchange(front, std::memory_order_acq_rel) & ~kFresh;
+    return frames[front];
+}
+
+#ifdef __EMSCRIPTEN__
+extern "C" EMSCRIPTEN_KEEPALIVE void markerClustersView(MarkerClusters* clusters, int zoom, double south, double west,
+                                                        double north, double east) {
+    clusters->requestViewport(zoom, south, west, north, east);
+}
+
+extern "C" EMSCRIPTEN_KEEPALIVE const MarkerCluster* markerClustersAcquire(MarkerClusters* clusters, std::uint32_t* count) {
+    const std::vector<MarkerCluster>& frame = clusters->acquire();
+    *count = static_cast<std::uint32_t>(frame.size());
+    return frame.data();
+}
+
+void MarkerClusters::exposeToPage(const std::vector<std::string>& categoryNames) {
+    // Frames are read straight from the heap: lat, lng (f32), count (u32), nation, category (u16).
+    MAIN_THREAD_EM_ASM({
+        var clusters = $0;
+        var countPtr = _malloc(4);
+        var api = {};
+        api.categories = [];
+        api.view = function(zoom, south, west, north, east) {
+            Module._markerClustersView(clusters, zoom, south, west, north, east);
+        };
+        api.frame = function() {
+            var ptr = Module._markerClustersAcquire(clusters, countPtr);
+            var count = HEAPU32[countPtr >> 2];
+            var out = new Array(count);
+            for (var i = 0; i < count; ++i) {
+                var f = (ptr >> 2) + i * 4;
+                var h = (ptr >> 1) + i * 8;
+                var cluster = {};
+                cluster.lat = HEAPF32[f];
+                cluster.lng = HEAPF32[f + 1];
+                cluster.count = HEAPU32[f + 2];
+                cluster.nation = HEAPU16[h + 6];
+                cluster.category = HEAPU16[h + 7];
+                out[i] = cluster;
+            }
+            return out;
+        };
+        Module.markerClusters = api;
+    }, this);
+    for (const std::string& name : categoryNames)
+        MAIN_THREAD_EM_ASM({ Module.markerClusters.categories.push(UTF8ToString($0)); }, name.c_str());
+}
+#else
+void MarkerClusters::exposeToPage(const std::vector<std::string>& categoryNames) {
+    (void)categoryNames;            // No page to talk to natively.
+}
+#endif
+
+// Standalone Testing Block (Compile with -DMARKER_CLUSTERS_TEST)
+// 100k units in war-front blobs: every zoom level must match clusters rebuilt from scratch (counts,
+// centroids, dominant category) after incremental moves, and viewport queries across the date line
+// and through the triple buffer must return the same clusters as a direct filter.
+//   g++ -std=c++17 -O2 -DMARKER_CLUSTERS_TEST marker_clusters.cpp -o marker_clusters
+#ifdef MARKER_CLUSTERS_TEST
+#include <chrono>
+#include <random>
+#include <tuple>
+
+namespace {
+// Whole-world query in a fixed order, for comparing two cluster sets.
+std::vector<MarkerCluster> snapshot(const MarkerClusters& clusters, int zoom) {
+    std::vector<MarkerCluster> all;
+    clusters.query(zoom, -90.0, -180.0, 90.0, 180.0, all);
+    std::sort(all.begin(), all.end(), [](const MarkerCluster& a, const MarkerCluster& b) {
+        return std::tie(a.nation, a.lat, a.lng) < std::tie(b.nation, b.lat, b.lng);
+    });
+    return all;
+}
+
+// Same clusters, with centroids equal up to the rounding of incremental sums.
+bool same(const std::vector<MarkerCluster>& a, const std::vector<MarkerCluster>& b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i].nation != b[i].nation || a[i].count != b[i].count || a[i].category != b[i].category) return false;
+        if (std::fabs(a[i].lat - b[i].lat) > 1e-3f || std::fabs(a[i].lng - b[i].lng) > 1e-3f) return false;
+    }
+    return true;
+}
+} // namespace
+
+int main() {
+    const std::size_t units = 100000, categories = 12;
+    const NationId nationCount = 40;
+    std::mt19937 rng(74);
+    std::uniform_real_distribution<float> latDist(-60.0f, 70.0f), lngDist(-180.0f, 179.99f), unit01(0.0f, 1.0f);
+    std::normal_distribution<float> spread(0.0f, 2.0f);
+    // Each nation musters around a few fronts, so coarse zooms collapse and fine zooms stay crowded.
+    std::vector<float> lats(units), lngs(units);
+    std::vector<NationId> owners(units);
+    std::vector<std::uint16_t> kinds(units);
+    std::vector<std::pair<float, float>> fronts(nationCount * 4);
+    for (auto& front : fronts) front = {latDist(rng), lngDist(rng)};
+    for (std::size_t i = 0; i < units; ++i) {
+        owners[i] = static_cast<NationId>(rng() % nationCount);
+        const auto& front = fronts[owners[i] * 4 + rng() % 4];
+        lats[i] = std::clamp(front.first + spread(rng), -80.0f, 80.0f);
+        lngs[i] = front.second + spread(rng);
+        lngs[i] -= 360.0f * std::floor((lngs[i] + 180.0f) / 360.0f);
+        kinds[i] = static_cast<std::uint16_t>(std::min<float>(categories - 1, categories * unit01(rng) * unit01(rng)));
+    }
+
+    int failures = 0;
+    MarkerClusters clusters;
+    clusters.reset(0, 14, categories);
+    auto t0 = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < units; ++i) clusters.add(owners[i], kinds[i], lats[i], lngs[i]);
+    double addMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    // A march: a third of the units step a little (most stay in their cell), a few jump far.
+    double syncMs = 0.0;
+    std::size_t moved = 0;
+    for (int round = 0; round < 10; ++round) {
+        for (std::size_t i = 0; i < units; ++i) {
+            float roll = unit01(rng);
+            if (roll < 0.3f) {
+                lats[i] = std::clamp(lats[i] + 0.02f * spread(rng), -80.0f, 80.0f);
+                lngs[i] = std::clamp(lngs[i] + 0.02f * spread(rng), -180.0f, 179.99f);
+            } else if (roll < 0.31f) {
+                lats[i] = latDist(rng);
+                lngs[i] = lngDist(rng);
+            }
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        moved += clusters.sync(lats.data(), lngs.data(), units);
+        syncMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t1).count();
+    }
+
+    MarkerClusters fresh;
+    fresh.reset(0, 14, categories);
+    for (std::size_t i = 0; i < units; ++i) fresh.add(owners[i], kinds[i], lats[i], lngs[i]);
+    for (int zoom = 0; zoom <= 14; ++zoom) {
+        std::vector<MarkerCluster> a = snapshot(clusters, zoom), b = snapshot(fresh, zoom);
+        std::uint64_t total = 0;
+        for (const MarkerCluster& c : a) total += c.count;
+        failures += !same(a, b) || total != units || clusters.clusterCount(zoom) != fresh.clusterCount(zoom);
+        if (zoom % 2 == 0)
+            std::cout << "zoom " << zoom << ": " << clusters.clusterCount(zoom) << " clusters\n";
+    }
+
+    // Viewports: a Pacific view across the date line (west > east) equals the two halves queried
+    // separately; one nation's view only holds that nation.
+    std::vector<MarkerCluster> across, halves, mine;
+    clusters.query(5, -20.0, 170.0, 20.0, -170.0, across);
+    clusters.query(5, -20.0, 170.0, 20.0, 180.0, halves);
+    clusters.query(5, -20.0, -180.0, 20.0, -170.0, halves);
+    failures += across.size() != halves.size();
+    clusters.query(3, -90.0, -180.0, 90.0, 180.0, mine, 7);
+    for (const MarkerCluster& c : mine) failures += c.nation != 7;
+
+    // Triple buffer: nothing before a view is requested; afterwards the newest published frame.
+    failures += clusters.publishViewport() || !clusters.acquire().empty();
+    std::vector<MarkerCluster> europe;
+    clusters.query(6, 35.0, -10.0, 60.0, 30.0, europe);
+    clusters.requestViewport(6, 35.0, -10.0, 60.0, 30.0);
+    auto t2 = std::chrono::steady_clock::now();
+    failures += !clusters.publishViewport();
+    double publishMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t2).count();
+    failures += clusters.acquire().size() != europe.size();
+    clusters.requestViewport(2, -90.0, -180.0, 90.0, 180.0);
+    failures += clusters.acquire().size() != europe.size();     // Not published yet: same frame.
+    clusters.publishViewport();
+    clusters.publishViewport();
+    failures += clusters.acquire().size() != clusters.clusterCount(2);
+
+    std::cout << "add " << units << " units: " << addMs << " ms; 10 syncs moved " << moved << " in " << syncMs
+              << " ms; publish " << europe.size() << " clusters: " << publishMs << " ms\n";
+    std::cout << "failures: " << failures << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+// End of marker_clusters.cpp
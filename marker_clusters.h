@@ -0,0 +1,135 @@
+/**************************************************************************************************
+ * marker_clusters.h
+ * Engine-Side Marker Clustering for Conqueror Engine (Header)
+ *
+ * Leaflet falls over long before 100k unit markers, so the map draws clusters instead and the
+ * engine keeps them current. Every Leaflet zoom level in [minZoom, maxZoom] has a grid of
+ * kCellPixels-wide web-mercator cells; a cluster is the units of one nation inside one cell, with
+ * their count, position sums (for the centroid) and a per-category histogram (for the dominant
+ * category). Cells at zoom z split exactly into four at z + 1, so the levels nest: a unit that
+ * moves only updates the sums of its clusters until it crosses a cell edge, and then only the
+ * levels whose cell actually changed (the finest ones) re-home it.
+ *
+ * The map asks for a viewport from the browser thread (requestViewport); the engine thread answers
+ * after each sync (publishViewport) into a triple buffer, and the page picks up the newest frame
+ * with acquire() without ever blocking the tick.
+ *
+ * Exposed Types:
+ * - MarkerCluster
+ * - MarkerClusters
+ **************************************************************************************************/
+
+#ifndef MARKER_CLUSTERS_H
+#define MARKER_CLUSTERS_H
+
+#include "nations.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One drawn marker. Plain 16-byte layout; the page reads frames straight out of the wasm heap.
+struct MarkerCluster {
+    float lat, lng;                 // Centroid of the members.
+    std::uint32_t count;
+    NationId nation;
+    std::uint16_t category;         // Most common member category (lowest index on ties).
+};
+
+//-------------------------------------------------
+// Marker Clusters
+//-------------------------------------------------
+class MarkerClusters {
+public:
+    static constexpr int kCellPixels = 64;          // Cluster cell edge in screen pixels (power of two).
+    static constexpr int kMaxZoomLimit = 20;        // Cell coordinates must fit 24 bits.
+
+    // Drops every unit and sets the zoom range and the number of unit categories.
+    void reset(int minZoom, int maxZoom, std::size_t categoryCount);
+
+    // Registers a unit and returns its index (units are numbered 0, 1, ... in add order).
+    std::uint32_t add(NationId nation, std::uint16_t category, float lat, float lng);
+    void move(std::uint32_t unit, float lat, float lng);
+    // Moves every unit in [0, count) whose position differs from the columns. Returns the number moved.
+    std::size_t sync(const float* lats, const float* lngs, std::size_t count);
+
+    std::size_t size() const { return nations.size(); }
+    int minZoom() const { return zoomMin; }
+    int maxZoom() const { return zoomMax; }
+    std::size_t clusterCount(int zoom) const;
+
+    /**
+     * @brief Appends the clusters of `zoom` whose cell overlaps the viewport (degrees). West may be
+     *        greater than east when the view crosses the date line.
+     * @param nation Only that nation's clusters, or every nation with kNoNation.
+     * @return Number appended.
+     */
+    std::size_t query(int zoom, double south, double west, double north, double east,
+                      std::vector<MarkerCluster>& out, NationId nation = kNoNation) const;
+
+    // Browser side: the view to answer next. Safe from any thread.
+    void requestViewport(int zoom, double south, double west, double north, double east);
+    // Engine side: answers the latest requested view into a fresh frame. False if none was requested.
+    bool publishViewport();
+    // Browser side: the newest published frame (empty before the first publish).
+    const std::vector<MarkerCluster>& acquire();
+    // Installs Module.markerClusters (view / frame / categories) on the page; a no-op natively.
+    void exposeToPage(const std::vector<std::string>& categoryNames);
+
+private:
+    // Cluster key -> slot, open addressing with linear probing and backward-shift erase. Units cross
+    // fine cells on most ticks, so the table must not allocate per insert or erase.
+    struct SlotTable {
+        static constexpr std::uint64_t kEmpty = ~std::uint64_t(0);
+        std::vector<std::uint64_t> keys;
+        std::vector<std::uint32_t> slots;
+        std::size_t used = 0;
+
+        std::uint32_t find(std::uint64_t key) const;    // kNoSlot when absent.
+        void insert(std::uint64_t key, std::uint32_t slot);
+        void erase(std::uint64_t key);
+        std::size_t size() const { return used; }
+    private:
+        std::size_t home(std::uint64_t key) const;
+        void grow();
+    };
+    static constexpr std::uint32_t kNoSlot = 0xFFFFFFFFu;
+
+    // One zoom level: clusters keyed by (nation, cell x, cell y), stored in slots reused via a free list.
+    struct Level {
+        SlotTable slots;
+        std::vector<std::uint64_t> keys;
+        std::vector<std::uint32_t> counts;
+        std::vector<double> sumLat, sumLng;
+        std::vector<std::uint32_t> histogram;       // [slot * categories + category]
+        std::vector<std::uint32_t> freeSlots;
+    };
+
+    int zoomMin = 0, zoomMax = -1;
+    std::size_t categories = 0;
+    std::vector<Level> levels;                      // levels[z - zoomMin]
+
+    // Per unit: owner, category, last synced position, finest-level cell and its slot on every level.
+    std::vector<NationId> nations;
+    std::vector<std::uint16_t> unitCategories;
+    std::vector<float> lats, lngs;
+    std::vector<std::uint32_t> cellXs, cellYs;
+    std::vector<std::uint32_t> unitSlots;           // [unit * levels.size() + level]
+
+    // Triple buffer: the engine fills frames[back], swaps it into `middle` (with kFresh set), and
+    // the reader swaps a fresh middle for its frames[front].
+    static constexpr std::uint32_t kFresh = 4;
+    std::vector<MarkerCluster> frames[3];
+    std::uint32_t back = 0, front = 2;
+    std::atomic<std::uint32_t> middle{1};
+    std::atomic<int> viewZoom{-1};                  // -1 until the page asks for a view.
+    std::atomic<float> viewSouth{0.0f}, viewWest{0.0f}, viewNorth{0.0f}, viewEast{0.0f};
+
+    void cellOf(float lat, float lng, std::uint32_t& x, std::uint32_t& y) const;
+    std::uint32_t attach(Level& level, std::uint64_t key, float lat, float lng, std::uint16_t category);
+    void detach(Level& level, std::uint32_t slot, float lat, float lng, std::uint16_t category);
+};
+
+#endif // MARKER_CLUSTERS_H
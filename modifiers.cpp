@@ -0,0 +1,227 @@
+/*
+ * modifiers.cpp - Per-nation, per-stat modifier stacks with cached folded products.
+ */
+
+#include "modifiers.h"
+
+#include <iostream>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#endif
+
+namespace {
+
+struct DoctrineModifier { ModifierStat stat; float factor; };
+struct DoctrineDefinition { const char* name; DoctrineModifier modifiers[2]; };
+
+// The doctrine catalog from doctrine.js.
+const DoctrineDefinition kDoctrines[] = {
+    {"Economic Expansion", {{ModifierStat::DailyIncome, 1.2f}, {ModifierStat::TreasuryGrowth, 1.1f}}},
+    {"Military Innovation", {{ModifierStat::UnitCost, 0.9f}, {ModifierStat::CombatEffectiveness, 1.15f}}},
+    {"Infrastructure Modernization", {{ModifierStat::InfrastructureEfficiency, 1.3f}, {ModifierStat::DailyIncome, 1.1f}}},
+    {"Diplomatic Engagement", {{ModifierStat::DiplomacyBonus, 1.2f}, {ModifierStat::WarCost, 0.85f}}},
+    {"Cyber Warfare", {{ModifierStat::EnemyDisruption, 1.25f}, {ModifierStat::UnitSurveillance, 1.2f}}},
+};
+
+const char* const kStatKeys[kModifierStatCount] = {
+    "dailyIncomeMultiplier", "treasuryGrowth", "unitCostReduction", "combatEffectiveness",
+    "infrastructureEfficiency", "diplomacyBonus", "warCostReduction", "enemyDisruption", "unitSurveillance"
+};
+
+} // namespace
+
+void ModifierStacks::reset(std::size_t nationCount) {
+    nations = nationCount;
+    live = 0;
+    pool.clear();
+    freeIds.clear();
+    heads.assign(nations * kModifierStatCount, kNoModifier);
+    products.assign(nations * kModifierStatCount, 1.0f);
+}
+
+bool ModifierStacks::statFromKey(const std::string& key, ModifierStat& stat) {
+    for (int i = 0; i < kModifierStatCount; ++i) {
+        if (key == kStatKeys[i]) {
+            stat = static_cast<ModifierStat>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ModifierStacks::refold(std::size_t stack) {
+    float product = 1.0f;
+    for (ModifierId id = heads[stack]; id != kNoModifier; id = pool[id].next) product *= pool[id].factor;
+    products[stack] = product;
+}
+
+ModifierId ModifierStacks::add(NationId nation, ModifierStat stat, double factor, ModifierSource source,
+                               std::uint32_t sourceKey) {
+    if (nation >= nations) return kNoModifier;
+    ModifierId id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        id = static_cast<ModifierId>(pool.size());
+        pool.emplace_back();
+    }
+    std::size_t stack = stackIndex(nation, stat);
+    pool[id] = Modifier{static_cast<float>(factor), nation, stat, source, true, sourceKey, kNoModifier, heads[stack]};
+    if (heads[stack] != kNoModifier) pool[heads[stack]].prev = id;
+    heads[stack] = id;
+    ++live;
+    // Pushing onto a stack only scales its product; no walk needed.
+    products[stack] *= static_cast<float>(factor);
+    return id;
+}
+
+bool ModifierStacks::remove(ModifierId id) {
+    if (id >= pool.size() || !pool[id].live) return false;
+    Modifier& m = pool[id];
+    std::size_t stack = stackIndex(m.nation, m.stat);
+    if (m.prev != kNoModifier) pool[m.prev].next = m.next;
+    else heads[stack] = m.next;
+    if (m.next != kNoModifier) pool[m.next].prev = m.prev;
+    m.live = false;
+    freeIds.push_back(id);
+    --live;
+    // Refold rather than divide, so repeated add/remove cycles do not accumulate rounding error.
+    refold(stack);
+    return true;
+}
+
+std::size_t ModifierStacks::removeSource(NationId nation, ModifierSource source, std::uint32_t sourceKey) {
+    if (nation >= nations) return 0;
+    std::size_t removed = 0;
+    for (int stat = 0; stat < kModifierStatCount; ++stat) {
+        ModifierId id = heads[stackIndex(nation, static_cast<ModifierStat>(stat))];
+        while (id != kNoModifier) {
+            ModifierId next = pool[id].next;
+            if (pool[id].source == source && pool[id].sourceKey == sourceKey) removed += remove(id);
+            id = next;
+        }
+    }
+    return removed;
+}
+
+std::size_t ModifierStacks::removeSource(NationId nation, ModifierSource source) {
+    if (nation >= nations) return 0;
+    std::size_t removed = 0;
+    for (int stat = 0; stat < kModifierStatCount; ++stat) {
+        ModifierId id = heads[stackIndex(nation, static_cast<ModifierStat>(stat))];
+        while (id != kNoModifier) {
+            ModifierId next = pool[id].next;
+            if (pool[id].source == source) removed += remove(id);
+            id = next;
+        }
+    }
+    return removed;
+}
+
+bool ModifierStacks::applyDoctrine(NationId nation, const std::string& doctrineName) {
+    if (nation >= nations) return false;
+    for (std::uint32_t d = 0; d < sizeof(kDoctrines) / sizeof(kDoctrines[0]); ++d) {
+        if (doctrineName != kDoctrines[d].name) continue;
+        // A nation follows one doctrine at a time, as in applyDoctrine() in doctrine.js.
+        removeSource(nation, ModifierSource::Doctrine);
+        for (const DoctrineModifier& m : kDoctrines[d].modifiers)
+            add(nation, m.stat, m.factor, ModifierSource::Doctrine, d);
+        return true;
+    }
+    return false;
+}
+
+std::size_t ModifierStacks::stackDepth(NationId nation, ModifierStat stat) const {
+    if (nation >= nations) return 0;
+    std::size_t depth = 0;
+    for (ModifierId id = heads[stackIndex(nation, stat)]; id != kNoModifier; id = pool[id].next) ++depth;
+    return depth;
+}
+
+// -------------------------------------------------
+#ifdef __EMSCRIPTEN__
+extern "C" EMSCRIPTEN_KEEPALIVE int modifiersApplyDoctrine(ModifierStacks* stacks, const NationRegistry* registry,
+                                                           const char* nation, const char* doctrineName) {
+    NationId id = registry->find(nation);
+    return id != kNoNation && stacks->applyDoctrine(id, doctrineName) ? 1 : 0;
+}
+
+void ModifierStacks::exposeToPage(const NationRegistry& registry) {
+    MAIN_THREAD_EM_ASM({
+        var stacks = $0;
+        var registry = $1;
+        var api = {};
+        api.apply = function(nation, doctrineName) {
+            var nationBytes = lengthBytesUTF8(nation) + 1;
+            var nameBytes = lengthBytesUTF8(doctrineName) + 1;
+            var nationPtr = _malloc(nationBytes);
+            var namePtr = _malloc(nameBytes);
+            stringToUTF8(nation, nationPtr, nationBytes);
+            stringToUTF8(doctrineName, namePtr, nameBytes);
+            var applied = Module._modifiersApplyDoctrine(stacks, registry, nationPtr, namePtr) !== 0;
+            _free(namePtr);
+            _free(nationPtr);
+            return applied;
+        };
+        Module.doctrines = api;
+    }, this, &registry);
+}
+#else
+void ModifierStacks::exposeToPage(const NationRegistry& registry) {
+    (void)registry;                 // No page to talk to natively.
+}
+#endif
+
+// Standalone Testing Block (Compile with -DMODIFIERS_TEST)
+// Stacks a doctrine, events and a policy on one nation, then times a per-tick read pass.
+#ifdef MODIFIERS_TEST
+#include <chrono>
+#include <cmath>
+
+int main() {
+    NationRegistry registry;
+    NationId a = registry.intern("A", "NationA");
+    registry.intern("B", "NationB");
+
+    ModifierStacks stacks;
+    stacks.reset(registry.count());
+    int failures = 0;
+    auto expect = [&](const char* label, ModifierStat stat, float value) {
+        float got = stacks.multiplier(a, stat);
+        bool ok = std::fabs(got - value) < 1e-5f;
+        failures += !ok;
+        std::cout << label << ": " << got << (ok ? "" : "  [UNEXPECTED]") << std::endl;
+    };
+
+    stacks.applyDoctrine(a, "Infrastructure Modernization");
+    expect("Income after doctrine", ModifierStat::DailyIncome, 1.1f);
+    stacks.add(a, ModifierStat::DailyIncome, 0.85, ModifierSource::Event, 17);     // Recession.
+    stacks.add(a, ModifierStat::DailyIncome, 1.05, ModifierSource::Policy, 2);
+    expect("Income with recession and policy", ModifierStat::DailyIncome, 1.1f * 0.85f * 1.05f);
+    stacks.removeSource(a, ModifierSource::Event, 17);
+    expect("Income after recession ends", ModifierStat::DailyIncome, 1.1f * 1.05f);
+    stacks.applyDoctrine(a, "Military Innovation");
+    expect("Income after doctrine change", ModifierStat::DailyIncome, 1.05f);
+    expect("Combat after doctrine change", ModifierStat::CombatEffectiveness, 1.15f);
+
+    // Per-tick cost: 200 nations, 8 stacked modifiers each, income read as one column.
+    stacks.reset(200);
+    for (NationId n = 0; n < 200; ++n)
+        for (std::uint32_t k = 0; k < 8; ++k)
+            stacks.add(n, ModifierStat::DailyIncome, 0.95 + 0.01 * k, ModifierSource::Event, k);
+    std::vector<double> income(200, 100.0);
+    auto t0 = std::chrono::steady_clock::now();
+    const int ticks = 100000;
+    for (int t = 0; t < ticks; ++t) {
+        const float* factor = stacks.column(ModifierStat::DailyIncome);
+        for (std::size_t n = 0; n < income.size(); ++n) income[n] += 0.001 * factor[n];
+    }
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "Income pass over 200 nations: " << us / ticks << " us/tick (checksum " << income[7] << ")" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+// End of modifiers.cpp
@@ -0,0 +1,122 @@
+/**************************************************************************************************
+ * modifiers.h
+ * Aggregated Modifier Stacks for Conqueror Engine (Header)
+ *
+ * Events (events.h), doctrines (doctrine.js) and government policies all scale the same handful of
+ * per-nation stats. Each (nation, stat) pair keeps a small linked stack of multiplicative
+ * modifiers, and the folded product of that stack is cached in a stat-major array. The product is
+ * refolded only when a modifier is added or removed, so combat and economy ticks read a single
+ * float (or a contiguous per-stat column across all nations) instead of walking effect lists.
+ *
+ * Modifiers are tagged with their source and a source key (event handle, doctrine index, policy
+ * id), so an expiring event or a replaced doctrine removes exactly the modifiers it contributed.
+ *
+ * Exposed Types:
+ * - ModifierStat / ModifierSource / ModifierId
+ * - ModifierStacks
+ **************************************************************************************************/
+
+#ifndef MODIFIERS_H
+#define MODIFIERS_H
+
+#include "nations.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//-------------------------------------------------
+// Stats that modifiers scale (doctrine.js modifier keys)
+//-------------------------------------------------
+enum class ModifierStat : std::uint8_t {
+    DailyIncome = 0,            // dailyIncomeMultiplier
+    TreasuryGrowth,             // treasuryGrowth
+    UnitCost,                   // unitCostReduction
+    CombatEffectiveness,        // combatEffectiveness
+    InfrastructureEfficiency,   // infrastructureEfficiency
+    DiplomacyBonus,             // diplomacyBonus
+    WarCost,                    // warCostReduction
+    EnemyDisruption,            // enemyDisruption
+    UnitSurveillance            // unitSurveillance
+};
+constexpr int kModifierStatCount = 9;
+
+enum class ModifierSource : std::uint8_t {
+    Event = 0,
+    Doctrine = 1,
+    Policy = 2
+};
+
+using ModifierId = std::uint32_t;
+constexpr ModifierId kNoModifier = 0xFFFFFFFFu;
+
+//-------------------------------------------------
+// Modifier Stacks
+//-------------------------------------------------
+class ModifierStacks {
+public:
+    // Empties every stack; all multipliers read 1.0.
+    void reset(std::size_t nationCount);
+
+    /**
+     * @brief Pushes a multiplicative modifier and refolds that one stack.
+     * @param sourceKey Identifies the contributor within its source (e.g. the event handle).
+     */
+    ModifierId add(NationId nation, ModifierStat stat, double factor, ModifierSource source, std::uint32_t sourceKey);
+
+    bool remove(ModifierId id);
+
+    // Removes every modifier the given contributor placed on a nation. Returns how many were removed.
+    std::size_t removeSource(NationId nation, ModifierSource source, std::uint32_t sourceKey);
+    // Removes every modifier of a source kind from a nation (e.g. the previous doctrine).
+    std::size_t removeSource(NationId nation, ModifierSource source);
+
+    /**
+     * @brief Replaces the nation's doctrine modifiers with those of a doctrine.js doctrine.
+     * @return false if the doctrine name is unknown (existing modifiers are left in place).
+     */
+    bool applyDoctrine(NationId nation, const std::string& doctrineName);
+    // Installs Module.doctrines.apply(nation, doctrineName) on the page, resolving the nation's code
+    // or name through the registry, so doctrine.js adoptions reach these stacks; a no-op natively.
+    void exposeToPage(const NationRegistry& registry);
+
+    // Folded product of one stack; 1.0 for nations outside the table.
+    float multiplier(NationId nation, ModifierStat stat) const {
+        return nation < nations ? products[static_cast<std::size_t>(stat) * nations + nation] : 1.0f;
+    }
+    // Contiguous multipliers of one stat for every nation, for vectorized per-nation passes.
+    const float* column(ModifierStat stat) const { return products.data() + static_cast<std::size_t>(stat) * nations; }
+
+    std::size_t stackDepth(NationId nation, ModifierStat stat) const;
+    std::size_t liveCount() const { return live; }
+    std::size_t nationCount() const { return nations; }
+
+    // Maps a doctrine.js modifier key (e.g. "combatEffectiveness") to its stat.
+    static bool statFromKey(const std::string& key, ModifierStat& stat);
+
+private:
+    struct Modifier {
+        float factor;
+        NationId nation;
+        ModifierStat stat;
+        ModifierSource source;
+        bool live;
+        std::uint32_t sourceKey;
+        ModifierId prev, next;
+    };
+
+    std::size_t nations = 0;
+    std::size_t live = 0;
+    std::vector<Modifier> pool;
+    std::vector<ModifierId> freeIds;
+    std::vector<ModifierId> heads;      // Stat-major: heads[stat * nations + nation].
+    std::vector<float> products;        // Stat-major folded products.
+
+    std::size_t stackIndex(NationId nation, ModifierStat stat) const {
+        return static_cast<std::size_t>(stat) * nations + nation;
+    }
+    void refold(std::size_t stack);
+};
+
+#endif // MODIFIERS_H
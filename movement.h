@@ -0,0 +1,104 @@
+/**************************************************************************************************
+ * movement.h
+ * Lat/Lng Movement Integrator for Conqueror Engine (Header)
+ *
+ * Unit::moveTo in units.cpp assigned the destination outright and logged a line per move. The
+ * MovementSystem instead advances every moving unit along its route each tick at its category's
+ * speed (km/h), in the map's own coordinates (latitude/longitude degrees, as Leaflet uses).
+ *
+ * Each leg of a route is flattened when it starts: its length in km (equirectangular at the leg's
+ * mid-latitude) and a per-km direction in degrees. The per-tick kernel is then a branch-free pass
+ * over SoA float columns (advance = min(speed * hours, remaining)), which the compiler vectorizes;
+ * only units that finished a leg are touched afterwards. moveTo() splits long moves into
+ * great-circle legs of at most kMaxLegKm, so jets and warships follow the globe and the flat leg
+ * stays accurate. Longitudes wrap at the date line.
+ *
+ * The only per-unit output is an arrival event when a unit reaches the end of its route.
+ *
+ * Exposed Types:
+ * - MovementArrival
+ * - MovementSystem
+ **************************************************************************************************/
+
+#ifndef MOVEMENT_H
+#define MOVEMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Simulation clock shared by the engine and the movement speeds: 30 ticks per second at
+// time-engine.js's default 60x acceleration, so one game day is 1440 real seconds.
+constexpr std::uint64_t kTicksPerGameDay = 30 * 1440;
+constexpr float kHoursPerTick = 24.0f / kTicksPerGameDay;
+
+struct MovementArrival {
+    std::uint32_t unit;
+    float lat, lng;
+};
+
+//-------------------------------------------------
+// Movement System
+//-------------------------------------------------
+class MovementSystem {
+public:
+    static constexpr double kMaxLegKm = 500.0;
+
+    // Starts with the speed table for the units.cpp categories.
+    MovementSystem();
+
+    // Speed class by category name; unknown categories are added with the default speed.
+    std::uint16_t category(const std::string& name);
+    // Changes a category's speed for every unit of it, replacing per-unit overrides.
+    void setCategorySpeed(const std::string& name, float kmh);
+    float categorySpeed(std::uint16_t category) const { return categorySpeeds[category]; }
+
+    // Adds a resting unit and returns its id (dense, from 0).
+    std::uint32_t add(std::uint16_t category, float lat, float lng);
+    // Per-unit speed override (km/h), e.g. after modifiers; applies immediately.
+    void setSpeed(std::uint32_t unit, float kmh);
+
+    // Great-circle move to (lat, lng), replacing any current route.
+    void moveTo(std::uint32_t unit, float lat, float lng);
+    // Follows the given (lat, lng) waypoints in order, replacing any current route. A route that
+    // ends where the unit stands finishes at once, without an arrival event.
+    void setRoute(std::uint32_t unit, const std::vector<std::pair<float, float>>& waypoints);
+    void stop(std::uint32_t unit);
+
+    // Advances every moving unit by `hours` of game time.
+    void step(float hours);
+    // Units that reached the end of their route during the last step.
+    const std::vector<MovementArrival>& arrivals() const { return arrived; }
+
+    std::size_t count() const { return lat.size(); }
+    std::size_t movingCount() const { return moving; }
+    float latitude(std::uint32_t unit) const { return lat[unit]; }
+    float longitude(std::uint32_t unit) const { return lng[unit]; }
+    bool isMoving(std::uint32_t unit) const { return active[unit] != 0.0f; }
+    const float* latitudes() const { return lat.data(); }
+    const float* longitudes() const { return lng.data(); }
+
+private:
+    struct Route {
+        std::vector<float> lat, lng;
+        std::uint32_t next = 0;          // Waypoint the current leg ends at.
+    };
+
+    std::vector<std::string> categoryNames;
+    std::vector<float> categorySpeeds;
+
+    // Per unit (SoA). dirLat/dirLng are degrees per km along the current leg.
+    std::vector<float> lat, lng, dirLat, dirLng, remaining, speed, active;
+    std::vector<std::uint8_t> legDone;
+    std::vector<std::uint16_t> categories;
+    std::vector<Route> routes;
+    std::vector<MovementArrival> arrived;
+    std::size_t moving = 0;
+
+    // Sets up the leg to the route's next waypoint; false when the route is finished.
+    bool startLeg(std::uint32_t unit);
+};
+
+#endif // MOVEMENT_H
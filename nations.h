@@ -0,0 +1,80 @@
+/**************************************************************************************************
+ * nations.h
+ * Nation Identity Registry for Conqueror Engine (Header-Only)
+ *
+ * Engine subsystems (territory, diplomacy, economy, AI) index their per-nation data by a small
+ * integer id instead of the nation's name. This header defines that id type and the registry that
+ * interns nation codes/names into ids, so hot paths never compare or hash strings.
+ *
+ * Exposed Types:
+ * - NationId / kNoNation
+ * - RelationStatus
+ * - NationRegistry
+ **************************************************************************************************/
+
+#ifndef NATIONS_H
+#define NATIONS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+//-------------------------------------------------
+// Nation Id
+//-------------------------------------------------
+using NationId = std::uint16_t;
+constexpr NationId kNoNation = 0xFFFF;     // Unclaimed land / open sea.
+
+//-------------------------------------------------
+// Bilateral relationship status (country_relations.py: 'neutral', 'ally', 'at_war')
+//-------------------------------------------------
+enum class RelationStatus : std::uint8_t {
+    Neutral = 0,
+    Ally = 1,
+    AtWar = 2
+};
+
+//-------------------------------------------------
+// Nation Registry
+//-------------------------------------------------
+class NationRegistry {
+public:
+    /**
+     * @brief Returns the id for a nation, registering it on first sight.
+     * @param code Short code (ISO alpha-3 from countries.geo.json, alpha-2 from cities.json).
+     * @param name Display name; may be empty.
+     */
+    NationId intern(const std::string& code, const std::string& name) {
+        NationId existing = find(code);
+        if (existing == kNoNation && !name.empty()) existing = find(name);
+        if (existing != kNoNation) {
+            if (!code.empty()) byKey[code] = existing;
+            if (!name.empty()) byKey[name] = existing;
+            return existing;
+        }
+        NationId id = static_cast<NationId>(codes.size());
+        codes.push_back(code);
+        names.push_back(name.empty() ? code : name);
+        if (!code.empty()) byKey[code] = id;
+        if (!name.empty()) byKey[name] = id;
+        return id;
+    }
+
+    // Looks a nation up by code or name. Returns kNoNation if unknown.
+    NationId find(const std::string& key) const {
+        auto it = byKey.find(key);
+        return it == byKey.end() ? kNoNation : it->second;
+    }
+
+    const std::string& code(NationId id) const { return codes[id]; }
+    const std::string& name(NationId id) const { return names[id]; }
+    std::size_t count() const { return codes.size(); }
+
+private:
+    std::vector<std::string> codes;
+    std::vector<std::string> names;
+    std::unordered_map<std::string, NationId> byKey;
+};
+
+#endif // NATIONS_H
@@ -0,0 +1,82 @@
+/*
+ * passability.cpp - Per-nation enter/capture bitsets derived from diplomatic relationships.
+ */
+
+#include "passability.h"
+
+#include <iostream>
+#include <string>
+
+void PassabilityMasks::reset(std::size_t nationCount) {
+    nations = nationCount;
+    wordsPerNation = (nationCount + 63) / 64;
+    enter.assign(nations * wordsPerNation, 0);
+    capture.assign(nations * wordsPerNation, 0);
+    for (std::size_t n = 0; n < nations; ++n)
+        assign(enter, static_cast<NationId>(n), static_cast<NationId>(n), true);
+}
+
+void PassabilityMasks::assign(std::vector<std::uint64_t>& bits, NationId row, NationId col, bool value) {
+    std::uint64_t& word = bits[row * wordsPerNation + (col >> 6)];
+    std::uint64_t bit = std::uint64_t(1) << (col & 63);
+    word = value ? (word | bit) : (word & ~bit);
+}
+
+void PassabilityMasks::setRelation(NationId a, NationId b, RelationStatus status) {
+    if (a >= nations || b >= nations || a == b) return;
+    bool mayEnter = status != RelationStatus::Neutral;
+    bool mayCapture = status == RelationStatus::AtWar;
+    assign(enter, a, b, mayEnter);
+    assign(enter, b, a, mayEnter);
+    assign(capture, a, b, mayCapture);
+    assign(capture, b, a, mayCapture);
+}
+
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DPASSABILITY_TEST)
+// Mirrors the standalone scenario in country_relations.py.
+#ifdef PASSABILITY_TEST
+int main() {
+    NationRegistry registry;
+    NationId a = registry.intern("A", "NationA");
+    NationId b = registry.intern("B", "NationB");
+    NationId c = registry.intern("C", "NationC");
+
+    PassabilityMasks masks;
+    masks.reset(registry.count());
+    masks.setRelation(a, b, RelationStatus::AtWar);
+    masks.setRelation(a, c, RelationStatus::Ally);
+    masks.setRelation(b, c, RelationStatus::Neutral);
+
+    struct Case { NationId unit, owner; bool enter, capture; };
+    const Case cases[] = {
+        {a, a, true, false},        // Own territory.
+        {a, b, true, true},         // At war.
+        {a, c, true, false},        // Ally: move, no capture.
+        {b, c, false, false},       // Neutral: denied.
+        {b, kNoNation, true, false} // Unclaimed land.
+    };
+    int failures = 0;
+    for (const auto& t : cases) {
+        bool enter = masks.canEnter(t.unit, t.owner);
+        bool capture = masks.canCapture(t.unit, t.owner);
+        bool ok = enter == t.enter && capture == t.capture;
+        failures += !ok;
+        std::cout << registry.name(t.unit) << " -> "
+                  << (t.owner == kNoNation ? std::string("unclaimed") : registry.name(t.owner))
+                  << ": enter=" << enter << " capture=" << capture << (ok ? "" : "  [UNEXPECTED]") << std::endl;
+    }
+
+    // A unit without a nation keeps the open enter mask but may never capture.
+    failures += !masks.canEnter(kNoNation, b) || masks.canCapture(kNoNation, b) || masks.canCapture(kNoNation, a);
+    failures += masks.canCapture(static_cast<NationId>(registry.count()), b);
+
+    // Peace between A and B closes the border again.
+    masks.setRelation(a, b, RelationStatus::Neutral);
+    failures += masks.canEnter(a, b);
+    std::cout << "After peace, NationA may enter NationB: " << masks.canEnter(a, b) << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+// End of passability.cpp
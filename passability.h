@@ -0,0 +1,78 @@
+/**************************************************************************************************
+ * passability.h
+ * Per-Nation Movement Permission Masks for Conqueror Engine (Header)
+ *
+ * Native form of country_relations.py's can_unit_enter rules:
+ *   - own territory and unclaimed land: always enterable,
+ *   - at_war: enter and capture,
+ *   - ally: enter, but no capture,
+ *   - neutral: off-limits.
+ *
+ * For every nation the rules are precomputed into two bitsets over owner ids (enter / capture).
+ * Pathfinding combines one mask with the territory owner grid, so checking a node is one owner
+ * load plus one bit test, with no string or map lookups. A relationship change rewrites only the
+ * two bits it affects.
+ *
+ * Exposed Classes:
+ * - NationMask
+ * - PassabilityMasks
+ **************************************************************************************************/
+
+#ifndef PASSABILITY_H
+#define PASSABILITY_H
+
+#include "nations.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//-------------------------------------------------
+// View of one nation's mask (cheap to copy into hot loops)
+//-------------------------------------------------
+struct NationMask {
+    const std::uint64_t* words = nullptr;   // nullptr: no restrictions (e.g. unit without a nation).
+
+    bool allows(NationId owner) const {
+        return !words || owner == kNoNation || ((words[owner >> 6] >> (owner & 63)) & 1u);
+    }
+};
+
+//-------------------------------------------------
+// Passability Masks
+//-------------------------------------------------
+class PassabilityMasks {
+public:
+    // Resets every nation to "own territory only" (all relations neutral).
+    void reset(std::size_t nationCount);
+
+    // Updates the two affected bits in each mask for a symmetric relationship change.
+    void setRelation(NationId a, NationId b, RelationStatus status);
+
+    bool canEnter(NationId unitNation, NationId owner) const { return enterMask(unitNation).allows(owner); }
+    // Unlike entering, capturing is closed by default: units without a (known) nation take nothing.
+    bool canCapture(NationId unitNation, NationId owner) const {
+        return unitNation < nations && owner != kNoNation && owner != unitNation &&
+               captureMask(unitNation).allows(owner);
+    }
+
+    NationMask enterMask(NationId nation) const { return maskFor(enter, nation); }
+    NationMask captureMask(NationId nation) const { return maskFor(capture, nation); }
+
+    std::size_t nationCount() const { return nations; }
+
+private:
+    std::size_t nations = 0;
+    std::size_t wordsPerNation = 0;
+    std::vector<std::uint64_t> enter;
+    std::vector<std::uint64_t> capture;
+
+    NationMask maskFor(const std::vector<std::uint64_t>& bits, NationId nation) const {
+        NationMask mask;
+        if (nation < nations) mask.words = bits.data() + nation * wordsPerNation;
+        return mask;
+    }
+    void assign(std::vector<std::uint64_t>& bits, NationId row, NationId col, bool value);
+};
+
+#endif // PASSABILITY_H
@@ -0,0 +1,124 @@
+/**************************************************************************************************
+ * recruitment.h
+ * Utility-Based Recruitment Planner for Conqueror Engine (Header)
+ *
+ * AI purchase logic over the unit variant catalog (g_unitVariants, or the world pack's Variants
+ * section). buyUnit() in units.cpp always takes variants.front(); here every variant is scored for
+ * every nation:
+ *
+ *   utility = tier * combat * (offense * (base + aggression) + defense * (base + threat)
+ *                              + recon * base * surveillance) / (1 + owned / saturation)
+ *             / (cost * unitCostMultiplier + resourceCost)
+ *
+ * where offense/defense/recon come from the variant's category profile and tier grows with the
+ * variant's price within its category. Variants a nation cannot pay for (money or resources) or
+ * that need a subscription it lacks score -1.
+ *
+ * Scoring is one pass per variant over contiguous per-nation float columns with branch-free
+ * selects, so the compiler vectorizes it across nations. A plan runs a few rounds; each round every
+ * nation buys a batch of its best variant with its share of the day's budget, and owned counts
+ * make repeated picks of one category less attractive. The result is a list of batched purchase
+ * orders for the caller to charge and spawn.
+ *
+ * Exposed Types:
+ * - RecruitmentInputs
+ * - PurchaseOrder
+ * - RecruitmentPlanner
+ **************************************************************************************************/
+
+#ifndef RECRUITMENT_H
+#define RECRUITMENT_H
+
+#include "nations.h"
+#include "units.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class WorldPack;
+
+// Per-nation columns (index = NationId). Optional columns may be null and default as noted.
+struct RecruitmentInputs {
+    std::size_t nations = 0;
+    const double* treasury = nullptr;
+    const double* resources = nullptr;         // Null: resource costs are ignored.
+    const float* threat = nullptr;             // Hostile strength relative to own (1 = parity). Null: 0.
+    const float* aggression = nullptr;         // 0 at peace .. 1 at war. Null: 0.
+    const float* costMultiplier = nullptr;     // ModifierStat::UnitCost column. Null: 1.
+    const float* combatMultiplier = nullptr;   // ModifierStat::CombatEffectiveness column. Null: 1.
+    const float* surveillance = nullptr;       // ModifierStat::UnitSurveillance column. Null: 1.
+    const std::uint8_t* premium = nullptr;     // Subscription access. Null: none.
+};
+
+struct PurchaseOrder {
+    NationId nation;
+    std::uint32_t variant;
+    std::uint32_t count;
+    double cost;                               // Total money, after the cost multiplier.
+    double resourceCost;                       // Total resources.
+};
+
+//-------------------------------------------------
+// Recruitment Planner
+//-------------------------------------------------
+class RecruitmentPlanner {
+public:
+    static constexpr int kRounds = 3;
+    static constexpr std::uint32_t kMaxBatch = 16;
+    // Starting treasury the catalog is priced against (getNationData in units.cpp).
+    static constexpr double kCatalogTreasury = 10000000.0;
+
+    // Catalog from the registry filled by initUnitVariants().
+    void loadCatalog(const std::map<std::string, std::vector<UnitVariant>>& variants);
+    // Catalog from a world pack's Variants section. Returns false if the section is missing.
+    bool loadPack(const WorldPack& pack);
+
+    // Multiplies every money and resource price, e.g. into an economy with smaller treasuries.
+    // Tiers depend only on price ratios and are unchanged.
+    void scalePrices(double factor);
+
+    // Share of the treasury a nation may spend per plan() call (default 0.3).
+    void setSpendShare(double share) { spendShare = share; }
+
+    /**
+     * @brief Scores every variant for every nation and appends batched purchase orders.
+     * Owned counts are updated as if the orders were carried out.
+     * @return Number of orders appended.
+     */
+    std::size_t plan(const RecruitmentInputs& inputs, std::vector<PurchaseOrder>& orders);
+
+    std::size_t variantCount() const { return costs.size(); }
+    std::size_t categoryCount() const { return categoryNames.size(); }
+    const std::string& variantName(std::uint32_t variant) const { return names[variant]; }
+    const std::string& categoryName(std::size_t category) const { return categoryNames[category]; }
+    std::uint32_t categoryOf(std::uint32_t variant) const { return categories[variant]; }
+    double cost(std::uint32_t variant) const { return costs[variant]; }
+    double resourceCost(std::uint32_t variant) const { return resourceCosts[variant]; }
+    bool requiresSubscription(std::uint32_t variant) const { return subscription[variant] != 0.0f; }
+    std::uint32_t owned(NationId nation, std::size_t category) const;
+
+private:
+    // Catalog (SoA, one entry per variant).
+    std::vector<std::string> names;
+    std::vector<std::uint32_t> categories;
+    std::vector<float> costs, resourceCosts, subscription, tiers;
+    std::vector<float> offense, defense, recon;
+    std::vector<std::string> categoryNames;
+
+    double spendShare = 0.3;
+    std::vector<std::vector<float>> ownedByCategory;   // [category][nation], float for the scoring pass.
+
+    // Per-plan scratch columns.
+    std::vector<float> budget, stock, threatCol, aggressionCol, costCol, combatCol, reconCol, premiumCol;
+    std::vector<float> bestScore;
+    std::vector<std::int32_t> bestVariant;
+
+    void addVariant(const std::string& category, const std::string& name, double cost, double resourceCost,
+                    bool subscriptionRequired);
+    void finishCatalog();
+};
+
+#endif // RECRUITMENT_H
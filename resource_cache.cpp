@@ -0,0 +1,295 @@
+/*
+ * resource_cache.cpp - Content-addressed object store with a shipped hash manifest (disk / IDBFS).
+ */
+
+#include "resource_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_set>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+
+extern "C" EMSCRIPTEN_KEEPALIVE void resourceCacheSynced(ResourceCache* cache) {
+    cache->markReady();
+}
+#endif
+
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
+    std::cout << "[" << level << "] " << message << std::endl;
+}
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr std::uint64_t kPrime3 = 0x165667B19E3779F9ull;
+
+inline std::uint64_t rotl(std::uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+} // namespace
+
+std::uint64_t ResourceCache::contentHash(const void* data, std::size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    std::uint64_t h = kPrime3 ^ (static_cast<std::uint64_t>(size) * kPrime1);
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t k;
+        std::memcpy(&k, p + i, 8);
+        h ^= rotl(k * kPrime2, 31) * kPrime1;
+        h = rotl(h, 27) * kPrime1 + kPrime3;
+    }
+    for (; i < size; ++i) {
+        h ^= p[i] * kPrime3;
+        h = rotl(h, 11) * kPrime1;
+    }
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+std::uint64_t ResourceCache::derivedKey(std::uint64_t sourceHash, const std::string& kind) {
+    std::string key = hex(sourceHash) + ":" + kind;
+    return contentHash(key.data(), key.size());
+}
+
+std::string ResourceCache::hex(std::uint64_t hash) {
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+    return text;
+}
+
+bool ResourceCache::open(const std::string& directory) {
+    root = directory;
+#ifdef __EMSCRIPTEN__
+    // IDBFS must be driven from the browser thread; the sync completes asynchronously.
+    MAIN_THREAD_EM_ASM({
+        var dir = UTF8ToString($0);
+        try { FS.mkdir(dir); } catch (e) {}
+        try { FS.mount(IDBFS, {}, dir); } catch (e) {}
+        FS.syncfs(true, function(err) {
+            if (err) console.warn("ResourceCache: IndexedDB sync failed", err);
+            Module._resourceCacheSynced($1);
+        });
+    }, root.c_str(), this);
+    return true;
+#else
+    std::error_code error;
+    fs::create_directories(fs::path(root) / "objects", error);
+    if (error) {
+        logEvent("ResourceCache: Cannot create " + root + ": " + error.message(), "WARNING");
+        return false;
+    }
+    markReady();
+    return true;
+#endif
+}
+
+bool ResourceCache::loadManifest(const std::string& manifestPath) {
+    std::ifstream in(manifestPath);
+    if (!in.is_open()) return false;
+    manifest.clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string hashText, path;
+        std::uint64_t size = 0;
+        if (!(fields >> hashText >> size) || hashText.size() != 16) continue;
+        std::getline(fields >> std::ws, path);
+        if (path.empty()) continue;
+        manifest[path] = {std::strtoull(hashText.c_str(), nullptr, 16), size};
+    }
+    logEvent("ResourceCache: Manifest lists " + std::to_string(manifest.size()) + " resources.");
+    return true;
+}
+
+bool ResourceCache::expectedHash(const std::string& path, std::uint64_t& hash) const {
+    if (!isReady()) return false;
+    auto it = manifest.find(path);
+    if (it == manifest.end()) return false;
+    hash = it->second.hash;
+    return true;
+}
+
+std::string ResourceCache::objectPath(std::uint64_t hash) const {
+    return root + "/objects/" + hex(hash);
+}
+
+std::string ResourceCache::derivedPath(std::uint64_t key) const {
+    return root + "/derived/" + hex(key);
+}
+
+bool ResourceCache::writeFile(const std::string& target, const char* data, std::size_t size) {
+    if (!isReady() || root.empty()) return false;
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::error_code error;
+    if (fs::exists(target, error)) return true;
+    fs::create_directories(fs::path(target).parent_path(), error);
+    // Write then rename, so a crash never leaves a truncated object under a valid name.
+    std::string temporary = target + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(data, 1, size, file) == size;
+    ok = std::fclose(file) == 0 && ok;
+    if (ok) fs::rename(temporary, target, error);
+    if (!ok || error) {
+        fs::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+bool ResourceCache::storeDerived(std::uint64_t key, const char* data, std::size_t size) {
+    return writeFile(derivedPath(key), data, size);
+}
+
+std::uint64_t ResourceCache::store(const std::string& path, const char* data, std::size_t size) {
+    std::uint64_t hash = contentHash(data, size);
+    auto it = manifest.find(path);
+    if (it != manifest.end() && it->second.hash != hash) {
+        ++mismatchCount;
+        logEvent("ResourceCache: " + path + " does not match the manifest (" + hex(hash) + " != " +
+                 hex(it->second.hash) + ").", "WARNING");
+    }
+    writeFile(objectPath(hash), data, size);
+    return hash;
+}
+
+void ResourceCache::evict(std::uint64_t hash) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::error_code error;
+    fs::remove(objectPath(hash), error);
+}
+
+std::size_t ResourceCache::prune() {
+    // Without a manifest every object would look unreferenced.
+    if (!isReady() || root.empty() || manifest.empty()) return 0;
+    std::unordered_set<std::string> live;
+    for (const auto& entry : manifest) live.insert(hex(entry.second.hash));
+    std::size_t removed = 0;
+    std::error_code error;
+    std::lock_guard<std::mutex> lock(writeMutex);
+    for (fs::directory_iterator it(fs::path(root) / "objects", error), end; !error && it != end; it.increment(error)) {
+        if (live.count(it->path().filename().string())) continue;
+        std::error_code removeError;
+        removed += fs::remove(it->path(), removeError);
+    }
+    return removed;
+}
+
+void ResourceCache::persist() {
+#ifdef __EMSCRIPTEN__
+    if (!isReady()) return;
+    MAIN_THREAD_ASYNC_EM_ASM({
+        FS.syncfs(false, function(err) {
+            if (err) console.warn("ResourceCache: IndexedDB flush failed", err);
+        });
+    });
+#endif
+}
+
+bool ResourceCache::writeManifest(const std::string& manifestPath, const std::vector<std::string>& files) {
+    std::ofstream out(manifestPath, std::ios::trunc);
+    if (!out.is_open()) return false;
+    std::size_t written = 0;
+    for (const std::string& path : files) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) continue;
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        out << hex(contentHash(bytes.data(), bytes.size())) << " " << bytes.size() << " " << path << "\n";
+        ++written;
+    }
+    logEvent("ResourceCache: Wrote " + manifestPath + " (" + std::to_string(written) + " resources).");
+    return static_cast<bool>(out);
+}
+
+// -------------------------------------------------
+// Offline manifest builder (Compile with -DRESOURCE_MANIFEST_BUILD)
+//   g++ -std=c++17 -O2 -DRESOURCE_MANIFEST_BUILD resource_cache.cpp -o resource-manifest
+//   ./resource-manifest resources.manifest assets/*
+#ifdef RESOURCE_MANIFEST_BUILD
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: resource-manifest <manifest> <files...>" << std::endl;
+        return 1;
+    }
+    return ResourceCache::writeManifest(argv[1], std::vector<std::string>(argv + 2, argv + argc)) ? 0 : 1;
+}
+#endif
+
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DRESOURCE_CACHE_TEST)
+// Cold start fills the cache, warm start is served from it, and corrupt objects or stale
+// manifests fall back to the source.
+//   g++ -std=c++17 -O2 -pthread -DRESOURCE_CACHE_TEST resource_cache.cpp resource_loader.cpp
+#ifdef RESOURCE_CACHE_TEST
+#include "resource_loader.h"
+
+int main() {
+    const std::string dir = "/tmp/resource_cache_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir + "/assets");
+    std::vector<std::string> files;
+    for (int i = 0; i < 8; ++i) {
+        std::string path = dir + "/assets/file" + std::to_string(i) + ".dat";
+        std::ofstream(path, std::ios::binary) << std::string(1000 + i * 5000, static_cast<char>('A' + i));
+        files.push_back(path);
+    }
+    ResourceCache::writeManifest(dir + "/resources.manifest", files);
+
+    int failures = 0;
+    auto startup = [&](std::size_t expectedHits, const char* label) {
+        ResourceCache cache;
+        cache.open(dir + "/cache");
+        cache.loadManifest(dir + "/resources.manifest");
+        ResourceLoader loader(2);
+        loader.setCache(&cache);
+        loader.requestAll(files);
+        loader.waitAll();
+        bool ok = loader.cacheHits() == expectedHits;
+        for (const std::string& path : files) ok = ok && loader.get(path) && loader.get(path)->ok();
+        failures += !ok;
+        std::cout << label << ": " << loader.cacheHits() << "/" << files.size() << " from cache"
+                  << (ok ? "" : "  [UNEXPECTED]") << std::endl;
+        return cache.prune();
+    };
+
+    startup(0, "Cold start");
+    startup(files.size(), "Warm start");
+
+    // Corrupt one cached object: it must be rejected and re-read from the source.
+    ResourceCache probe;
+    probe.open(dir + "/cache");
+    probe.loadManifest(dir + "/resources.manifest");
+    std::uint64_t hash = 0;
+    probe.expectedHash(files[3], hash);
+    std::ofstream(probe.objectPath(hash), std::ios::binary | std::ios::trunc) << "garbage";
+    startup(files.size() - 1, "Corrupt object");
+
+    // Change a file and rebuild the manifest: only that file misses, and its old object is pruned.
+    std::ofstream(files[0], std::ios::binary | std::ios::trunc) << "changed contents";
+    ResourceCache::writeManifest(dir + "/resources.manifest", files);
+    std::size_t pruned = startup(files.size() - 1, "Changed file");
+    failures += pruned != 1;
+
+    // Derived data follows its source hash.
+    std::uint64_t key = ResourceCache::derivedKey(hash, "parsed");
+    failures += !probe.storeDerived(key, "xyz", 3) || !fs::exists(probe.derivedPath(key));
+
+    fs::remove_all(dir);
+    std::cout << "Failures: " << failures << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+// End of resource_cache.cpp
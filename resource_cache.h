@@ -0,0 +1,105 @@
+/**************************************************************************************************
+ * resource_cache.h
+ * Content-Addressed Resource Cache for Conqueror Engine (Header)
+ *
+ * Keeps a copy of every loaded resource under the hash of its contents, so a warm start reads
+ * unchanged files from the cache instead of fetching them again:
+ *   - the build ships resources.manifest ("<hash> <size> <path>" per line, written by
+ *     resource-manifest) listing the current hash of every resource;
+ *   - a resource whose manifest hash names an object already in the cache is served from there,
+ *     after re-hashing it to reject corrupt or truncated copies;
+ *   - anything else is read from its source, checked against the manifest and stored as
+ *     objects/<hash>, and prune() removes objects the manifest no longer references.
+ * Derived data (a parsed or converted form of a resource) is stored separately under
+ * derivedKey(source hash, kind), so it is reused exactly as long as its source is unchanged.
+ *
+ * Natively the cache is a directory on disk (.cache/resources). In the browser the directory is an
+ * IDBFS mount: open() pulls the IndexedDB contents in asynchronously (the cache misses until that
+ * finishes) and persist() writes new objects back.
+ *
+ * Exposed Classes:
+ * - ResourceCache
+ **************************************************************************************************/
+
+#ifndef RESOURCE_CACHE_H
+#define RESOURCE_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//-------------------------------------------------
+// Resource Cache
+//-------------------------------------------------
+class ResourceCache {
+public:
+    /**
+     * @brief Opens (creating if needed) the cache directory. In the browser this mounts IDBFS and
+     * starts the asynchronous sync from IndexedDB; isReady() turns true when it completes.
+     */
+    bool open(const std::string& directory);
+
+    /**
+     * @brief Reads the shipped manifest of current resource hashes.
+     * @return False if the manifest is missing; every lookup then misses.
+     */
+    bool loadManifest(const std::string& manifestPath);
+
+    bool isReady() const { return ready.load(std::memory_order_acquire); }
+
+    // Hash the manifest lists for a resource path.
+    bool expectedHash(const std::string& path, std::uint64_t& hash) const;
+    // File that holds (or would hold) the object with this hash.
+    std::string objectPath(std::uint64_t hash) const;
+
+    /**
+     * @brief Stores resource contents as an object (written to a temporary name, then renamed).
+     * @return The content hash. If it differs from the manifest's, the copy is still stored under
+     *         its own hash but the mismatch is counted and logged.
+     */
+    std::uint64_t store(const std::string& path, const char* data, std::size_t size);
+    // Derived data under derivedKey(); read it back from derivedPath().
+    bool storeDerived(std::uint64_t key, const char* data, std::size_t size);
+    std::string derivedPath(std::uint64_t key) const;
+
+    // Drops one object (e.g. after it failed its checksum) so the next store rewrites it.
+    void evict(std::uint64_t hash);
+    // Removes objects that no manifest entry references. Returns the number removed.
+    std::size_t prune();
+    // Browser: flushes new objects to IndexedDB. Native: no-op.
+    void persist();
+
+    std::size_t manifestSize() const { return manifest.size(); }
+    std::size_t mismatches() const { return mismatchCount.load(); }
+
+    // 64-bit content hash (8 bytes per step) and its fixed-width hex form used for object names.
+    static std::uint64_t contentHash(const void* data, std::size_t size);
+    static std::uint64_t derivedKey(std::uint64_t sourceHash, const std::string& kind);
+    static std::string hex(std::uint64_t hash);
+
+    // Writes a manifest for the given files (offline build step). Missing files are skipped.
+    static bool writeManifest(const std::string& manifestPath, const std::vector<std::string>& files);
+
+    // Called from JavaScript when the IndexedDB sync started by open() finishes.
+    void markReady() { ready.store(true, std::memory_order_release); }
+
+private:
+    struct ManifestEntry {
+        std::uint64_t hash;
+        std::uint64_t size;
+    };
+
+    std::string root;
+    std::unordered_map<std::string, ManifestEntry> manifest;
+    std::atomic<bool> ready{false};
+    std::atomic<std::size_t> mismatchCount{0};
+    std::mutex writeMutex;          // Serializes object writes from I/O threads.
+
+    bool writeFile(const std::string& target, const char* data, std::size_t size);
+};
+
+#endif // RESOURCE_CACHE_H
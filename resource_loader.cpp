@@ -0,0 +1,393 @@
+/*
+ * resource_loader.cpp - Prioritized I/O pool with single-copy (or mmap) reads and dispatched callbacks.
+ */
+
+#include "resource_loader.h"
+#include "resource_cache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define RESOURCE_LOADER_POSIX 1
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if !defined(__EMSCRIPTEN__)
+#define RESOURCE_LOADER_MMAP 1
+#include <sys/mman.h>
+#endif
+#endif
+
+#ifdef __EMSCRIPTEN__
+#include <cstring>
+#include <emscripten/fetch.h>
+#endif
+
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
+    std::cout << "[" << level << "] " << message << std::endl;
+}
+
+ResourceBuffer::~ResourceBuffer() {
+#ifdef RESOURCE_LOADER_MMAP
+    if (mapped && bytes) ::munmap(const_cast<char*>(bytes), length);
+#endif
+}
+
+ResourceLoader::ResourceLoader(std::size_t ioThreads) {
+    for (std::size_t i = 0; i < ioThreads; ++i) workers.emplace_back([this]() { workerLoop(); });
+}
+
+ResourceLoader::~ResourceLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    workReady.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+ResourceHandle ResourceLoader::readResource(const std::string& path) {
+    std::uint64_t expected = 0;
+    if (cache && cache->expectedHash(path, expected)) {
+        ResourceHandle cached = readFile(cache->objectPath(expected), path);
+        // Re-hash on the way in so a corrupt or truncated cache entry falls back to the source.
+        if (cached->ok() && ResourceCache::contentHash(cached->data(), cached->size()) == expected) {
+            ++hits;
+            return cached;
+        }
+        if (cached->ok()) cache->evict(expected);
+    }
+    ResourceHandle result = readFile(path, path);
+#ifdef __EMSCRIPTEN__
+    // Assets are no longer preloaded into the virtual filesystem; fetch them from the server.
+    if (!result->ok()) result = fetchFile(path);
+#endif
+    if (cache && result->ok()) cache->store(path, result->data(), result->size());
+    return result;
+}
+
+ResourceHandle ResourceLoader::readFile(const std::string& path, const std::string& label) {
+    auto buffer = std::make_shared<ResourceBuffer>();
+    buffer->filePath = label;
+#ifdef RESOURCE_LOADER_POSIX
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return buffer;
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        ::close(fd);
+        return buffer;
+    }
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+#ifdef RESOURCE_LOADER_MMAP
+    if (size >= kMapThreshold) {
+        void* view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED) {
+            ::close(fd);
+            buffer->bytes = static_cast<const char*>(view);
+            buffer->length = size;
+            buffer->mapped = true;
+            buffer->loaded = true;
+            return buffer;
+        }
+    }
+#endif
+    // Pre-sized from fstat: the file is copied once, straight into its final buffer.
+    buffer->owned.reset(new char[size ? size : 1]);
+    std::size_t done = 0;
+    while (done < size) {
+        ssize_t got = ::read(fd, buffer->owned.get() + done, size - done);
+        if (got <= 0) break;
+        done += static_cast<std::size_t>(got);
+    }
+    ::close(fd);
+    if (done != size) {
+        buffer->owned.reset();
+        return buffer;
+    }
+#else
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return buffer;
+    std::fseek(file, 0, SEEK_END);
+    long end = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    std::size_t size = end > 0 ? static_cast<std::size_t>(end) : 0;
+    buffer->owned.reset(new char[size ? size : 1]);
+    std::size_t done = std::fread(buffer->owned.get(), 1, size, file);
+    std::fclose(file);
+    if (done != size) {
+        buffer->owned.reset();
+        return buffer;
+    }
+#endif
+    buffer->bytes = buffer->owned.get();
+    buffer->length = size;
+    buffer->loaded = true;
+    return buffer;
+}
+
+#ifdef __EMSCRIPTEN__
+ResourceHandle ResourceLoader::fetchFile(const std::string& url) {
+    auto buffer = std::make_shared<ResourceBuffer>();
+    buffer->filePath = url;
+    emscripten_fetch_attr_t attr;
+    emscripten_fetch_attr_init(&attr);
+    std::strcpy(attr.requestMethod, "GET");
+    // Synchronous fetches are only allowed off the browser thread, i.e. on the I/O pool.
+    attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY | EMSCRIPTEN_FETCH_SYNCHRONOUS;
+    emscripten_fetch_t* fetch = emscripten_fetch(&attr, url.c_str());
+    if (fetch && fetch->status == 200) {
+        std::size_t size = static_cast<std::size_t>(fetch->numBytes);
+        buffer->owned.reset(new char[size ? size : 1]);
+        std::memcpy(buffer->owned.get(), fetch->data, size);
+        buffer->bytes = buffer->owned.get();
+        buffer->length = size;
+        buffer->loaded = true;
+    }
+    if (fetch) emscripten_fetch_close(fetch);
+    return buffer;
+}
+#endif
+
+std::shared_future<ResourceHandle> ResourceLoader::request(const std::string& path, ResourcePriority priority,
+                                                           ResourceCallback onLoaded) {
+    std::unique_lock<std::mutex> lock(mtx);
+    std::unique_ptr<Entry>& slot = entries[path];
+    if (!slot) {
+        slot.reset(new Entry());
+        slot->path = path;
+        slot->generation = ++generations;
+        slot->priority = priority;
+        slot->future = slot->promise.get_future().share();
+        ++outstanding;
+        if (onLoaded) slot->callbacks.push_back(std::move(onLoaded));
+        Entry* entry = slot.get();
+        if (workers.empty()) {
+            // No pool: read inline; the callback still waits for dispatchCompleted().
+            entry->state = State::Reading;
+            lock.unlock();
+            ResourceHandle result = readResource(path);
+            lock.lock();
+            finish(entry, std::move(result));
+        } else {
+            pendingReads.push({priority, sequence++, path, entry->generation});
+            workReady.notify_one();
+        }
+        return entry->future;
+    }
+
+    Entry* entry = slot.get();
+    if (onLoaded) {
+        entry->callbacks.push_back(std::move(onLoaded));
+        // Already read: queue the new callback for the next dispatch.
+        if (entry->state == State::Done) {
+            completions.push({std::min(priority, entry->priority), sequence++, entry});
+            completionReady.notify_all();
+        }
+    }
+    if (entry->state == State::Queued && priority < entry->priority) {
+        // More urgent now; the stale lower-priority job is skipped by the workers.
+        entry->priority = priority;
+        pendingReads.push({priority, sequence++, path, entry->generation});
+        workReady.notify_one();
+    }
+    return entry->future;
+}
+
+void ResourceLoader::requestAll(const std::vector<std::string>& paths, ResourcePriority priority,
+                                const ResourceCallback& onLoaded) {
+    for (const std::string& path : paths) request(path, priority, onLoaded);
+}
+
+void ResourceLoader::workerLoop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    for (;;) {
+        workReady.wait(lock, [this]() { return stopping || !pendingReads.empty(); });
+        if (stopping) return;
+        ReadJob job = pendingReads.top();
+        pendingReads.pop();
+        // Stale jobs (already read, or the entry was released and perhaps requested anew) are skipped.
+        auto it = entries.find(job.path);
+        if (it == entries.end() || it->second->generation != job.generation || it->second->state != State::Queued)
+            continue;
+        Entry* entry = it->second.get();
+        entry->state = State::Reading;
+        lock.unlock();
+        ResourceHandle result = readResource(job.path);
+        lock.lock();
+        finish(entry, std::move(result));
+    }
+}
+
+void ResourceLoader::finish(Entry* entry, ResourceHandle result) {
+    entry->result = result;
+    entry->state = State::Done;
+    if (result->ok()) totalBytes += result->size();
+    --outstanding;
+    entry->promise.set_value(std::move(result));
+    if (!entry->callbacks.empty()) completions.push({entry->priority, sequence++, entry});
+    completionReady.notify_all();
+}
+
+std::size_t ResourceLoader::dispatchCompleted() {
+    std::vector<std::pair<ResourceCallback, ResourceHandle>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        while (!completions.empty()) {
+            Entry* entry = completions.top().entry;
+            completions.pop();
+            for (ResourceCallback& callback : entry->callbacks) ready.emplace_back(std::move(callback), entry->result);
+            entry->callbacks.clear();
+        }
+    }
+    // Callbacks may request more files, so they run without the lock.
+    for (auto& item : ready) item.first(item.second);
+    return ready.size();
+}
+
+bool ResourceLoader::waitForCompletion(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(mtx);
+    auto ready = [this]() { return !completions.empty() || outstanding == 0; };
+    if (timeoutMs < 0) completionReady.wait(lock, ready);
+    else completionReady.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready);
+    return !completions.empty();
+}
+
+void ResourceLoader::waitAll() {
+    std::unique_lock<std::mutex> lock(mtx);
+    completionReady.wait(lock, [this]() { return outstanding == 0; });
+}
+
+ResourceHandle ResourceLoader::get(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = entries.find(path);
+    return it != entries.end() && it->second->state == State::Done ? it->second->result : nullptr;
+}
+
+bool ResourceLoader::release(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = entries.find(path);
+    // Entries with undispatched callbacks are still referenced by the completion queue.
+    if (it == entries.end() || it->second->state != State::Done || !it->second->callbacks.empty()) return false;
+    entries.erase(it);
+    return true;
+}
+
+std::size_t ResourceLoader::inFlight() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return outstanding;
+}
+
+std::uint64_t ResourceLoader::bytesLoaded() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return totalBytes;
+}
+
+bool ResourceLoader::loadResource(const std::string& filename, std::string& data) {
+    ResourceHandle buffer = readFile(filename, filename);
+    if (!buffer->ok()) return false;
+    data.assign(buffer->data(), buffer->size());
+    return true;
+}
+
+void ResourceLoader::loadAllResources(const std::vector<std::string>& filenames) {
+    requestAll(filenames, ResourcePriority::Normal, [](const ResourceHandle& resource) {
+        if (resource->ok())
+            logEvent("Loaded resource: " + resource->path() + " (" + std::to_string(resource->size()) + " bytes)");
+        else
+            logEvent("Failed to load resource: " + resource->path(), "WARNING");
+    });
+    waitAll();
+    dispatchCompleted();
+}
+
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DRESOURCE_LOADER_TEST)
+// Writes a set of files, loads them serially the old way and through the pool, and checks
+// priorities, deduplication and contents.
+//   g++ -std=c++17 -O2 -pthread -DRESOURCE_LOADER_TEST resource_loader.cpp resource_cache.cpp -o resource_loader
+#ifdef RESOURCE_LOADER_TEST
+#include <fstream>
+#include <sstream>
+
+int main() {
+    const int fileCount = 48;
+    std::vector<std::string> paths;
+    for (int i = 0; i < fileCount; ++i) {
+        std::string path = "/tmp/resource_loader_test_" + std::to_string(i) + ".dat";
+        std::ofstream out(path, std::ios::binary);
+        std::string body((i % 3 == 0 ? 512 : 16) * 1024, static_cast<char>('a' + i % 26));
+        out << body;
+        paths.push_back(path);
+    }
+    auto ms = [](std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    };
+
+    // Old path: ifstream -> stringstream -> string, one file after another.
+    auto t0 = std::chrono::steady_clock::now();
+    std::size_t serialBytes = 0;
+    for (const std::string& path : paths) {
+        std::ifstream file(path.c_str());
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        serialBytes += buffer.str().size();
+    }
+    double serialMs = ms(t0);
+
+    int failures = 0;
+    t0 = std::chrono::steady_clock::now();
+    ResourceLoader loader(4);
+    std::vector<ResourcePriority> order;
+    for (int i = 0; i < fileCount; ++i) {
+        ResourcePriority priority = i == fileCount - 1 ? ResourcePriority::Critical : ResourcePriority::Low;
+        loader.request(paths[i], priority, [&order, priority](const ResourceHandle&) { order.push_back(priority); });
+    }
+    // Duplicate request shares the same read.
+    std::shared_future<ResourceHandle> again = loader.request(paths[5], ResourcePriority::High);
+    std::shared_future<ResourceHandle> missing = loader.request("/tmp/resource_loader_test_missing.dat");
+    loader.waitAll();
+    std::size_t dispatched = loader.dispatchCompleted();
+    double poolMs = ms(t0);
+
+    failures += again.get() != loader.get(paths[5]);
+    failures += missing.get()->ok();
+    failures += dispatched != static_cast<std::size_t>(fileCount);
+    failures += order.empty() || order.front() != ResourcePriority::Critical;
+    failures += loader.bytesLoaded() != serialBytes;
+    for (int i = 0; i < fileCount; ++i) {
+        ResourceHandle r = loader.get(paths[i]);
+        failures += !r || !r->ok() || r->view().find_first_not_of(static_cast<char>('a' + i % 26)) != std::string_view::npos;
+    }
+    // Released entries are read again on the next request.
+    failures += !loader.release(paths[1]) || loader.get(paths[1]) != nullptr;
+    failures += !loader.request(paths[1]).get()->ok();
+    std::string copy;
+    failures += !ResourceLoader::loadResource(paths[0], copy) || copy.size() != 512 * 1024;
+
+    // Prefetch, bump, release: the bumped request leaves a stale Low job queued behind the released
+    // entry. A single worker busy on the large files keeps it queued; it must be skipped, and the
+    // next request must read the file exactly once more.
+    {
+        ResourceLoader single(1);
+        for (int i = 0; i < fileCount; i += 3) single.request(paths[i], ResourcePriority::High);
+        single.request(paths[7], ResourcePriority::Low);
+        single.request(paths[7], ResourcePriority::Critical);
+        single.request(paths[7]).wait();
+        failures += !single.release(paths[7]);
+        single.waitAll();
+        std::uint64_t before = single.bytesLoaded();
+        failures += !single.request(paths[7], ResourcePriority::Low).get()->ok();
+        single.waitAll();
+        failures += single.bytesLoaded() - before != 16 * 1024;
+    }
+
+    std::cout << fileCount << " files, " << serialBytes / 1024 << " KB: serial " << serialMs << " ms, pool "
+              << poolMs << " ms; failures: " << failures << std::endl;
+    for (const std::string& path : paths) std::remove(path.c_str());
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+// End of resource_loader.cpp
@@ -0,0 +1,207 @@
+/**************************************************************************************************
+ * resource_loader.h
+ * Asynchronous Resource Loader for Conqueror Engine (Header)
+ *
+ * Replaces the serial ifstream -> stringstream -> string loader in gameplay_stitched.cpp:
+ *   - a small I/O pool reads requested files concurrently, most urgent priority first;
+ *   - each file is read once into a buffer sized from fstat (one copy), or mmap'ed natively
+ *     when it is large, and shared read-only by every requester;
+ *   - results are available through a shared_future as soon as the read finishes, and through
+ *     completion callbacks that dispatchCompleted() runs on the caller's thread in priority order,
+ *     so modules never see I/O threads.
+ * Requests are deduplicated by path; asking again with a more urgent priority moves a queued read
+ * forward. In WASM, files that are not in the virtual filesystem are fetched from the server by the
+ * I/O threads (link with -s FETCH=1). With a ResourceCache attached, files whose manifest hash is already cached are read
+ * from the cache and everything else is stored there after its read.
+ *
+ * Exposed Types:
+ * - ResourcePriority / ResourceRequest
+ * - ResourceBuffer / ResourceHandle
+ * - ResourceLoader
+ **************************************************************************************************/
+
+#ifndef RESOURCE_LOADER_H
+#define RESOURCE_LOADER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class ResourceCache;
+
+//-------------------------------------------------
+// Priorities (lower value is more urgent)
+//-------------------------------------------------
+enum class ResourcePriority : std::uint8_t {
+    Critical = 0,   // Needed before anything else can start (configuration).
+    High,           // Needed by a module that gates gameplay.
+    Normal,
+    Low             // Prefetch; nobody is waiting yet.
+};
+
+struct ResourceRequest {
+    std::string path;
+    ResourcePriority priority = ResourcePriority::Normal;
+};
+
+//-------------------------------------------------
+// Loaded file contents (immutable, shared)
+//-------------------------------------------------
+class ResourceBuffer {
+public:
+    ResourceBuffer() = default;
+    ~ResourceBuffer();
+    ResourceBuffer(const ResourceBuffer&) = delete;
+    ResourceBuffer& operator=(const ResourceBuffer&) = delete;
+
+    const std::string& path() const { return filePath; }
+    bool ok() const { return loaded; }              // False if the file was missing or unreadable.
+    const char* data() const { return bytes; }
+    std::size_t size() const { return length; }
+    std::string_view view() const { return std::string_view(bytes ? bytes : "", length); }
+    bool isMapped() const { return mapped; }
+
+private:
+    friend class ResourceLoader;
+    std::string filePath;
+    bool loaded = false;
+    bool mapped = false;
+    const char* bytes = nullptr;
+    std::size_t length = 0;
+    std::unique_ptr<char[]> owned;
+};
+
+using ResourceHandle = std::shared_ptr<const ResourceBuffer>;
+using ResourceCallback = std::function<void(const ResourceHandle&)>;
+
+//-------------------------------------------------
+// Resource Loader
+//-------------------------------------------------
+class ResourceLoader {
+public:
+    // Files at least this large are mmap'ed natively instead of read.
+    static constexpr std::size_t kMapThreshold = 64 * 1024;
+
+    /**
+     * @param ioThreads Size of the I/O pool. 0 reads synchronously inside request() (for builds
+     *        without threads).
+     */
+    explicit ResourceLoader(std::size_t ioThreads = 2);
+    ~ResourceLoader();
+    ResourceLoader(const ResourceLoader&) = delete;
+    ResourceLoader& operator=(const ResourceLoader&) = delete;
+
+    // Serves and fills the cache for every later request. Attach before the first request.
+    void setCache(ResourceCache* resourceCache) { cache = resourceCache; }
+
+    /**
+     * @brief Queues a file (once per path) and returns a future for its contents.
+     * @param onLoaded Optional; run by dispatchCompleted() once the file has been read (also if the
+     *        read failed; check ResourceHandle::ok()).
+     */
+    std::shared_future<ResourceHandle> request(const std::string& path,
+                                               ResourcePriority priority = ResourcePriority::Normal,
+                                               ResourceCallback onLoaded = nullptr);
+    void requestAll(const std::vector<std::string>& paths, ResourcePriority priority = ResourcePriority::Normal,
+                    const ResourceCallback& onLoaded = nullptr);
+
+    /**
+     * @brief Runs the callbacks of finished reads on the calling thread, most urgent first.
+     * @return Number of callbacks run.
+     */
+    std::size_t dispatchCompleted();
+
+    // Blocks until a finished read is waiting for dispatch or nothing is in flight.
+    // Returns true if there is something to dispatch.
+    bool waitForCompletion(int timeoutMs = -1);
+    // Blocks until every requested file has been read (callbacks still need dispatchCompleted()).
+    void waitAll();
+
+    // Contents of a finished request, or nullptr if it was never requested or is still in flight.
+    ResourceHandle get(const std::string& path) const;
+    // Forgets a finished request so its buffer is freed with the last outside handle and the next
+    // request reads the file again. False if the path is unknown, in flight or has undispatched callbacks.
+    bool release(const std::string& path);
+    std::size_t inFlight() const;
+    std::uint64_t bytesLoaded() const;
+    std::size_t cacheHits() const { return hits.load(); }
+
+    // Synchronous single-copy read (the old ResourceLoader::loadResource).
+    static bool loadResource(const std::string& filename, std::string& data);
+    // Reads every file through the pool and logs each result (the old loadAllResources).
+    void loadAllResources(const std::vector<std::string>& filenames);
+
+private:
+    enum class State : std::uint8_t { Queued, Reading, Done };
+
+    struct Entry {
+        std::string path;
+        std::uint64_t generation = 0;               // Tells a re-requested path from a released one.
+        State state = State::Queued;
+        ResourcePriority priority = ResourcePriority::Low;
+        std::promise<ResourceHandle> promise;
+        std::shared_future<ResourceHandle> future;
+        ResourceHandle result;
+        std::vector<ResourceCallback> callbacks;
+    };
+
+    // Orders both queues: priority first, then request order.
+    struct Job {
+        ResourcePriority priority;
+        std::uint64_t sequence;
+        Entry* entry;
+        bool operator<(const Job& other) const {
+            if (priority != other.priority) return priority > other.priority;
+            return sequence > other.sequence;
+        }
+    };
+    // Reads name their entry by path and generation instead of pointer: a bumped request leaves a
+    // stale job behind, and the entry may be released (and freed) before a worker pops it.
+    struct ReadJob {
+        ResourcePriority priority;
+        std::uint64_t sequence;
+        std::string path;
+        std::uint64_t generation;
+        bool operator<(const ReadJob& other) const {
+            if (priority != other.priority) return priority > other.priority;
+            return sequence > other.sequence;
+        }
+    };
+
+    mutable std::mutex mtx;
+    std::condition_variable workReady;
+    std::condition_variable completionReady;
+    std::unordered_map<std::string, std::unique_ptr<Entry>> entries;
+    std::priority_queue<ReadJob> pendingReads;
+    std::priority_queue<Job> completions;
+    std::uint64_t sequence = 0;
+    std::uint64_t generations = 0;
+    std::size_t outstanding = 0;
+    std::uint64_t totalBytes = 0;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+    ResourceCache* cache = nullptr;
+    std::atomic<std::size_t> hits{0};
+
+    void workerLoop();
+    void finish(Entry* entry, ResourceHandle result);   // Called with mtx held.
+    ResourceHandle readResource(const std::string& path);
+    // Reads `file`; the buffer reports `label` as its path.
+    static ResourceHandle readFile(const std::string& file, const std::string& label);
+#ifdef __EMSCRIPTEN__
+    static ResourceHandle fetchFile(const std::string& url);
+#endif
+};
+
+#endif // RESOURCE_LOADER_H
@@ -0,0 +1,629 @@
+/*
+ * road_network.cpp - Nearest-city road graph with a customizable contraction hierarchy for routing.
+ */
+
+#include "road_network.h"
+#include "cities.h"
+#include "city_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <string>
+
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
+    std::cout << "[" << level << "] " << message << std::endl;
+}
+
+namespace {
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+constexpr double kDegToRad = 3.14159265358979323846 / 180.0;
+constexpr std::size_t kLeafCities = 16;            // Dissection stops here; leaves are ranked as they come.
+
+// Recursive geometric bisection over unit vectors; appends cities to `ranking`, lowest rank first.
+struct Dissection {
+    const std::vector<float>* position[3];
+    const std::vector<std::uint32_t>& adjacencyFirst;
+    const std::vector<std::uint32_t>& adjacency;
+    std::vector<std::uint32_t>& ranking;
+    std::vector<std::uint32_t> part;                // Side tag of the current split; 0 = separator.
+    std::uint32_t nextTag = 1;
+
+    std::vector<std::vector<std::uint32_t>> components(const std::vector<std::uint32_t>& nodes) {
+        const std::uint32_t inside = nextTag++;
+        for (std::uint32_t v : nodes) part[v] = inside;
+        std::vector<std::vector<std::uint32_t>> pieces;
+        for (std::uint32_t start : nodes) {
+            if (part[start] != inside) continue;
+            const std::uint32_t tag = nextTag++;
+            part[start] = tag;
+            pieces.emplace_back(1, start);
+            std::vector<std::uint32_t>& piece = pieces.back();
+            for (std::size_t k = 0; k < piece.size(); ++k) {
+                std::uint32_t v = piece[k];
+                for (std::uint32_t i = adjacencyFirst[v]; i < adjacencyFirst[v + 1]; ++i) {
+                    if (part[adjacency[i]] != inside) continue;
+                    part[adjacency[i]] = tag;
+                    piece.push_back(adjacency[i]);
+                }
+            }
+        }
+        return pieces;
+    }
+
+    // Vertex cover of the roads between split[0, mid) and split[mid, end): cut cities with the
+    // most crossing roads first, each taken only if it still has an uncovered crossing road.
+    std::vector<std::uint32_t> cover(const std::vector<std::uint32_t>& split, std::size_t mid) {
+        const std::uint32_t leftTag = nextTag++, rightTag = nextTag++;
+        for (std::size_t i = 0; i < split.size(); ++i) part[split[i]] = i < mid ? leftTag : rightTag;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> crossing;     // (roads across, city)
+        for (std::uint32_t v : split) {
+            std::uint32_t other = part[v] == leftTag ? rightTag : leftTag, across = 0;
+            for (std::uint32_t i = adjacencyFirst[v]; i < adjacencyFirst[v + 1]; ++i) across += part[adjacency[i]] == other;
+            if (across) crossing.push_back({across, v});
+        }
+        std::sort(crossing.begin(), crossing.end(), std::greater<std::pair<std::uint32_t, std::uint32_t>>());
+        std::vector<std::uint32_t> separator;
+        for (const auto& entry : crossing) {
+            std::uint32_t v = entry.second, other = part[v] == leftTag ? rightTag : leftTag;
+            for (std::uint32_t i = adjacencyFirst[v]; i < adjacencyFirst[v + 1]; ++i) {
+                if (part[adjacency[i]] != other) continue;
+                separator.push_back(v);
+                part[v] = 0;
+                break;
+            }
+        }
+        return separator;
+    }
+
+    void run(std::vector<std::uint32_t>& nodes) {
+        if (nodes.size() <= kLeafCities) {
+            ranking.insert(ranking.end(), nodes.begin(), nodes.end());
+            return;
+        }
+        // Islands and other disconnected pieces need no separator: each is ordered on its own.
+        std::vector<std::vector<std::uint32_t>> pieces = components(nodes);
+        if (pieces.size() > 1) {
+            nodes.clear();
+            nodes.shrink_to_fit();
+            for (std::vector<std::uint32_t>& piece : pieces) run(piece);
+            return;
+        }
+        // Split at the median along a few directions and keep the smallest separator.
+        static const float kDirections[9][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 1, 0}, {1, -1, 0},
+                                                {1, 0, 1}, {1, 0, -1}, {0, 1, 1}, {0, 1, -1}};
+        const std::size_t mid = nodes.size() / 2;
+        std::vector<std::uint32_t> separator, bestOrder;
+        for (const float* direction : kDirections) {
+            std::vector<std::uint32_t> trial = nodes;
+            auto key = [this, direction](std::uint32_t v) {
+                return direction[0] * (*position[0])[v] + direction[1] * (*position[1])[v] +
+                       direction[2] * (*position[2])[v];
+            };
+            std::nth_element(trial.begin(), trial.begin() + mid, trial.end(),
+                             [&key](std::uint32_t a, std::uint32_t b) { return key(a) < key(b); });
+            std::vector<std::uint32_t> cut = cover(trial, mid);
+            if (bestOrder.empty() || cut.size() < separator.size()) {
+                separator = std::move(cut);
+                bestOrder = std::move(trial);
+            }
+        }
+        const std::uint32_t leftTag = nextTag++, rightTag = nextTag++;
+        for (std::size_t i = 0; i < bestOrder.size(); ++i) part[bestOrder[i]] = i < mid ? leftTag : rightTag;
+        for (std::uint32_t v : separator) part[v] = 0;
+        std::vector<std::uint32_t> left, right;
+        for (std::uint32_t v : bestOrder) {
+            if (part[v] == leftTag) left.push_back(v);
+            else if (part[v] == rightTag) right.push_back(v);
+        }
+        nodes.clear();
+        nodes.shrink_to_fit();
+        run(left);
+        run(right);
+        ranking.insert(ranking.end(), separator.begin(), separator.end());
+    }
+};
+} // namespace
+
+float RoadNetwork::speedKmh(int level) {
+    return 30.0f + 9.0f * static_cast<float>(std::clamp(level, 0, 10));
+}
+
+//----- Build -----
+
+void RoadNetwork::build(const CitySystem& cities, const CityIndex& index) {
+    const std::size_t n = cities.count();
+    levels.resize(n);
+    for (std::size_t i = 0; i < n; ++i) levels[i] = static_cast<std::uint8_t>(std::clamp(cities.infrastructure(i), 0, 10));
+
+    // Roads to each city's nearest neighbours; a pair found from both ends is one road.
+    struct Link {
+        std::uint32_t a, b;
+        float km;
+    };
+    std::vector<Link> links;
+    std::uint32_t near[kNeighbours + 1];
+    float nearKm[kNeighbours + 1];
+    for (std::uint32_t i = 0; i < n; ++i) {
+        std::size_t found = index.nearest(cities.lat(i), cities.lng(i), kNeighbours + 1, near, nearKm);
+        for (std::size_t k = 0; k < found; ++k) {
+            if (near[k] == i || nearKm[k] > kMaxRoadKm) continue;
+            links.push_back({std::min(i, near[k]), std::max(i, near[k]), nearKm[k]});
+        }
+    }
+    std::sort(links.begin(), links.end(),
+              [](const Link& x, const Link& y) { return x.a != y.a ? x.a < y.a : x.b < y.b; });
+    links.erase(std::unique(links.begin(), links.end(),
+                            [](const Link& x, const Link& y) { return x.a == y.a && x.b == y.b; }),
+                links.end());
+    roadFrom.clear();
+    roadTo.clear();
+    roadLengths.clear();
+    for (const Link& link : links) {
+        roadFrom.push_back(link.a);
+        roadTo.push_back(link.b);
+        roadLengths.push_back(link.km);
+    }
+    roadOpenFlags.assign(roadFrom.size(), 1);
+    cityRoadFirst.assign(n + 1, 0);
+    for (std::size_t r = 0; r < roadFrom.size(); ++r) {
+        ++cityRoadFirst[roadFrom[r] + 1];
+        ++cityRoadFirst[roadTo[r] + 1];
+    }
+    for (std::size_t i = 0; i < n; ++i) cityRoadFirst[i + 1] += cityRoadFirst[i];
+    cityRoads.resize(cityRoadFirst[n]);
+    std::vector<std::uint32_t> fill(cityRoadFirst.begin(), cityRoadFirst.end() - 1);
+    for (std::uint32_t r = 0; r < roadFrom.size(); ++r) {
+        cityRoads[fill[roadFrom[r]]++] = r;
+        cityRoads[fill[roadTo[r]]++] = r;
+    }
+
+    // Cities on different landmasses never share a route, open roads or not.
+    landmass.assign(n, kNoRank);
+    std::vector<std::uint32_t> frontier;
+    for (std::uint32_t start = 0, piece = 0; start < n; ++start) {
+        if (landmass[start] != kNoRank) continue;
+        landmass[start] = piece;
+        frontier.assign(1, start);
+        while (!frontier.empty()) {
+            std::uint32_t v = frontier.back();
+            frontier.pop_back();
+            for (std::uint32_t i = cityRoadFirst[v]; i < cityRoadFirst[v + 1]; ++i) {
+                std::uint32_t road = cityRoads[i], w = roadFrom[road] == v ? roadTo[road] : roadFrom[road];
+                if (landmass[w] != kNoRank) continue;
+                landmass[w] = piece;
+                frontier.push_back(w);
+            }
+        }
+        ++piece;
+    }
+
+    std::vector<std::uint32_t> ranking;
+    order(cities, ranking);
+    cityAt = ranking;
+    rankOf.assign(n, kNoRank);
+    for (std::uint32_t r = 0; r < n; ++r) rankOf[cityAt[r]] = r;
+    contract();
+
+    inputWeights.assign(upHead.size(), kInfinity);
+    roadArcs.resize(roadFrom.size());
+    for (std::uint32_t r = 0; r < roadFrom.size(); ++r) {
+        std::uint32_t a = rankOf[roadFrom[r]], b = rankOf[roadTo[r]];
+        roadArcs[r] = arcOf(std::min(a, b), std::max(a, b));
+        inputWeights[roadArcs[r]] = roadHours(r);
+    }
+    customizeAll();
+    pending.clear();
+    queued.assign(upHead.size(), 0);
+    distUp.assign(n, kInfinity);
+    distDown.assign(n, kInfinity);
+    viaUp.assign(n, 0);
+    viaDown.assign(n, 0);
+    pathUp.clear();
+    pathDown.clear();
+}
+
+void RoadNetwork::order(const CitySystem& cities, std::vector<std::uint32_t>& ranking) const {
+    const std::size_t n = cities.count();
+    std::vector<float> px(n), py(n), pz(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        double lat = cities.lat(i) * kDegToRad, lng = cities.lng(i) * kDegToRad;
+        px[i] = static_cast<float>(std::cos(lat) * std::cos(lng));
+        py[i] = static_cast<float>(std::cos(lat) * std::sin(lng));
+        pz[i] = static_cast<float>(std::sin(lat));
+    }
+    std::vector<std::uint32_t> adjacency(cityRoads.size());
+    for (std::uint32_t v = 0; v < n; ++v)
+        for (std::uint32_t i = cityRoadFirst[v]; i < cityRoadFirst[v + 1]; ++i)
+            adjacency[i] = roadFrom[cityRoads[i]] == v ? roadTo[cityRoads[i]] : roadFrom[cityRoads[i]];
+
+    ranking.clear();
+    ranking.reserve(n);
+    Dissection dissection{{&px, &py, &pz}, cityRoadFirst, adjacency, ranking, std::vector<std::uint32_t>(n, 0)};
+    std::vector<std::uint32_t> all(n);
+    for (std::uint32_t i = 0; i < n; ++i) all[i] = i;
+    dissection.run(all);
+}
+
+// Contracts the cities in rank order. The upward neighbours of a city, minus the lowest (its
+// elimination-tree parent), all become neighbours of that parent: that is exactly the fill-in.
+void RoadNetwork::contract() {
+    const std::size_t n = rankOf.size();
+    std::vector<std::vector<std::uint32_t>> up(n);
+    for (std::size_t r = 0; r < roadFrom.size(); ++r) {
+        std::uint32_t a = rankOf[roadFrom[r]], b = rankOf[roadTo[r]];
+        up[std::min(a, b)].push_back(std::max(a, b));
+    }
+    parent.assign(n, kNoRank);
+    upFirst.assign(n + 1, 0);
+    for (std::uint32_t r = 0; r < n; ++r) {
+        std::vector<std::uint32_t>& heads = up[r];
+        std::sort(heads.begin(), heads.end());
+        heads.erase(std::unique(heads.begin(), heads.end()), heads.end());
+        upFirst[r + 1] = upFirst[r] + static_cast<std::uint32_t>(heads.size());
+        if (heads.empty()) continue;
+        parent[r] = heads.front();
+        std::vector<std::uint32_t>& into = up[heads.front()];
+        into.insert(into.end(), heads.begin() + 1, heads.end());
+    }
+    upHead.resize(upFirst[n]);
+    arcTail.resize(upFirst[n]);
+    downFirst.assign(n + 1, 0);
+    for (std::uint32_t r = 0; r < n; ++r) {
+        std::copy(up[r].begin(), up[r].end(), upHead.begin() + upFirst[r]);
+        std::fill(arcTail.begin() + upFirst[r], arcTail.begin() + upFirst[r + 1], r);
+        for (std::uint32_t head : up[r]) ++downFirst[head + 1];
+        std::vector<std::uint32_t>().swap(up[r]);
+    }
+    for (std::size_t r = 0; r < n; ++r) downFirst[r + 1] += downFirst[r];
+    // Arcs are sorted by tail, so each downward list comes out sorted by tail too.
+    downTail.resize(upHead.size());
+    downArc.resize(upHead.size());
+    std::vector<std::uint32_t> fill(downFirst.begin(), downFirst.end() - 1);
+    for (std::uint32_t arc = 0; arc < upHead.size(); ++arc) {
+        std::uint32_t slot = fill[upHead[arc]]++;
+        downTail[slot] = arcTail[arc];
+        downArc[slot] = arc;
+    }
+}
+
+std::uint32_t RoadNetwork::arcOf(std::uint32_t a, std::uint32_t b) const {
+    auto first = upHead.begin() + upFirst[a], last = upHead.begin() + upFirst[a + 1];
+    auto found = std::lower_bound(first, last, b);
+    return found != last && *found == b ? static_cast<std::uint32_t>(found - upHead.begin()) : kNoRoad;
+}
+
+//----- Roads -----
+
+float RoadNetwork::roadHours(std::uint32_t road) const {
+    if (!roadOpenFlags[road]) return kInfinity;
+    return roadLengths[road] / speedKmh(std::min(levels[roadFrom[road]], levels[roadTo[road]]));
+}
+
+std::uint32_t RoadNetwork::findRoad(std::uint32_t a, std::uint32_t b) const {
+    for (std::uint32_t i = cityRoadFirst[a]; i < cityRoadFirst[a + 1]; ++i) {
+        std::uint32_t road = cityRoads[i];
+        if ((roadFrom[road] == a && roadTo[road] == b) || (roadFrom[road] == b && roadTo[road] == a)) return road;
+    }
+    return kNoRoad;
+}
+
+void RoadNetwork::setInfrastructure(std::uint32_t city, int level) {
+    levels[city] = static_cast<std::uint8_t>(std::clamp(level, 0, 10));
+    for (std::uint32_t i = cityRoadFirst[city]; i < cityRoadFirst[city + 1]; ++i) {
+        std::uint32_t road = cityRoads[i], arc = roadArcs[road];
+        float hours = roadHours(road);
+        if (hours == inputWeights[arc]) continue;
+        inputWeights[arc] = hours;
+        queueArc(arc);
+    }
+}
+
+void RoadNetwork::setRoadOpen(std::uint32_t road, bool open) {
+    roadOpenFlags[road] = open ? 1 : 0;
+    std::uint32_t arc = roadArcs[road];
+    inputWeights[arc] = roadHours(road);
+    queueArc(arc);
+}
+
+//----- Customization -----
+
+void RoadNetwork::customizeAll() {
+    weights = inputWeights;
+    // Arcs leave lower ranks first, so every lower triangle of an arc is final before it is used.
+    for (std::uint32_t u = 0; u + 1 < upFirst.size(); ++u) {
+        for (std::uint32_t i = upFirst[u]; i < upFirst[u + 1]; ++i) {
+            for (std::uint32_t j = i + 1; j < upFirst[u + 1]; ++j) {
+                std::uint32_t arc = arcOf(upHead[i], upHead[j]);
+                weights[arc] = std::min(weights[arc], weights[i] + weights[j]);
+            }
+        }
+    }
+}
+
+void RoadNetwork::queueArc(std::uint32_t arc) {
+    if (queued[arc]) return;
+    queued[arc] = 1;
+    pending.push_back(arc);
+    std::push_heap(pending.begin(), pending.end(), std::greater<std::uint32_t>());
+}
+
+// Best path a -> u -> b over lower triangles (u below both); the apex of the best one on request.
+float RoadNetwork::lowerTriangles(std::uint32_t a, std::uint32_t b, std::uint32_t* apex) const {
+    float best = kInfinity;
+    std::uint32_t i = downFirst[a], j = downFirst[b];
+    const std::uint32_t iEnd = downFirst[a + 1], jEnd = downFirst[b + 1];
+    while (i < iEnd && j < jEnd) {
+        if (downTail[i] < downTail[j]) {
+            ++i;
+        } else if (downTail[j] < downTail[i]) {
+            ++j;
+        } else {
+            float via = weights[downArc[i]] + weights[downArc[j]];
+            if (via < best) {
+                best = via;
+                if (apex) *apex = downTail[i];
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return best;
+}
+
+std::size_t RoadNetwork::customize() {
+    std::size_t recomputed = 0;
+    while (!pending.empty()) {
+        std::pop_heap(pending.begin(), pending.end(), std::greater<std::uint32_t>());
+        std::uint32_t arc = pending.back();
+        pending.pop_back();
+        queued[arc] = 0;
+        ++recomputed;
+        const std::uint32_t a = arcTail[arc], b = upHead[arc];
+        float weight = std::min(inputWeights[arc], lowerTriangles(a, b));
+        if (weight == weights[arc]) continue;
+        weights[arc] = weight;
+        // The arc is a side of the lower triangle (a, b, c) of every arc between b and another
+        // upward neighbour c of a; those sit higher in the order and are recomputed after it.
+        for (std::uint32_t i = upFirst[a]; i < upFirst[a + 1]; ++i) {
+            std::uint32_t c = upHead[i];
+            if (c != b) queueArc(c < b ? arcOf(c, b) : arcOf(b, c));
+        }
+    }
+    return recomputed;
+}
+
+//----- Queries -----
+
+float RoadNetwork::search(std::uint32_t from, std::uint32_t to, std::uint32_t& meet) {
+    // The previous query's distances only live on its two tree paths.
+    for (std::uint32_t x : pathUp) distUp[x] = kInfinity;
+    for (std::uint32_t x : pathDown) distDown[x] = kInfinity;
+    pathUp.clear();
+    pathDown.clear();
+
+    auto climb = [this](std::uint32_t start, std::vector<float>& dist, std::vector<std::uint32_t>& via,
+                        std::vector<std::uint32_t>& path) {
+        dist[start] = 0.0f;
+        for (std::uint32_t x = start; x != kNoRank; x = parent[x]) {
+            path.push_back(x);
+            const float d = dist[x];
+            if (d == kInfinity) continue;
+            for (std::uint32_t arc = upFirst[x]; arc < upFirst[x + 1]; ++arc) {
+                float next = d + weights[arc];
+                if (next >= dist[upHead[arc]]) continue;
+                dist[upHead[arc]] = next;
+                via[upHead[arc]] = arc;
+            }
+        }
+    };
+    climb(rankOf[from], distUp, viaUp, pathUp);
+    climb(rankOf[to], distDown, viaDown, pathDown);
+
+    float best = kInfinity;
+    meet = kNoRank;
+    for (std::uint32_t x : pathUp) {
+        float d = distUp[x] + distDown[x];
+        if (d < best) {
+            best = d;
+            meet = x;
+        }
+    }
+    return best;
+}
+
+float RoadNetwork::travelHours(std::uint32_t from, std::uint32_t to) {
+    customize();
+    if (from == to) return 0.0f;
+    if (landmass[from] != landmass[to]) return kInfinity;
+    std::uint32_t meet;
+    return search(from, to, meet);
+}
+
+float RoadNetwork::route(std::uint32_t from, std::uint32_t to, std::vector<std::uint32_t>& path) {
+    customize();
+    path.clear();
+    if (from == to) {
+        path.push_back(from);
+        return 0.0f;
+    }
+    if (landmass[from] != landmass[to]) return kInfinity;
+    std::uint32_t meet;
+    float hours = search(from, to, meet);
+    if (meet == kNoRank) return hours;
+    // Up from the start to the meeting city (arcs collected top-down), then down to the goal.
+    std::vector<std::uint32_t> climb;
+    for (std::uint32_t x = meet; x != rankOf[from]; x = arcTail[viaUp[x]]) climb.push_back(viaUp[x]);
+    path.push_back(from);
+    for (auto arc = climb.rbegin(); arc != climb.rend(); ++arc) unpack(*arc, true, path);
+    for (std::uint32_t x = meet; x != rankOf[to]; x = arcTail[viaDown[x]]) unpack(viaDown[x], false, path);
+    return hours;
+}
+
+// Appends the cities of an arc walked upward (tail to head) or downward, excluding the first.
+void RoadNetwork::unpack(std::uint32_t arc, bool upward, std::vector<std::uint32_t>& path) const {
+    const std::uint32_t a = arcTail[arc], b = upHead[arc];
+    if (weights[arc] == inputWeights[arc]) {
+        path.push_back(cityAt[upward ? b : a]);
+        return;
+    }
+    std::uint32_t apex = kNoRank;
+    lowerTriangles(a, b, &apex);
+    const std::uint32_t toA = arcOf(apex, a), toB = arcOf(apex, b);
+    if (upward) {
+        unpack(toA, false, path);
+        unpack(toB, true, path);
+    } else {
+        unpack(toB, false, path);
+        unpack(toA, true, path);
+    }
+}
+
+// Standalone Testing Block (Compile with -DROAD_NETWORK_TEST)
+// 20k cities in continents: travel times and unpacked routes must match Dijkstra over the roads,
+// before and after upgrading cities and destroying roads through incremental customization.
+//   g++ -std=c++17 -O2 -DROAD_NETWORK_TEST road_network.cpp city_index.cpp cities.cpp geo.cpp worldpack.cpp json_reader.cpp -o road_network
+#ifdef ROAD_NETWORK_TEST
+#include <chrono>
+#include <queue>
+#include <random>
+
+namespace {
+// Reference: plain Dijkstra over open roads.
+float dijkstra(const RoadNetwork& roads, const std::vector<std::vector<std::uint32_t>>& byCity, std::uint32_t from,
+               std::uint32_t to) {
+    std::vector<float> dist(byCity.size(), kInfinity);
+    std::priority_queue<std::pair<float, std::uint32_t>, std::vector<std::pair<float, std::uint32_t>>,
+                        std::greater<std::pair<float, std::uint32_t>>> open;
+    dist[from] = 0.0f;
+    open.push({0.0f, from});
+    while (!open.empty()) {
+        auto [d, v] = open.top();
+        open.pop();
+        if (v == to) return d;
+        if (d > dist[v]) continue;
+        for (std::uint32_t road : byCity[v]) {
+            std::uint32_t w = roads.roadFromCity(road) == v ? roads.roadToCity(road) : roads.roadFromCity(road);
+            float next = d + roads.roadHours(road);
+            if (next >= dist[w]) continue;
+            dist[w] = next;
+            open.push({next, w});
+        }
+    }
+    return kInfinity;
+}
+
+int check(RoadNetwork& roads, const std::vector<std::vector<std::uint32_t>>& byCity, std::mt19937& rng,
+          const char* label) {
+    int failures = 0;
+    const std::size_t pairs = 300;
+    std::size_t reachable = 0;
+    std::vector<std::uint32_t> path;
+    for (std::size_t q = 0; q < pairs; ++q) {
+        std::uint32_t a = rng() % roads.cityCount(), b = rng() % roads.cityCount();
+        float expected = dijkstra(roads, byCity, a, b);
+        float hours = roads.route(a, b, path);
+        if (expected == kInfinity) {
+            failures += hours != kInfinity || !path.empty();
+            continue;
+        }
+        ++reachable;
+        failures += std::fabs(hours - expected) > 1e-4f * std::max(1.0f, expected);
+        // The unpacked route must run over open roads and add up to the reported time.
+        failures += path.empty() || path.front() != a || path.back() != b;
+        float walked = 0.0f;
+        for (std::size_t i = 1; i < path.size(); ++i) {
+            std::uint32_t road = roads.findRoad(path[i - 1], path[i]);
+            if (road == RoadNetwork::kNoRoad || !roads.roadOpen(road)) {
+                ++failures;
+                break;
+            }
+            walked += roads.roadHours(road);
+        }
+        failures += std::fabs(walked - expected) > 1e-4f * std::max(1.0f, expected);
+    }
+    std::cout << label << ": " << reachable << "/" << pairs << " pairs reachable, failures " << failures << "\n";
+    return failures;
+}
+} // namespace
+
+int main() {
+    const std::size_t count = 20000;
+    std::mt19937 rng(75);
+    std::uniform_real_distribution<double> latDist(-50.0, 60.0), lngDist(-180.0, 179.99);
+    std::normal_distribution<double> spread(0.0, 6.0);
+    std::vector<std::pair<double, double>> continents(12);
+    for (auto& c : continents) c = {latDist(rng), lngDist(rng)};
+    CitySystem cities;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& c = continents[rng() % continents.size()];
+        double lat = std::clamp(c.first + spread(rng), -80.0, 80.0);
+        double lng = c.second + spread(rng);
+        lng -= 360.0 * std::floor((lng + 180.0) / 360.0);
+        cities.addCity("city" + std::to_string(i), lat, lng, 0, 1e5, static_cast<int>(rng() % 11), 1.0, 1.0, 0.01);
+    }
+    CityIndex index;
+    index.build(cities);
+
+    int failures = 0;
+    RoadNetwork roads;
+    auto t0 = std::chrono::steady_clock::now();
+    roads.build(cities, index);
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::vector<std::vector<std::uint32_t>> byCity(count);
+    for (std::uint32_t r = 0; r < roads.roadCount(); ++r) {
+        byCity[roads.roadFromCity(r)].push_back(r);
+        byCity[roads.roadToCity(r)].push_back(r);
+    }
+    failures += check(roads, byCity, rng, "built");
+
+    // Query speed over random pairs on the same continent (others return at once).
+    const std::size_t queries = 20000;
+    std::vector<std::uint32_t> from(queries), to(queries);
+    for (std::size_t q = 0; q < queries; ++q) {
+        from[q] = rng() % count;
+        do to[q] = rng() % count;
+        while (roads.travelHours(from[q], to[q]) == kInfinity);
+    }
+    float sink = 0.0f;
+    auto t1 = std::chrono::steady_clock::now();
+    for (std::size_t q = 0; q < queries; ++q) sink += roads.travelHours(from[q], to[q]);
+    double queryUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t1).count() / queries;
+
+    // One city upgraded, as in play.
+    std::uint32_t upgraded = rng() % count;
+    roads.setInfrastructure(upgraded, 10);
+    auto t3 = std::chrono::steady_clock::now();
+    std::size_t single = roads.customize();
+    double singleUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t3).count();
+    roads.setInfrastructure(upgraded, cities.infrastructure(upgraded));
+
+    // A round of upgrades and destroyed roads, applied incrementally, then a few repairs.
+    for (int i = 0; i < 200; ++i) {
+        std::uint32_t city = rng() % count;
+        roads.setInfrastructure(city, std::min(10, cities.infrastructure(city) + 3));
+    }
+    std::vector<std::uint32_t> destroyed;
+    for (int i = 0; i < 300; ++i) {
+        destroyed.push_back(static_cast<std::uint32_t>(rng() % roads.roadCount()));
+        roads.setRoadOpen(destroyed.back(), false);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    std::size_t recomputed = roads.customize();
+    double customizeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t2).count();
+    failures += check(roads, byCity, rng, "upgraded and cut");
+    for (std::size_t i = 0; i < destroyed.size(); i += 3) roads.setRoadOpen(destroyed[i], true);
+    failures += check(roads, byCity, rng, "partly repaired");
+
+    std::cout << roads.roadCount() << " roads, " << roads.arcCount() - roads.roadCount() << " shortcuts; build "
+              << buildMs << " ms, query " << queryUs << " us; one upgrade recomputed " << single << " arcs in "
+              << singleUs << " us, 500 changes " << recomputed << " of " << roads.arcCount() << " arcs in "
+              << customizeMs << " ms (checksum " << sink << ")\n";
+    std::cout << "failures: " << failures << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+// End of road_network.cpp
@@ -0,0 +1,117 @@
+/**************************************************************************************************
+ * road_network.h
+ * City Road Network with Customizable Contraction Hierarchies for Conqueror Engine (Header)
+ *
+ * Every city gets roads to its kNeighbours nearest cities (up to kMaxRoadKm away). A road's travel
+ * time is its great-circle length over a speed set by the infrastructure level of its worse end,
+ * so upgrading a city speeds up every road into it; destroyed roads are closed (infinite time).
+ *
+ * Routing uses a customizable contraction hierarchy (CCH), which splits the work in three:
+ *   - order (once, topology only): nested dissection by position. Disconnected pieces are
+ *     ordered apart; a connected piece is split at the median along whichever of a few
+ *     directions needs the smallest separator (a greedy vertex cover of the roads across the
+ *     cut), and separators are ranked after both halves. Contracting in that order adds
+ *     shortcuts (fill-in) but keeps every city's upward neighbourhood small;
+ *   - customize (weights): shortcut (a, b) with rank a < b gets the minimum over its road and
+ *     every lower triangle (u, a, b), u < a. Weight changes queue only their arcs; a queue
+ *     ordered by rank recomputes each changed arc once and passes real changes on to the arcs
+ *     above it, so an upgrade or a destroyed road costs a few arcs, not a full pass;
+ *   - query: the upward search space of a city is its path to the root of the elimination tree
+ *     (parent = lowest-ranked upward neighbour), so a route is two walks up the tree relaxing
+ *     upward arcs, with no priority queue, and the meeting city is the best common ancestor.
+ *     Shortcuts are unpacked through their lower triangles back into roads.
+ *
+ * Queries share scratch arrays: one query at a time, from the thread that owns the network.
+ *
+ * Exposed Types:
+ * - RoadNetwork
+ **************************************************************************************************/
+
+#ifndef ROAD_NETWORK_H
+#define ROAD_NETWORK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class CitySystem;
+class CityIndex;
+
+//-------------------------------------------------
+// Road Network
+//-------------------------------------------------
+class RoadNetwork {
+public:
+    static constexpr std::uint32_t kNoRoad = 0xFFFFFFFFu;
+    static constexpr std::size_t kNeighbours = 4;   // Roads from each city to its nearest cities.
+    static constexpr double kMaxRoadKm = 500.0;     // Farther neighbours (other islands) get no road.
+
+    // km/h on a road whose worse end has infrastructure `level` (0..10): 30 up to 120.
+    static float speedKmh(int level);
+
+    // Lays the roads between the cities, orders and contracts the graph, and customizes it with
+    // the cities' current infrastructure.
+    void build(const CitySystem& cities, const CityIndex& index);
+
+    std::size_t cityCount() const { return rankOf.size(); }
+    std::size_t roadCount() const { return roadFrom.size(); }
+    // Roads plus shortcuts in the hierarchy.
+    std::size_t arcCount() const { return upHead.size(); }
+
+    std::uint32_t roadFromCity(std::uint32_t road) const { return roadFrom[road]; }
+    std::uint32_t roadToCity(std::uint32_t road) const { return roadTo[road]; }
+    float roadKm(std::uint32_t road) const { return roadLengths[road]; }
+    bool roadOpen(std::uint32_t road) const { return roadOpenFlags[road] != 0; }
+    // Travel hours at the current infrastructure (infinite when closed).
+    float roadHours(std::uint32_t road) const;
+    // The road between two cities, or kNoRoad.
+    std::uint32_t findRoad(std::uint32_t a, std::uint32_t b) const;
+
+    // Weight changes; they are queued and applied by customize() or the next query.
+    void setInfrastructure(std::uint32_t city, int level);
+    void setRoadOpen(std::uint32_t road, bool open);
+    // Applies queued changes. Returns the number of arcs recomputed.
+    std::size_t customize();
+
+    // Fastest travel time between two cities in hours (infinite when no open route exists).
+    float travelHours(std::uint32_t from, std::uint32_t to);
+    // Same, and writes the cities along the route (from, ..., to) to `path`; empty when unreachable.
+    float route(std::uint32_t from, std::uint32_t to, std::vector<std::uint32_t>& path);
+
+private:
+    static constexpr std::uint32_t kNoRank = 0xFFFFFFFFu;
+
+    // Roads (city space) and the roads of each city (CSR).
+    std::vector<std::uint32_t> roadFrom, roadTo, roadArcs;
+    std::vector<float> roadLengths;
+    std::vector<std::uint8_t> roadOpenFlags;
+    std::vector<std::uint32_t> cityRoadFirst, cityRoads;
+    std::vector<std::uint8_t> levels;
+    std::vector<std::uint32_t> landmass;            // Connected piece of the full road graph, per city.
+
+    // Hierarchy (rank space). Upward arcs of rank r are [upFirst[r], upFirst[r + 1]), heads
+    // ascending; downward lists hold (tail, arc) of the arcs ending at a rank, tails ascending.
+    std::vector<std::uint32_t> rankOf, cityAt, parent;
+    std::vector<std::uint32_t> upFirst, upHead, arcTail;
+    std::vector<float> inputWeights, weights;
+    std::vector<std::uint32_t> downFirst, downTail, downArc;
+
+    // Queued arcs, smallest index (lowest tail rank) first.
+    std::vector<std::uint32_t> pending;
+    std::vector<std::uint8_t> queued;
+
+    // Query scratch, left at infinity / empty between queries.
+    std::vector<float> distUp, distDown;
+    std::vector<std::uint32_t> viaUp, viaDown, pathUp, pathDown;
+
+    void order(const CitySystem& cities, std::vector<std::uint32_t>& ranking) const;
+    void contract();
+    void customizeAll();
+    std::uint32_t arcOf(std::uint32_t a, std::uint32_t b) const;
+    void queueArc(std::uint32_t arc);
+    float lowerTriangles(std::uint32_t a, std::uint32_t b, std::uint32_t* apex = nullptr) const;
+    float search(std::uint32_t from, std::uint32_t to, std::uint32_t& meet);
+    void unpack(std::uint32_t arc, bool upward, std::vector<std::uint32_t>& path) const;
+};
+
+#endif // ROAD_NETWORK_H
@@ -0,0 +1,508 @@
+/*
+ * steering.cpp - Separation / cohesion / alignment / path following over a counting-sort spatial hash.
+ */
+
+#include "steering.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
+    std::cout << "[" << level << "] " << message << std::endl;
+}
+
+namespace {
+constexpr float kDegToRad = 3.14159265358979323846f / 180.0f;
+constexpr float kMinLngScale = 0.01f;   // Keeps longitude steps finite within half a degree of the poles.
+
+// Scales (x, y) down to at most `limit` in length.
+void clampLength(float& x, float& y, float limit) {
+    float length2 = x * x + y * y;
+    if (length2 > limit * limit) {
+        float scale = limit / std::sqrt(length2);
+        x *= scale;
+        y *= scale;
+    }
+}
+}
+
+//-------------------------------------------------
+// Setup
+//-------------------------------------------------
+void SteeringSystem::setParams(const SteeringParams& p) {
+    params = p;
+    bandColumns.clear();
+    bandWidth.clear();
+    if (!params.geographic) return;
+    // A neighbour within the radius of an agent in the band differs by at most radius / cos(lat)
+    // in longitude, where |lat| reaches one radius beyond the band's poleward edge.
+    const float r = params.neighborRadius;
+    const auto bands = static_cast<std::int32_t>(std::ceil(180.0f / r));
+    for (std::int32_t b = 0; b < bands; ++b) {
+        float south = -90.0f + b * r, north = south + r;
+        float poleward = std::min(90.0f, std::max(std::fabs(south), std::fabs(north)) + r);
+        float columns = std::floor(360.0f * std::cos(poleward * kDegToRad) / r);
+        bandColumns.push_back(std::max<std::int32_t>(1, static_cast<std::int32_t>(columns)));
+        bandWidth.push_back(360.0f / bandColumns.back());
+    }
+}
+
+std::uint32_t SteeringSystem::addGroup() {
+    paths.emplace_back();
+    return static_cast<std::uint32_t>(paths.size() - 1);
+}
+
+void SteeringSystem::setGroupPath(std::uint32_t group, const std::vector<std::pair<float, float>>& waypoints) {
+    if (group >= paths.size()) return;
+    Path& path = paths[group];
+    path.x.clear();
+    path.y.clear();
+    for (const auto& point : waypoints) {
+        path.x.push_back(point.first);
+        path.y.push_back(point.second);
+    }
+    const float seek = waypoints.empty() ? 0.0f : 1.0f;
+    for (std::size_t i = 0; i < groups.size(); ++i) {
+        if (groups[i] != static_cast<std::int32_t>(group)) continue;
+        waypoint[i] = 0;
+        active[i] = seek;
+    }
+}
+
+std::uint32_t SteeringSystem::addAgent(float x, float y, std::uint32_t group) {
+    px.push_back(x);
+    py.push_back(y);
+    velX.push_back(0.0f);
+    velY.push_back(0.0f);
+    goalX.push_back(x);
+    goalY.push_back(y);
+    groups.push_back(group == kNoGroup ? -1 : static_cast<std::int32_t>(group));
+    waypoint.push_back(0);
+    active.push_back(group < paths.size() && !paths[group].x.empty() ? 1.0f : 0.0f);
+    return static_cast<std::uint32_t>(px.size() - 1);
+}
+
+void SteeringSystem::setGroup(std::uint32_t agent, std::uint32_t group) {
+    groups[agent] = group == kNoGroup ? -1 : static_cast<std::int32_t>(group);
+    waypoint[agent] = 0;
+}
+
+void SteeringSystem::setTarget(std::uint32_t agent, float x, float y) {
+    goalX[agent] = x;
+    goalY[agent] = y;
+    active[agent] = 1.0f;
+}
+
+void SteeringSystem::clearTarget(std::uint32_t agent) {
+    active[agent] = 0.0f;
+}
+
+//-------------------------------------------------
+// Spatial hash
+//-------------------------------------------------
+std::uint32_t SteeringSystem::bucket(std::int32_t cx, std::int32_t cy) const {
+    std::uint32_t h = static_cast<std::uint32_t>(cx) * 73856093u ^ static_cast<std::uint32_t>(cy) * 19349663u;
+    return h & static_cast<std::uint32_t>(bucketStart.size() - 2);
+}
+
+void SteeringSystem::cellOf(float x, float y, std::int32_t& cx, std::int32_t& cy) const {
+    const float inv = 1.0f / params.neighborRadius;
+    if (!params.geographic) {
+        cx = static_cast<std::int32_t>(std::floor(x * inv));
+        cy = static_cast<std::int32_t>(std::floor(y * inv));
+        return;
+    }
+    const auto bands = static_cast<std::int32_t>(bandColumns.size());
+    cy = std::min(std::max(static_cast<std::int32_t>(std::floor((y + 90.0f) * inv)), 0), bands - 1);
+    cx = static_cast<std::int32_t>(std::floor((x + 180.0f) / bandWidth[cy]));
+    cx = std::min(std::max(cx, 0), bandColumns[cy] - 1);
+}
+
+float SteeringSystem::lngScale(float y) const {
+    return params.geographic ? std::max(kMinLngScale, std::cos(y * kDegToRad)) : 1.0f;
+}
+
+void SteeringSystem::buildHash() {
+    const std::size_t n = px.size();
+    // Power-of-two table with about two buckets per agent, plus one end sentinel.
+    std::size_t buckets = 16;
+    while (buckets < 2 * n) buckets <<= 1;
+    bucketStart.assign(buckets + 1, 0);
+    bucketOf.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::int32_t cx, cy;
+        cellOf(px[i], py[i], cx, cy);
+        bucketOf[i] = bucket(cx, cy);
+        ++bucketStart[bucketOf[i] + 1];
+    }
+    for (std::size_t b = 0; b < buckets; ++b) bucketStart[b + 1] += bucketStart[b];
+    // Counting sort into contiguous per-bucket runs.
+    order.resize(n);
+    std::vector<std::uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (std::size_t i = 0; i < n; ++i) order[fill[bucketOf[i]]++] = static_cast<std::uint32_t>(i);
+    sx.resize(n);
+    sy.resize(n);
+    svx.resize(n);
+    svy.resize(n);
+    scos.resize(n);
+    sgroup.resize(n);
+    sindex.resize(n);
+    for (std::size_t k = 0; k < n; ++k) {
+        std::uint32_t i = order[k];
+        sx[k] = px[i];
+        sy[k] = py[i];
+        scos[k] = lngScale(py[i]);
+        svx[k] = velX[i];
+        svy[k] = velY[i];
+        sgroup[k] = groups[i];
+        sindex[k] = static_cast<std::int32_t>(k);
+    }
+}
+
+// Neighbour sums for sorted agent k over sorted agents [begin, end), in k's local frame; cohesion
+// sums the offsets to the mates. Every term is masked rather than branched, so the loop vectorizes.
+void SteeringSystem::accumulate(std::size_t k, std::size_t begin, std::size_t end, float& sepX, float& sepY,
+                                float& cohX, float& cohY, float& aliX, float& aliY, float& mates) const {
+    const float xi = sx[k], yi = sy[k], scale = scos[k];
+    // Longitude offsets past half a turn wrap; the planar bound is never reached.
+    const float half = params.geographic ? 180.0f : INFINITY;
+    const std::int32_t gi = sgroup[k];
+    const std::int32_t self = static_cast<std::int32_t>(k);
+    const float r2 = params.neighborRadius * params.neighborRadius;
+    const float s2 = params.separationRadius * params.separationRadius;
+    const float nudge = params.separationRadius * 1e-3f;
+    float ax = 0, ay = 0, bx = 0, by = 0, cx = 0, cy = 0, m = 0;
+    for (std::size_t j = begin; j < end; ++j) {
+        float dx = xi - sx[j];
+        dx = dx > half ? dx - 360.0f : dx;
+        dx = dx < -half ? dx + 360.0f : dx;
+        dx *= scale;
+        float dy = yi - sy[j];
+        // Stacked agents get a deterministic nudge apart, keyed by their sorted positions.
+        float d2raw = dx * dx + dy * dy;
+        bool stacked = (d2raw < nudge * nudge) & (sindex[j] != self);
+        dx = stacked ? (sindex[j] < self ? nudge : -nudge) : dx;
+        dy = stacked ? (((sindex[j] ^ self) & 1) ? nudge : -nudge) : dy;
+        float d2 = stacked ? 2.0f * nudge * nudge : d2raw;
+        bool other = sindex[j] != self;
+        bool near = other & (d2 < s2);
+        bool mate = other & (d2 < r2) & (sgroup[j] == gi) & (gi >= 0);
+        float push = near ? 1.0f / d2 : 0.0f;
+        ax += dx * push;
+        ay += dy * push;
+        bx -= mate ? dx : 0.0f;
+        by -= mate ? dy : 0.0f;
+        cx += mate ? svx[j] : 0.0f;
+        cy += mate ? svy[j] : 0.0f;
+        m += mate ? 1.0f : 0.0f;
+    }
+    sepX += ax;
+    sepY += ay;
+    cohX += bx;
+    cohY += by;
+    aliX += cx;
+    aliY += cy;
+    mates += m;
+}
+
+//-------------------------------------------------
+// Step
+//-------------------------------------------------
+void SteeringSystem::step(float dt) {
+    const std::size_t n = px.size();
+    arrived.clear();
+    tested = 0;
+    if (n == 0) return;
+    buildHash();
+    forceX.assign(n, 0.0f);
+    forceY.assign(n, 0.0f);
+    const float inv = 1.0f / params.neighborRadius;
+    const SteeringParams& p = params;
+    const auto bands = static_cast<std::int32_t>(bandColumns.size());
+
+    for (std::size_t k = 0; k < n; ++k) {
+        const std::uint32_t i = order[k];
+        float sepX = 0, sepY = 0, cohX = 0, cohY = 0, aliX = 0, aliY = 0, mates = 0;
+        if (search == SteeringSearch::AllPairs) {
+            accumulate(k, 0, n, sepX, sepY, cohX, cohY, aliX, aliY, mates);
+            tested += n;
+        } else {
+            // The 3x3 block of cells around the agent; distinct cells can share a bucket, so
+            // each bucket is visited once.
+            std::uint32_t seen[9];
+            int visited = 0;
+            auto visit = [&](std::int32_t cx, std::int32_t cy) {
+                std::uint32_t b = bucket(cx, cy);
+                if (std::find(seen, seen + visited, b) != seen + visited) return;
+                seen[visited++] = b;
+                // A crowded bucket (units spawned on one city) is sampled through a window of
+                // kMaxCandidates agents, so a step stays bounded however tightly units stack.
+                std::size_t begin = bucketStart[b], size = bucketStart[b + 1] - begin;
+                if (size > kMaxCandidates) {
+                    begin += k % (size - kMaxCandidates + 1);
+                    size = kMaxCandidates;
+                }
+                accumulate(k, begin, begin + size, sepX, sepY, cohX, cohY, aliX, aliY, mates);
+                tested += size;
+            };
+            if (!p.geographic) {
+                auto cx = static_cast<std::int32_t>(std::floor(sx[k] * inv));
+                auto cy = static_cast<std::int32_t>(std::floor(sy[k] * inv));
+                for (int oy = -1; oy <= 1; ++oy)
+                    for (int ox = -1; ox <= 1; ++ox) visit(cx + ox, cy + oy);
+            } else {
+                // Bands above and below have their own column widths; columns wrap at the date line.
+                std::int32_t cx, cy;
+                cellOf(sx[k], sy[k], cx, cy);
+                for (std::int32_t band = std::max(cy - 1, 0); band <= std::min(cy + 1, bands - 1); ++band) {
+                    const std::int32_t columns = bandColumns[band];
+                    auto column = static_cast<std::int32_t>(std::floor((sx[k] + 180.0f) / bandWidth[band]));
+                    column = std::min(std::max(column, 0), columns - 1);
+                    for (std::int32_t ox = -1; ox <= std::min(1, columns - 2); ++ox)
+                        visit((column + ox + columns) % columns, band);
+                }
+            }
+        }
+
+        // All terms are velocity changes, so the weights are comparable.
+        float fx = sepX * p.separationRadius * p.maxSpeed * p.separationWeight;
+        float fy = sepY * p.separationRadius * p.maxSpeed * p.separationWeight;
+        if (mates > 0.0f) {
+            fx += (cohX / mates) * inv * p.maxSpeed * p.cohesionWeight;
+            fy += (cohY / mates) * inv * p.maxSpeed * p.cohesionWeight;
+            fx += (aliX / mates - svx[k]) * p.alignmentWeight;
+            fy += (aliY / mates - svy[k]) * p.alignmentWeight;
+        }
+
+        // Path following: seek the group's current waypoint, or the agent's own goal.
+        float wantX = 0.0f, wantY = 0.0f;
+        if (active[i] != 0.0f) {
+            const Path* path = groups[i] >= 0 ? &paths[groups[i]] : nullptr;
+            bool followPath = path && !path->x.empty();
+            float gx = followPath ? path->x[waypoint[i]] : goalX[i];
+            float gy = followPath ? path->y[waypoint[i]] : goalY[i];
+            bool last = !followPath || waypoint[i] + 1 >= path->x.size();
+            float dx = gx - sx[k], dy = gy - sy[k];
+            if (p.geographic) {
+                dx = dx > 180.0f ? dx - 360.0f : (dx < -180.0f ? dx + 360.0f : dx);
+                dx *= scos[k];
+            }
+            float dist = std::sqrt(dx * dx + dy * dy);
+            if (!last && dist < p.waypointRadius) {
+                ++waypoint[i];
+            } else if (last && dist < p.arriveRadius) {
+                active[i] = 0.0f;
+                arrived.push_back(i);
+            } else if (dist > 0.0f) {
+                float speed = last ? p.maxSpeed * std::min(1.0f, dist / p.slowRadius) : p.maxSpeed;
+                wantX = dx / dist * speed;
+                wantY = dy / dist * speed;
+            }
+        }
+        // Idle agents steer towards zero velocity (braking).
+        fx += (wantX - svx[k]) * p.pathWeight;
+        fy += (wantY - svy[k]) * p.pathWeight;
+        clampLength(fx, fy, p.maxForce);
+        forceX[i] = fx;
+        forceY[i] = fy;
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        float vx = velX[i] + forceX[i] * dt;
+        float vy = velY[i] + forceY[i] * dt;
+        clampLength(vx, vy, p.maxSpeed);
+        velX[i] = vx;
+        velY[i] = vy;
+        if (!p.geographic) {
+            px[i] += vx * dt;
+            py[i] += vy * dt;
+            continue;
+        }
+        // Local velocity back to degrees: longitude steps widen towards the poles.
+        float x = px[i] + vx * dt / lngScale(py[i]);
+        px[i] = x >= 180.0f ? x - 360.0f : (x < -180.0f ? x + 360.0f : x);
+        py[i] = std::min(90.0f, std::max(-90.0f, py[i] + vy * dt));
+    }
+}
+
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DSTEERING_TEST)
+// The hashed neighbour search must match the all-pairs reference. Then a 10k-unit army that starts
+// stacked on a few points follows a three-waypoint path: it must spread out (no stacking), stay
+// together, reach the end and keep each step far inside the 33 ms tick.
+//   g++ -std=c++17 -O2 -DSTEERING_TEST steering.cpp -o steering
+#ifdef STEERING_TEST
+#include <chrono>
+#include <random>
+
+namespace {
+// Fraction of agents with another agent closer than `radius` (sweep over agents sorted by x).
+double stackedFraction(const SteeringSystem& s, float radius) {
+    std::vector<std::uint32_t> byX(s.count());
+    for (std::uint32_t i = 0; i < byX.size(); ++i) byX[i] = i;
+    std::sort(byX.begin(), byX.end(), [&](std::uint32_t a, std::uint32_t b) { return s.x(a) < s.x(b); });
+    std::vector<char> stacked(s.count(), 0);
+    for (std::size_t a = 0; a < byX.size(); ++a) {
+        for (std::size_t b = a + 1; b < byX.size() && s.x(byX[b]) - s.x(byX[a]) < radius; ++b) {
+            if (std::fabs(s.y(byX[b]) - s.y(byX[a])) < radius) stacked[byX[a]] = stacked[byX[b]] = 1;
+        }
+    }
+    return static_cast<double>(std::count(stacked.begin(), stacked.end(), 1)) / s.count();
+}
+}
+
+int main() {
+    int failures = 0;
+    std::mt19937 rng(5);
+
+    // Reference check on 600 agents in three groups.
+    {
+        std::uniform_real_distribution<float> coord(0.0f, 20.0f);
+        SteeringSystem hashed, reference;
+        reference.setSearch(SteeringSearch::AllPairs);
+        for (SteeringSystem* s : {&hashed, &reference})
+            for (int g = 0; g < 3; ++g) s->addGroup();
+        for (int i = 0; i < 600; ++i) {
+            float x = coord(rng), y = coord(rng);
+            hashed.addAgent(x, y, i % 3);
+            reference.addAgent(x, y, i % 3);
+            if (i % 2) {
+                hashed.setTarget(i, 10.0f, 10.0f);
+                reference.setTarget(i, 10.0f, 10.0f);
+            }
+        }
+        // Summation order differs between the searches, so positions drift apart by rounding over
+        // many steps; compare after the first few.
+        for (int t = 0; t < 3; ++t) {
+            hashed.step(1.0f);
+            reference.step(1.0f);
+        }
+        for (std::uint32_t i = 0; i < 600; ++i)
+            failures += std::fabs(hashed.x(i) - reference.x(i)) > 1e-4f || std::fabs(hashed.y(i) - reference.y(i)) > 1e-4f;
+        std::cout << "Hash vs all pairs: " << hashed.pairsTested() << " vs " << reference.pairsTested()
+                  << " pairs tested per step; mismatches: " << failures << std::endl;
+    }
+
+    // Geographic mode: the same reference check astride the date line and near the pole, where
+    // neighbours sit in other hash columns, then the local frame itself.
+    {
+        SteeringParams geo;
+        geo.geographic = true;
+        geo.neighborRadius = 1.0f;
+        geo.separationRadius = 0.3f;
+        geo.maxSpeed = 0.1f;
+        geo.maxForce = 0.04f;
+        std::uniform_real_distribution<float> spread(-3.0f, 3.0f);
+        SteeringSystem hashed, reference;
+        reference.setSearch(SteeringSearch::AllPairs);
+        int mismatches = 0;
+        for (SteeringSystem* s : {&hashed, &reference}) {
+            s->setParams(geo);
+            for (int g = 0; g < 2; ++g) s->addGroup();
+        }
+        for (int i = 0; i < 600; ++i) {
+            float lng = 180.0f + spread(rng) * (i % 2 ? 1.0f : 20.0f), lat = i % 2 ? spread(rng) : 84.0f + spread(rng);
+            lng = lng >= 180.0f ? lng - 360.0f : lng;
+            hashed.addAgent(lng, lat, i % 2);
+            reference.addAgent(lng, lat, i % 2);
+        }
+        for (int t = 0; t < 3; ++t) {
+            hashed.step(1.0f);
+            reference.step(1.0f);
+        }
+        for (std::uint32_t i = 0; i < 600; ++i)
+            mismatches += std::fabs(hashed.x(i) - reference.x(i)) > 1e-3f || std::fabs(hashed.y(i) - reference.y(i)) > 1e-4f;
+        failures += mismatches;
+
+        // Half a degree of longitude is 0.25 degrees of latitude at 60N (inside the separation
+        // radius) but 0.5 at the equator (outside it).
+        SteeringSystem pairs;
+        pairs.setParams(geo);
+        pairs.addGroup();
+        pairs.addGroup();
+        pairs.addAgent(10.0f, 60.0f, 0);
+        pairs.addAgent(10.5f, 60.0f, 0);
+        pairs.addAgent(10.0f, 0.0f, 1);
+        pairs.addAgent(10.5f, 0.0f, 1);
+        pairs.step(1.0f);
+        bool polewardRepels = pairs.x(0) < 10.0f && pairs.x(1) > 10.5f;
+        bool equatorStill = pairs.x(2) >= 10.0f && pairs.x(3) <= 10.5f;
+        failures += !polewardRepels || !equatorStill;
+
+        // A lone agent heads east across the date line the short way, and covers twice the
+        // longitude per step at 60N that it would at the equator.
+        SteeringSystem crossing;
+        geo.maxForce = geo.maxSpeed;
+        geo.slowRadius = 0.2f;
+        geo.arriveRadius = 0.02f;
+        crossing.setParams(geo);
+        crossing.addGroup();
+        crossing.addAgent(179.5f, 60.0f, 0);
+        crossing.setTarget(0, -178.0f, 60.0f);
+        crossing.step(1.0f);
+        float firstStep = crossing.x(0) - 179.5f;
+        bool shortWay = true;
+        std::size_t arrived = 0;
+        for (int t = 0; t < 40; ++t) {
+            crossing.step(1.0f);
+            shortWay = shortWay && std::fabs(crossing.x(0)) > 177.0f;
+            arrived += crossing.arrivals().size();
+        }
+        failures += std::fabs(firstStep - 0.2f) > 0.01f || !shortWay || arrived != 1;
+        failures += std::fabs(crossing.x(0) + 178.0f) > 0.05f || std::fabs(crossing.y(0) - 60.0f) > 0.05f;
+        std::cout << "Geographic: hash vs all pairs mismatches " << mismatches << "; separation at 60N "
+                  << polewardRepels << ", at equator " << !equatorStill << "; first step at 60N " << firstStep
+                  << " deg lng; date line crossed to " << crossing.x(0) << "; failures: " << failures << std::endl;
+    }
+
+    // 10k-unit army, spawned stacked on 10 muster points.
+    const std::uint32_t armySize = 10000;
+    SteeringSystem army;
+    SteeringParams params;
+    params.neighborRadius = 1.0f;
+    params.separationRadius = 0.5f;
+    params.maxSpeed = 1.0f;
+    params.maxForce = 0.3f;
+    params.waypointRadius = 10.0f;
+    params.arriveRadius = 20.0f;
+    params.slowRadius = 10.0f;
+    army.setParams(params);
+    std::uint32_t group = army.addGroup();
+    for (std::uint32_t i = 0; i < armySize; ++i) army.addAgent(static_cast<float>(i % 10), 0.0f, group);
+    double startStacked = stackedFraction(army, 0.1f);
+    army.setGroupPath(group, {{100.0f, 0.0f}, {100.0f, 100.0f}, {200.0f, 100.0f}});
+
+    const int ticks = 900;
+    std::size_t arrivals = 0;
+    double worstMs = 0.0, totalMs = 0.0;
+    for (int t = 0; t < ticks; ++t) {
+        auto t0 = std::chrono::steady_clock::now();
+        army.step(1.0f);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        worstMs = std::max(worstMs, ms);
+        totalMs += ms;
+        arrivals += army.arrivals().size();
+    }
+    double endStacked = stackedFraction(army, 0.1f);
+    float cx = 0, cy = 0, spread = 0;
+    for (std::uint32_t i = 0; i < armySize; ++i) { cx += army.x(i); cy += army.y(i); }
+    cx /= armySize;
+    cy /= armySize;
+    for (std::uint32_t i = 0; i < armySize; ++i)
+        spread = std::max(spread, std::hypot(army.x(i) - cx, army.y(i) - cy));
+
+    failures += startStacked < 0.99 || endStacked > 0.05;
+    failures += std::hypot(cx - 200.0f, cy - 100.0f) > 40.0f;   // Reached the last waypoint.
+    failures += spread > 120.0f;                                // Moved as one body.
+    failures += arrivals < armySize / 2;
+    failures += totalMs / ticks > 33.3;
+    std::cout << armySize << " agents: " << totalMs / ticks << " ms/step (worst " << worstMs << " ms); stacked "
+              << startStacked * 100 << "% -> " << endStacked * 100 << "%; centroid (" << cx << ", " << cy
+              << "), spread " << spread << ", arrivals " << arrivals << "; failures: " << failures << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+// End of steering.cpp
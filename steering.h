@@ -0,0 +1,134 @@
+/**************************************************************************************************
+ * steering.h
+ * Group Steering (Boids) for Conqueror Engine (Header)
+ *
+ * ai.py's move_to_target and UnitModule::update move every unit straight at its goal, so armies
+ * collapse onto one point. SteeringSystem moves agents with Reynolds-style forces instead:
+ *   - separation from every neighbour inside separationRadius;
+ *   - cohesion towards, and alignment with, neighbours of the same group (formation);
+ *   - path following: agents seek their group's waypoints in order (or their own target), slow
+ *     down inside slowRadius and report an arrival when they reach the last one.
+ * Neighbours are found through a spatial hash rebuilt every step with a counting sort: agents are
+ * reordered so each hash bucket is a contiguous run of SoA columns, and a neighbour pass is a
+ * masked accumulation over those runs that the compiler vectorizes. Positions are in any planar
+ * unit; forces are scaled to velocity units per step.
+ *
+ * With SteeringParams::geographic, x and y are longitude and latitude in degrees. Every offset is
+ * taken in the local frame of the agent: longitude differences wrap at the date line and shrink
+ * by cos(latitude), so distances, radii, speeds and velocities are all in degrees of latitude
+ * (about 111 km) whatever the heading or latitude. The hash then uses latitude bands one
+ * neighbour radius tall, each split into as many longitude columns as fit at its poleward edge,
+ * so the 3x3 block around an agent still covers its neighbour radius.
+ *
+ * Exposed Types:
+ * - SteeringParams
+ * - SteeringSearch
+ * - SteeringSystem
+ **************************************************************************************************/
+
+#ifndef STEERING_H
+#define STEERING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+struct SteeringParams {
+    float neighborRadius = 1.0f;        // Cohesion / alignment range; also the hash cell size.
+    float separationRadius = 0.5f;
+    float maxSpeed = 0.5f;              // Per unit of dt.
+    float maxForce = 0.1f;              // Largest velocity change per unit of dt.
+    float slowRadius = 2.0f;            // Seek speed ramps down inside this distance of the goal.
+    float waypointRadius = 1.0f;        // Distance at which an agent moves on to the next waypoint.
+    float arriveRadius = 0.25f;         // Distance to the last waypoint that counts as arrived.
+    float separationWeight = 1.5f;
+    float cohesionWeight = 0.5f;
+    float alignmentWeight = 0.5f;
+    float pathWeight = 1.0f;
+    bool geographic = false;            // x = longitude, y = latitude in degrees (see above).
+};
+
+enum class SteeringSearch : std::uint8_t {
+    SpatialHash,    // Default.
+    AllPairs        // O(n^2) reference for tests.
+};
+
+//-------------------------------------------------
+// Steering System
+//-------------------------------------------------
+class SteeringSystem {
+public:
+    static constexpr std::uint32_t kNoGroup = 0xFFFFFFFFu;
+    static constexpr std::size_t kMaxCandidates = 48;   // Agents examined per hash bucket.
+
+    void setParams(const SteeringParams& p);
+    const SteeringParams& parameters() const { return params; }
+    void setSearch(SteeringSearch mode) { search = mode; }
+
+    // Groups (formations). Agents of one group cohere, align and share a path.
+    std::uint32_t addGroup();
+    std::size_t groupCount() const { return paths.size(); }
+    // Replaces the group's path; its agents restart at the first waypoint.
+    void setGroupPath(std::uint32_t group, const std::vector<std::pair<float, float>>& waypoints);
+
+    // Adds a resting agent and returns its id (dense, from 0). kNoGroup: no cohesion or alignment.
+    std::uint32_t addAgent(float x, float y, std::uint32_t group = kNoGroup);
+    void setGroup(std::uint32_t agent, std::uint32_t group);
+    // Individual goal, used when the agent's group has no path.
+    void setTarget(std::uint32_t agent, float x, float y);
+    // Stops seeking; the agent brakes but is still pushed by separation.
+    void clearTarget(std::uint32_t agent);
+
+    // Advances every agent by dt.
+    void step(float dt);
+    // Agents that reached their final goal during the last step (their goal is cleared).
+    const std::vector<std::uint32_t>& arrivals() const { return arrived; }
+
+    std::size_t count() const { return px.size(); }
+    float x(std::uint32_t agent) const { return px[agent]; }
+    float y(std::uint32_t agent) const { return py[agent]; }
+    float vx(std::uint32_t agent) const { return velX[agent]; }
+    float vy(std::uint32_t agent) const { return velY[agent]; }
+    bool seeking(std::uint32_t agent) const { return active[agent] != 0.0f; }
+    const float* xs() const { return px.data(); }
+    const float* ys() const { return py.data(); }
+    // Candidate pairs examined by the last step (distance tests, before the radius mask).
+    std::uint64_t pairsTested() const { return tested; }
+
+private:
+    struct Path {
+        std::vector<float> x, y;
+    };
+
+    SteeringParams params;
+    SteeringSearch search = SteeringSearch::SpatialHash;
+    std::vector<Path> paths;
+
+    // Agents (SoA).
+    std::vector<float> px, py, velX, velY, goalX, goalY, active;
+    std::vector<std::int32_t> groups;       // -1 for no group.
+    std::vector<std::uint32_t> waypoint;    // Next waypoint index into the group path.
+
+    // Hash-sorted copies for the neighbour pass.
+    std::vector<std::uint32_t> bucketStart, order, bucketOf;
+    std::vector<float> sx, sy, svx, svy, scos;  // scos: longitude scale (cos(latitude), or 1).
+    // Geographic hash: longitude columns and their width per latitude band.
+    std::vector<std::int32_t> bandColumns;
+    std::vector<float> bandWidth;
+    std::vector<std::int32_t> sgroup, sindex;
+    std::vector<float> forceX, forceY;
+    std::vector<std::uint32_t> arrived;
+    std::uint64_t tested = 0;
+
+    void buildHash();
+    std::uint32_t bucket(std::int32_t cx, std::int32_t cy) const;
+    // Hash cell of a position (band and column in geographic mode).
+    void cellOf(float x, float y, std::int32_t& cx, std::int32_t& cy) const;
+    // Longitude scale at a latitude (1 when planar).
+    float lngScale(float y) const;
+    void accumulate(std::size_t k, std::size_t begin, std::size_t end, float& sepX, float& sepY, float& cohX,
+                    float& cohY, float& aliX, float& aliY, float& mates) const;
+};
+
+#endif // STEERING_H
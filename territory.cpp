@@ -0,0 +1,440 @@
+/*
+ * territory.cpp - Territory ownership index (owner grid + R-tree) for Conqueror Engine.
+ */
+
+#include "territory.h"
+#include "json_reader.h"
+#include "worldpack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+// Logging utility
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
+    std::cout << "[" << level << "] " << message << std::endl;
+}
+
+namespace {
+
+const std::size_t kRTreeFanout = 8;
+
+GeoBox emptyBox() {
+    const double inf = std::numeric_limits<double>::infinity();
+    return {inf, inf, -inf, -inf};
+}
+
+void expandBox(GeoBox& box, const GeoBox& other) {
+    box.minLng = std::min(box.minLng, other.minLng);
+    box.minLat = std::min(box.minLat, other.minLat);
+    box.maxLng = std::max(box.maxLng, other.maxLng);
+    box.maxLat = std::max(box.maxLat, other.maxLat);
+}
+
+// Converts a GeoJSON ring ([[lng,lat], ...]) into interleaved lng,lat pairs.
+bool readRing(const JsonValue& ring, std::vector<double>& out) {
+    if (!ring.isArray()) return false;
+    out.clear();
+    out.reserve(ring.array.size() * 2);
+    for (const auto& point : ring.array) {
+        if (!point.isArray() || point.array.size() < 2) return false;
+        out.push_back(point.array[0].number);
+        out.push_back(point.array[1].number);
+    }
+    return out.size() >= 6;
+}
+
+} // namespace
+
+TerritoryIndex::TerritoryIndex(double cellDegrees)
+    : cellSize(cellDegrees),
+      gridWidth(static_cast<int>(std::ceil(360.0 / cellDegrees))),
+      gridHeight(static_cast<int>(std::ceil(180.0 / cellDegrees))),
+      owners(static_cast<std::size_t>(gridWidth) * gridHeight, kNoNation),
+      flags(static_cast<std::size_t>(gridWidth) * gridHeight, 0) {}
+
+std::size_t TerritoryIndex::cellIndex(double lat, double lng) const {
+    if (lng >= 180.0 || lng < -180.0) lng = std::fmod(std::fmod(lng + 180.0, 360.0) + 360.0, 360.0) - 180.0;
+    int cx = static_cast<int>((lng + 180.0) / cellSize);
+    int cy = static_cast<int>((lat + 90.0) / cellSize);
+    cx = std::min(std::max(cx, 0), gridWidth - 1);
+    cy = std::min(std::max(cy, 0), gridHeight - 1);
+    return cellIndex(cx, cy);
+}
+
+bool TerritoryIndex::loadGeoJson(const std::string& path, NationRegistry& registry) {
+    JsonValue root;
+    std::string error;
+    if (!loadJsonFile(path, root, &error)) {
+        logEvent("Territory: failed to read " + path + " (" + error + ")", "ERROR");
+        return false;
+    }
+    return loadGeoJson(root, registry);
+}
+
+bool TerritoryIndex::loadGeoJson(const JsonValue& root, NationRegistry& registry) {
+    const JsonValue* features = root.find("features");
+    if (!features || !features->isArray()) {
+        logEvent("Territory: GeoJSON has no feature array.", "ERROR");
+        return false;
+    }
+
+    std::vector<std::vector<double>> polygonRings;
+    auto readPolygon = [&](const JsonValue& polygon) -> bool {
+        if (!polygon.isArray() || polygon.array.empty()) return false;
+        polygonRings.assign(polygon.array.size(), std::vector<double>());
+        for (std::size_t r = 0; r < polygon.array.size(); ++r)
+            if (!readRing(polygon.array[r], polygonRings[r])) return false;
+        return true;
+    };
+
+    std::size_t skipped = 0;
+    for (const auto& feature : features->array) {
+        const JsonValue* geometry = feature.find("geometry");
+        const JsonValue* properties = feature.find("properties");
+        if (!geometry) { ++skipped; continue; }
+
+        std::string code = feature.stringOr("id", "");
+        std::string name = properties ? properties->stringOr("name", "") : "";
+        if (code.empty() && name.empty()) { ++skipped; continue; }
+        NationId owner = registry.intern(code, name);
+
+        std::string type = geometry->stringOr("type", "");
+        const JsonValue* coords = geometry->find("coordinates");
+        if (!coords || !coords->isArray()) { ++skipped; continue; }
+
+        if (type == "Polygon") {
+            if (readPolygon(*coords)) addPolygon(owner, polygonRings);
+            else ++skipped;
+        } else if (type == "MultiPolygon") {
+            for (const auto& polygon : coords->array) {
+                if (readPolygon(polygon)) addPolygon(owner, polygonRings);
+                else ++skipped;
+            }
+        } else {
+            ++skipped;
+        }
+    }
+
+    build();
+    logEvent("Territory: indexed " + std::to_string(parts.size()) + " polygons for " +
+             std::to_string(registry.count()) + " nations on a " + std::to_string(gridWidth) + "x" +
+             std::to_string(gridHeight) + " grid" +
+             (skipped ? " (" + std::to_string(skipped) + " geometries skipped)" : std::string()) + ".");
+    return true;
+}
+
+bool TerritoryIndex::loadPack(const WorldPack& pack, NationRegistry& registry) {
+    std::size_t nationCount = 0, partCount = 0, ringCount = 0, lngCount = 0, latCount = 0;
+    const PackNation* packNations = pack.section<PackNation>(WorldPackSection::Nations, &nationCount);
+    const PackPart* packParts = pack.section<PackPart>(WorldPackSection::Parts, &partCount);
+    const PackRing* packRings = pack.section<PackRing>(WorldPackSection::Rings, &ringCount);
+    const double* packLng = pack.section<double>(WorldPackSection::VertexLng, &lngCount);
+    const double* packLat = pack.section<double>(WorldPackSection::VertexLat, &latCount);
+    bool consistent = packNations && packParts && packRings && packLng && packLat && lngCount == latCount &&
+                      nationCount < kNoNation;
+    for (std::size_t i = 0; consistent && i < ringCount; ++i)
+        consistent = packRings[i].begin + 3 <= packRings[i].end && packRings[i].end <= lngCount;
+    for (std::size_t i = 0; consistent && i < partCount; ++i)
+        consistent = packParts[i].nation < nationCount && packParts[i].ringBegin < packParts[i].ringEnd &&
+                     packParts[i].ringEnd <= ringCount;
+    if (!consistent) {
+        logEvent("Territory: world pack has missing or inconsistent territory sections.", "ERROR");
+        return false;
+    }
+
+    // Pack nation indices are registry ids when the registry starts empty; remap otherwise.
+    std::vector<NationId> remap(nationCount);
+    for (std::size_t i = 0; i < nationCount; ++i)
+        remap[i] = registry.intern(pack.string(packNations[i].code), pack.string(packNations[i].name));
+
+    vertLng.assign(packLng, packLng + lngCount);
+    vertLat.assign(packLat, packLat + latCount);
+    rings.resize(ringCount);
+    for (std::size_t i = 0; i < ringCount; ++i) rings[i] = {packRings[i].begin, packRings[i].end};
+    parts.resize(partCount);
+    for (std::size_t i = 0; i < partCount; ++i) {
+        const PackPart& p = packParts[i];
+        parts[i] = {remap[p.nation], p.ringBegin, p.ringEnd, {p.minLng, p.minLat, p.maxLng, p.maxLat}};
+    }
+
+    // Rasterizing from packed columns costs about as much as copying a prebuilt 3 MB grid would,
+    // so the pack stays outline-only.
+    build();
+    logEvent("Territory: mapped " + std::to_string(parts.size()) + " polygons for " +
+             std::to_string(registry.count()) + " nations from the world pack.");
+    return true;
+}
+
+void TerritoryIndex::writePack(WorldPackWriter& writer, const NationRegistry& registry) const {
+    std::vector<PackNation> packNations(registry.count());
+    for (std::size_t i = 0; i < registry.count(); ++i)
+        packNations[i] = {writer.addString(registry.code(static_cast<NationId>(i))),
+                          writer.addString(registry.name(static_cast<NationId>(i)))};
+    std::vector<PackRing> packRings(rings.size());
+    for (std::size_t i = 0; i < rings.size(); ++i) packRings[i] = {rings[i].begin, rings[i].end};
+    std::vector<PackPart> packParts(parts.size());
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        const PolygonPart& p = parts[i];
+        packParts[i] = {p.owner, p.ringBegin, p.ringEnd, 0, p.box.minLng, p.box.minLat, p.box.maxLng, p.box.maxLat};
+    }
+
+    writer.addSection(WorldPackSection::Nations, packNations);
+    writer.addSection(WorldPackSection::Parts, packParts);
+    writer.addSection(WorldPackSection::Rings, packRings);
+    writer.addSection(WorldPackSection::VertexLng, vertLng);
+    writer.addSection(WorldPackSection::VertexLat, vertLat);
+}
+
+void TerritoryIndex::addPolygon(NationId owner, const std::vector<std::vector<double>>& polygonRings) {
+    PolygonPart part;
+    part.owner = owner;
+    part.ringBegin = static_cast<std::uint32_t>(rings.size());
+    part.box = emptyBox();
+    for (const auto& ring : polygonRings) {
+        Ring r;
+        r.begin = static_cast<std::uint32_t>(vertLng.size());
+        for (std::size_t i = 0; i + 1 < ring.size(); i += 2) {
+            vertLng.push_back(ring[i]);
+            vertLat.push_back(ring[i + 1]);
+            expandBox(part.box, {ring[i], ring[i + 1], ring[i], ring[i + 1]});
+        }
+        r.end = static_cast<std::uint32_t>(vertLng.size());
+        rings.push_back(r);
+    }
+    part.ringEnd = static_cast<std::uint32_t>(rings.size());
+    parts.push_back(part);
+}
+
+void TerritoryIndex::build() {
+    std::fill(owners.begin(), owners.end(), kNoNation);
+    std::fill(flags.begin(), flags.end(), 0);
+    // Later polygons overwrite earlier ones; exactOwnerAt applies the same precedence.
+    for (const auto& part : parts) rasterizePart(part);
+    for (const auto& part : parts) markOutlineCells(part);
+    buildRTree();
+}
+
+// Scanline fill: a cell belongs to the part if its center is inside (even-odd over all rings).
+void TerritoryIndex::rasterizePart(const PolygonPart& part) {
+    int rowBegin = std::max(0, static_cast<int>(std::floor((part.box.minLat + 90.0) / cellSize)));
+    int rowEnd = std::min(gridHeight - 1, static_cast<int>(std::floor((part.box.maxLat + 90.0) / cellSize)));
+    std::vector<double> crossings;
+
+    for (int cy = rowBegin; cy <= rowEnd; ++cy) {
+        double yc = -90.0 + (cy + 0.5) * cellSize;
+        crossings.clear();
+        for (std::uint32_t r = part.ringBegin; r < part.ringEnd; ++r) {
+            const Ring& ring = rings[r];
+            for (std::uint32_t i = ring.begin, j = ring.end - 1; i < ring.end; j = i++) {
+                double y0 = vertLat[j], y1 = vertLat[i];
+                if ((y0 > yc) == (y1 > yc)) continue;
+                double x0 = vertLng[j], x1 = vertLng[i];
+                crossings.push_back(x0 + (yc - y0) * (x1 - x0) / (y1 - y0));
+            }
+        }
+        std::sort(crossings.begin(), crossings.end());
+        for (std::size_t k = 0; k + 1 < crossings.size(); k += 2) {
+            int cxBegin = static_cast<int>(std::ceil((crossings[k] + 180.0) / cellSize - 0.5));
+            int cxEnd = static_cast<int>(std::ceil((crossings[k + 1] + 180.0) / cellSize - 0.5));
+            cxBegin = std::max(cxBegin, 0);
+            cxEnd = std::min(cxEnd, gridWidth);
+            if (cxBegin >= cxEnd) continue;
+            std::fill(owners.begin() + cellIndex(cxBegin, cy), owners.begin() + cellIndex(cxEnd, cy), part.owner);
+        }
+    }
+}
+
+// Flags every cell an outline edge passes through (grid traversal, Amanatides & Woo).
+void TerritoryIndex::markOutlineCells(const PolygonPart& part) {
+    auto mark = [&](int cx, int cy) {
+        if (cx >= 0 && cx < gridWidth && cy >= 0 && cy < gridHeight)
+            flags[cellIndex(cx, cy)] |= kCellBorder;
+    };
+    const double inf = std::numeric_limits<double>::infinity();
+
+    for (std::uint32_t r = part.ringBegin; r < part.ringEnd; ++r) {
+        const Ring& ring = rings[r];
+        for (std::uint32_t i = ring.begin, j = ring.end - 1; i < ring.end; j = i++) {
+            double gx0 = (vertLng[j] + 180.0) / cellSize, gy0 = (vertLat[j] + 90.0) / cellSize;
+            double gx1 = (vertLng[i] + 180.0) / cellSize, gy1 = (vertLat[i] + 90.0) / cellSize;
+            int cx = static_cast<int>(std::floor(gx0)), cy = static_cast<int>(std::floor(gy0));
+            int ex = static_cast<int>(std::floor(gx1)), ey = static_cast<int>(std::floor(gy1));
+            mark(cx, cy);
+
+            double dx = gx1 - gx0, dy = gy1 - gy0;
+            int stepX = dx > 0 ? 1 : -1, stepY = dy > 0 ? 1 : -1;
+            double tDeltaX = dx != 0 ? 1.0 / std::fabs(dx) : inf;
+            double tDeltaY = dy != 0 ? 1.0 / std::fabs(dy) : inf;
+            double tMaxX = dx != 0 ? (stepX > 0 ? (cx + 1 - gx0) : (gx0 - cx)) * tDeltaX : inf;
+            double tMaxY = dy != 0 ? (stepY > 0 ? (cy + 1 - gy0) : (gy0 - cy)) * tDeltaY : inf;
+
+            int steps = std::abs(ex - cx) + std::abs(ey - cy);
+            for (int s = 0; s < steps; ++s) {
+                if (tMaxX < tMaxY) { cx += stepX; tMaxX += tDeltaX; }
+                else { cy += stepY; tMaxY += tDeltaY; }
+                mark(cx, cy);
+            }
+        }
+    }
+}
+
+// Sort-Tile-Recursive bulk load: leaves hold polygon parts, inner nodes hold kRTreeFanout children.
+void TerritoryIndex::buildRTree() {
+    nodes.clear();
+    leafParts.clear();
+    if (parts.empty()) return;
+
+    auto centerLng = [](const GeoBox& b) { return b.minLng + b.maxLng; };
+    auto centerLat = [](const GeoBox& b) { return b.minLat + b.maxLat; };
+
+    // Orders items into STR tiles: vertical slices by center lng, then by center lat within a slice.
+    auto strOrder = [&](std::vector<std::uint32_t>& items, auto boxOf) {
+        std::sort(items.begin(), items.end(), [&](std::uint32_t a, std::uint32_t b) {
+            return centerLng(boxOf(a)) < centerLng(boxOf(b));
+        });
+        std::size_t groups = (items.size() + kRTreeFanout - 1) / kRTreeFanout;
+        std::size_t slices = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(groups))));
+        std::size_t sliceSize = slices * kRTreeFanout;
+        for (std::size_t s = 0; s < items.size(); s += sliceSize) {
+            auto end = items.begin() + std::min(items.size(), s + sliceSize);
+            std::sort(items.begin() + s, end, [&](std::uint32_t a, std::uint32_t b) {
+                return centerLat(boxOf(a)) < centerLat(boxOf(b));
+            });
+        }
+    };
+
+    // Leaf level.
+    leafParts.resize(parts.size());
+    for (std::uint32_t i = 0; i < parts.size(); ++i) leafParts[i] = i;
+    strOrder(leafParts, [&](std::uint32_t i) -> const GeoBox& { return parts[i].box; });
+
+    std::vector<RTreeNode> level;
+    for (std::size_t i = 0; i < leafParts.size(); i += kRTreeFanout) {
+        RTreeNode node{emptyBox(), static_cast<std::uint32_t>(i),
+                       static_cast<std::uint32_t>(std::min(kRTreeFanout, leafParts.size() - i)), true};
+        for (std::uint32_t k = 0; k < node.count; ++k) expandBox(node.box, parts[leafParts[i + k]].box);
+        level.push_back(node);
+    }
+
+    // Inner levels: each level is appended to `nodes` contiguously before its parents are built.
+    while (level.size() > 1) {
+        std::vector<std::uint32_t> order(level.size());
+        for (std::uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+        strOrder(order, [&](std::uint32_t i) -> const GeoBox& { return level[i].box; });
+
+        std::uint32_t base = static_cast<std::uint32_t>(nodes.size());
+        for (std::uint32_t i : order) nodes.push_back(level[i]);
+
+        std::vector<RTreeNode> parents;
+        for (std::size_t i = 0; i < order.size(); i += kRTreeFanout) {
+            RTreeNode node{emptyBox(), base + static_cast<std::uint32_t>(i),
+                           static_cast<std::uint32_t>(std::min(kRTreeFanout, order.size() - i)), false};
+            for (std::uint32_t k = 0; k < node.count; ++k) expandBox(node.box, nodes[node.first + k].box);
+            parents.push_back(node);
+        }
+        level.swap(parents);
+    }
+    nodes.push_back(level.front());
+}
+
+bool TerritoryIndex::partContains(const PolygonPart& part, double lat, double lng) const {
+    if (!part.box.contains(lat, lng)) return false;
+    bool inside = false;
+    for (std::uint32_t r = part.ringBegin; r < part.ringEnd; ++r) {
+        const Ring& ring = rings[r];
+        for (std::uint32_t i = ring.begin, j = ring.end - 1; i < ring.end; j = i++) {
+            double yi = vertLat[i], yj = vertLat[j];
+            if ((yi > lat) != (yj > lat) &&
+                lng < (vertLng[j] - vertLng[i]) * (lat - yi) / (yj - yi) + vertLng[i])
+                inside = !inside;
+        }
+    }
+    return inside;
+}
+
+NationId TerritoryIndex::exactOwnerAt(double lat, double lng) const {
+    if (nodes.empty()) return kNoNation;
+    std::uint32_t best = std::numeric_limits<std::uint32_t>::max();
+    std::uint32_t stack[64];
+    int top = 0;
+    stack[top++] = static_cast<std::uint32_t>(nodes.size() - 1);
+    while (top > 0) {
+        const RTreeNode& node = nodes[stack[--top]];
+        if (!node.box.contains(lat, lng)) continue;
+        for (std::uint32_t k = 0; k < node.count; ++k) {
+            if (node.leaf) {
+                std::uint32_t partId = leafParts[node.first + k];
+                // Highest part id wins, matching the rasterization order in build().
+                if ((best == std::numeric_limits<std::uint32_t>::max() || partId > best) &&
+                    partContains(parts[partId], lat, lng))
+                    best = partId;
+            } else if (top < 64) {
+                stack[top++] = node.first + k;
+            }
+        }
+    }
+    return best == std::numeric_limits<std::uint32_t>::max() ? kNoNation : parts[best].owner;
+}
+
+NationId TerritoryIndex::ownerAt(double lat, double lng) const {
+    std::size_t cell = cellIndex(lat, lng);
+    if (!(flags[cell] & kCellBorder)) return owners[cell];
+    return exactOwnerAt(lat, lng);
+}
+
+void TerritoryIndex::ownersAt(const double* lat, const double* lng, std::size_t count, NationId* out) const {
+    for (std::size_t i = 0; i < count; ++i) {
+        std::size_t cell = cellIndex(lat[i], lng[i]);
+        out[i] = (flags[cell] & kCellBorder) ? exactOwnerAt(lat[i], lng[i]) : owners[cell];
+    }
+}
+
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DTERRITORY_TEST)
+//   g++ -std=c++17 -O2 -DTERRITORY_TEST territory.cpp worldpack.cpp json_reader.cpp -o territory
+#ifdef TERRITORY_TEST
+#include <chrono>
+#include <random>
+
+int main() {
+    NationRegistry registry;
+    TerritoryIndex territory;
+    if (!territory.loadGeoJson("countries.geo.json", registry)) return 1;
+
+    struct Probe { const char* label; double lat, lng; };
+    const Probe probes[] = {
+        {"Paris", 48.8566, 2.3522}, {"Berlin", 52.52, 13.405}, {"New York", 40.7128, -74.006},
+        {"Cairo", 30.0444, 31.2357}, {"Tokyo", 35.6762, 139.6503}, {"Mid-Atlantic", 30.0, -40.0},
+    };
+    for (const auto& p : probes) {
+        NationId id = territory.ownerAt(p.lat, p.lng);
+        logEvent(std::string(p.label) + " -> " + (id == kNoNation ? "(none)" : registry.name(id)));
+    }
+
+    // Grid-accelerated lookup must agree with the exact polygon test everywhere.
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> latDist(-60.0, 75.0), lngDist(-180.0, 180.0);
+    const std::size_t n = 200000;
+    std::vector<double> lats(n), lngs(n);
+    for (std::size_t i = 0; i < n; ++i) { lats[i] = latDist(rng); lngs[i] = lngDist(rng); }
+
+    std::vector<NationId> fast(n), exact(n);
+    auto t0 = std::chrono::steady_clock::now();
+    territory.ownersAt(lats.data(), lngs.data(), n, fast.data());
+    auto t1 = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < n; ++i) exact[i] = territory.exactOwnerAt(lats[i], lngs[i]);
+    auto t2 = std::chrono::steady_clock::now();
+
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < n; ++i) mismatches += fast[i] != exact[i];
+    auto us = [](auto d) { return std::chrono::duration_cast<std::chrono::microseconds>(d).count(); };
+    logEvent("Grid lookup: " + std::to_string(us(t1 - t0)) + " us, exact R-tree: " +
+             std::to_string(us(t2 - t1)) + " us for " + std::to_string(n) + " points; mismatches: " +
+             std::to_string(mismatches));
+    return mismatches == 0 ? 0 : 1;
+}
+#endif
+
+// End of territory.cpp
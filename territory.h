@@ -0,0 +1,145 @@
+/**************************************************************************************************
+ * territory.h
+ * Territory Ownership Index for Conqueror Engine (Header)
+ *
+ * Replaces the bounding-box scan in country_relations.py (CountryRelationsManager.territory_owner)
+ * with a native index built from countries.geo.json:
+ *   - An equirectangular owner grid (one NationId per cell) answers point-owner queries in O(1).
+ *   - Cells crossed by a country outline are flagged as border cells; only those fall back to an
+ *     exact point-in-polygon test, using an STR-packed R-tree over polygon bounding boxes.
+ *
+ * Grid layout: row 0 is the southernmost band (-90 lat), column 0 starts at -180 lng, and cells
+ * are stored row-major in a single contiguous array.
+ *
+ * The outlines can also be restored from world.pack (worldpack.h), skipping the GeoJSON parse.
+ *
+ * Exposed Classes:
+ * - GeoBox
+ * - TerritoryIndex
+ **************************************************************************************************/
+
+#ifndef TERRITORY_H
+#define TERRITORY_H
+
+#include "nations.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct JsonValue;
+class WorldPack;
+class WorldPackWriter;
+
+//-------------------------------------------------
+// Axis-aligned lng/lat rectangle
+//-------------------------------------------------
+struct GeoBox {
+    double minLng, minLat, maxLng, maxLat;
+
+    bool contains(double lat, double lng) const {
+        return lng >= minLng && lng <= maxLng && lat >= minLat && lat <= maxLat;
+    }
+};
+
+//-------------------------------------------------
+// Territory Index
+//-------------------------------------------------
+class TerritoryIndex {
+public:
+    static constexpr std::uint8_t kCellBorder = 0x01;   // An outline crosses this cell.
+    static constexpr std::uint8_t kCellCaptured = 0x02; // Owner was set by capture; grid is authoritative.
+
+    /**
+     * @param cellDegrees Edge length of a grid cell. The default (0.25 deg, ~28 km at the
+     *        equator) gives a 1440x720 grid: 2 MB of owner ids plus 1 MB of cell flags.
+     */
+    explicit TerritoryIndex(double cellDegrees = 0.25);
+
+    /**
+     * @brief Loads country outlines from a GeoJSON FeatureCollection and rebuilds the index.
+     * Nations are interned into the registry by feature id (ISO alpha-3) and properties.name.
+     * @return False if the file is missing or malformed; the index is left empty in that case.
+     */
+    bool loadGeoJson(const std::string& path, NationRegistry& registry);
+    bool loadGeoJson(const JsonValue& root, NationRegistry& registry);
+
+    /**
+     * @brief Loads outlines from a world pack and rebuilds the index, replacing the current one.
+     * The vertex columns are copied straight from the pack, so no text is parsed.
+     * @return False if the pack has no (or inconsistent) territory sections.
+     */
+    bool loadPack(const WorldPack& pack, NationRegistry& registry);
+
+    // Writes nations and outlines into a pack (offline builder).
+    void writePack(WorldPackWriter& writer, const NationRegistry& registry) const;
+
+    // Adds one polygon (exterior ring followed by holes, each as interleaved lng,lat pairs).
+    void addPolygon(NationId owner, const std::vector<std::vector<double>>& rings);
+
+    // Rasterizes all added polygons into the owner grid and bulk-loads the R-tree.
+    void build();
+
+    // O(1): owner of the grid cell containing the point, without border refinement.
+    NationId cellOwnerAt(double lat, double lng) const { return owners[cellIndex(lat, lng)]; }
+
+    // Owner of the point. O(1) for interior cells; exact polygon test for border cells.
+    NationId ownerAt(double lat, double lng) const;
+
+    // Batch variant of ownerAt for per-tick unit sweeps (SoA inputs).
+    void ownersAt(const double* lat, const double* lng, std::size_t count, NationId* out) const;
+
+    // Exact point-in-polygon lookup through the R-tree, bypassing the grid.
+    NationId exactOwnerAt(double lat, double lng) const;
+
+    // Grid geometry and raw access for subsystems that work in cell space.
+    int width() const { return gridWidth; }
+    int height() const { return gridHeight; }
+    double cellDegrees() const { return cellSize; }
+    std::size_t cellIndex(double lat, double lng) const;
+    std::size_t cellIndex(int cx, int cy) const { return static_cast<std::size_t>(cy) * gridWidth + cx; }
+    NationId cellOwner(std::size_t cell) const { return owners[cell]; }
+    std::uint8_t cellFlags(std::size_t cell) const { return flags[cell]; }
+    const std::vector<NationId>& ownerGrid() const { return owners; }
+
+    // Reassigns a whole cell (territory capture). The cell stops deferring to the polygon test.
+    void setCellOwner(std::size_t cell, NationId owner) {
+        owners[cell] = owner;
+        flags[cell] = static_cast<std::uint8_t>((flags[cell] & ~kCellBorder) | kCellCaptured);
+    }
+
+    std::size_t polygonCount() const { return parts.size(); }
+
+private:
+    struct Ring { std::uint32_t begin, end; };          // Vertex range in vertLng/vertLat.
+    struct PolygonPart {
+        NationId owner;
+        std::uint32_t ringBegin, ringEnd;               // Ring range in rings.
+        GeoBox box;
+    };
+    struct RTreeNode {
+        GeoBox box;
+        std::uint32_t first, count;                     // Children (nodes or parts) range.
+        bool leaf;
+    };
+
+    double cellSize;
+    int gridWidth, gridHeight;
+    std::vector<NationId> owners;
+    std::vector<std::uint8_t> flags;
+
+    std::vector<double> vertLng, vertLat;
+    std::vector<Ring> rings;
+    std::vector<PolygonPart> parts;
+
+    std::vector<RTreeNode> nodes;                       // Root is nodes.back().
+    std::vector<std::uint32_t> leafParts;               // Part ids in leaf order.
+
+    bool partContains(const PolygonPart& part, double lat, double lng) const;
+    void rasterizePart(const PolygonPart& part);
+    void markOutlineCells(const PolygonPart& part);
+    void buildRTree();
+};
+
+#endif // TERRITORY_H
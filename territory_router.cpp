@@ -0,0 +1,289 @@
+/*
+ * territory_router.cpp - 8-connected A* over a resampled territory owner grid, masked per nation.
+ */
+
+#include "territory_router.h"
+
+#include "geo.h"
+#include "territory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <string>
+
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
+    std::cout << "[" << level << "] " << message << std::endl;
+}
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kKmPerDegree = kEarthRadiusKm * kPi / 180.0;
+// The heuristic is the chord between unit vectors, never longer than the great circle. Steps are
+// measured flat at their mid-latitude, which can be a hair shorter than the arc over one step;
+// shrinking the heuristic keeps it admissible.
+constexpr float kHeuristicScale = 0.99f * static_cast<float>(kEarthRadiusKm);
+
+const int kStepX[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+const int kStepY[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+}
+
+TerritoryRouter::TerritoryRouter(double cellDegrees)
+    : degrees(cellDegrees), gridWidth(static_cast<int>(std::ceil(360.0 / cellDegrees))),
+      gridHeight(static_cast<int>(std::ceil(180.0 / cellDegrees))) {
+    const std::size_t cells = static_cast<std::size_t>(gridWidth) * gridHeight;
+    owners.assign(cells, kNoNation);
+    costSoFar.assign(cells, 0.0f);
+    parent.assign(cells, -1);
+    stamp.assign(cells, 0);
+    closed.assign(cells, 0);
+    rowKmX.resize(gridHeight);
+    rowSin.resize(gridHeight);
+    rowCos.resize(gridHeight);
+    for (int cy = 0; cy < gridHeight; ++cy) {
+        rowSin[cy] = static_cast<float>(std::sin(cellLat(cy) * kPi / 180.0));
+        rowCos[cy] = static_cast<float>(std::cos(cellLat(cy) * kPi / 180.0));
+        rowKmX[cy] = static_cast<float>(degrees * kKmPerDegree) * rowCos[cy];
+    }
+    colSin.resize(gridWidth);
+    colCos.resize(gridWidth);
+    for (int cx = 0; cx < gridWidth; ++cx) {
+        colSin[cx] = static_cast<float>(std::sin(cellLng(cx) * kPi / 180.0));
+        colCos[cx] = static_cast<float>(std::cos(cellLng(cx) * kPi / 180.0));
+    }
+    stepKmY = static_cast<float>(degrees * kKmPerDegree);
+}
+
+std::uint32_t TerritoryRouter::cellOf(double lat, double lng) const {
+    if (lng >= 180.0 || lng < -180.0) lng = std::fmod(std::fmod(lng + 180.0, 360.0) + 360.0, 360.0) - 180.0;
+    int cx = static_cast<int>(std::floor((lng + 180.0) / degrees));
+    int cy = static_cast<int>(std::floor((lat + 90.0) / degrees));
+    cx = std::min(std::max(cx, 0), gridWidth - 1);
+    cy = std::min(std::max(cy, 0), gridHeight - 1);
+    return static_cast<std::uint32_t>(cy * gridWidth + cx);
+}
+
+//-------------------------------------------------
+// Owner sampling
+//-------------------------------------------------
+void TerritoryRouter::refresh(const TerritoryIndex& territory) {
+    std::vector<double> lats(gridWidth), lngs(gridWidth);
+    for (int cx = 0; cx < gridWidth; ++cx) lngs[cx] = cellLng(cx);
+    for (int cy = 0; cy < gridHeight; ++cy) {
+        std::fill(lats.begin(), lats.end(), cellLat(cy));
+        territory.ownersAt(lats.data(), lngs.data(), gridWidth, owners.data() + static_cast<std::size_t>(cy) * gridWidth);
+    }
+}
+
+void TerritoryRouter::refreshCells(const TerritoryIndex& territory, const std::uint32_t* territoryCells, std::size_t count) {
+    const double size = territory.cellDegrees();
+    for (std::size_t i = 0; i < count; ++i) {
+        int tx = static_cast<int>(territoryCells[i] % territory.width());
+        int ty = static_cast<int>(territoryCells[i] / territory.width());
+        std::uint32_t cell = cellOf(-90.0 + (ty + 0.5) * size, -180.0 + (tx + 0.5) * size);
+        int cx = static_cast<int>(cell % gridWidth), cy = static_cast<int>(cell / gridWidth);
+        owners[cell] = territory.ownerAt(cellLat(cy), cellLng(cx));
+    }
+}
+
+//-------------------------------------------------
+// Search
+//-------------------------------------------------
+bool TerritoryRouter::route(double fromLat, double fromLng, double toLat, double toLng, NationMask enterable,
+                            std::vector<std::pair<float, float>>& waypoints, std::size_t maxExpanded) {
+    waypoints.clear();
+    expandedCount = 0;
+    const std::uint32_t start = cellOf(fromLat, fromLng), goal = cellOf(toLat, toLng);
+    const int goalX = static_cast<int>(goal % gridWidth), goalY = static_cast<int>(goal / gridWidth);
+    const float gx = rowCos[goalY] * colCos[goalX], gy = rowCos[goalY] * colSin[goalX], gz = rowSin[goalY];
+    if (++generation == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        generation = 1;
+    }
+    auto usable = [&](std::uint32_t cell) { return cell == start || cell == goal || enterable.allows(owners[cell]); };
+    auto heuristic = [&](std::uint32_t cell) {
+        int cx = static_cast<int>(cell % gridWidth), cy = static_cast<int>(cell / gridWidth);
+        float dx = rowCos[cy] * colCos[cx] - gx, dy = rowCos[cy] * colSin[cx] - gy, dz = rowSin[cy] - gz;
+        return kHeuristicScale * std::sqrt(dx * dx + dy * dy + dz * dz);
+    };
+    auto visit = [&](std::uint32_t cell) {
+        if (stamp[cell] == generation) return;
+        stamp[cell] = generation;
+        costSoFar[cell] = INFINITY;
+        parent[cell] = -1;
+        closed[cell] = 0;
+    };
+
+    using Entry = std::pair<float, std::uint32_t>;    // (cost + heuristic, cell)
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    visit(start);
+    costSoFar[start] = 0.0f;
+    open.push({heuristic(start), start});
+    bool found = false;
+    while (!open.empty()) {
+        std::uint32_t cell = open.top().second;
+        open.pop();
+        if (closed[cell]) continue;
+        closed[cell] = 1;
+        ++expandedCount;
+        if (cell == goal) {
+            found = true;
+            break;
+        }
+        if (expandedCount > maxExpanded) break;
+        const int cx = static_cast<int>(cell % gridWidth), cy = static_cast<int>(cell / gridWidth);
+        for (int k = 0; k < 8; ++k) {
+            int ny = cy + kStepY[k];
+            if (ny < 0 || ny >= gridHeight) continue;
+            int nx = (cx + kStepX[k] + gridWidth) % gridWidth;
+            std::uint32_t next = static_cast<std::uint32_t>(ny * gridWidth + nx);
+            if (!usable(next)) continue;
+            float km;
+            if (kStepY[k] == 0) {
+                km = rowKmX[cy];
+            } else if (kStepX[k] == 0) {
+                km = stepKmY;
+            } else {
+                // No cutting the corner of a blocked cell.
+                if (!usable(static_cast<std::uint32_t>(cy * gridWidth + nx)) ||
+                    !usable(static_cast<std::uint32_t>(ny * gridWidth + cx)))
+                    continue;
+                float kmX = 0.5f * (rowKmX[cy] + rowKmX[ny]);
+                km = std::sqrt(kmX * kmX + stepKmY * stepKmY);
+            }
+            visit(next);
+            float cost = costSoFar[cell] + km;
+            if (closed[next] || cost >= costSoFar[next]) continue;
+            costSoFar[next] = cost;
+            parent[next] = static_cast<std::int32_t>(cell);
+            open.push({cost + heuristic(next), next});
+        }
+    }
+    if (!found) return false;
+
+    // Walk back from the goal, keeping the cells where the direction changes.
+    std::vector<std::uint32_t> cells;
+    for (std::int32_t cell = static_cast<std::int32_t>(goal); cell >= 0; cell = parent[cell])
+        cells.push_back(static_cast<std::uint32_t>(cell));
+    std::reverse(cells.begin(), cells.end());
+    auto direction = [&](std::uint32_t a, std::uint32_t b) {
+        int dx = static_cast<int>(b % gridWidth) - static_cast<int>(a % gridWidth);
+        if (dx > 1) dx -= gridWidth;            // Across the date line.
+        if (dx < -1) dx += gridWidth;
+        return std::make_pair(dx, static_cast<int>(b / gridWidth) - static_cast<int>(a / gridWidth));
+    };
+    waypoints.push_back({static_cast<float>(fromLng), static_cast<float>(fromLat)});
+    for (std::size_t i = 1; i + 1 < cells.size(); ++i) {
+        if (direction(cells[i - 1], cells[i]) == direction(cells[i], cells[i + 1])) continue;
+        waypoints.push_back({static_cast<float>(cellLng(static_cast<int>(cells[i] % gridWidth))),
+                             static_cast<float>(cellLat(static_cast<int>(cells[i] / gridWidth)))});
+    }
+    waypoints.push_back({static_cast<float>(toLng), static_cast<float>(toLat)});
+    return true;
+}
+
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DTERRITORY_ROUTER_TEST)
+// A route must detour around a neutral nation and cross it once the nations are at war, follow a
+// corridor opened by captures, take the short way over the date line, and report enclosed goals
+// as unreachable within the expansion budget. Routes across an empty world must stay well inside
+// a tick.
+//   g++ -std=c++17 -O2 -DTERRITORY_ROUTER_TEST territory_router.cpp territory.cpp passability.cpp geo.cpp worldpack.cpp json_reader.cpp -o territory_router
+#ifdef TERRITORY_ROUTER_TEST
+#include <chrono>
+
+int main() {
+    int failures = 0;
+    NationRegistry registry;
+    NationId home = registry.intern("HOM", "Home");
+    NationId neutral = registry.intern("NEU", "Neutral");
+    NationId island = registry.intern("ISL", "Island");
+    // Home spans lng 0..20, lat 0..10, cut by Neutral's band at lng 8..12 from lat -10 to 8 (open
+    // sea lies south of it); Island is ringed by Neutral at lng 40..46.
+    TerritoryIndex territory;
+    territory.addPolygon(home, {{0, 0, 8, 0, 8, 10, 0, 10, 0, 0}});
+    territory.addPolygon(home, {{12, 0, 20, 0, 20, 10, 12, 10, 12, 0}});
+    territory.addPolygon(home, {{8, 8, 12, 8, 12, 10, 8, 10, 8, 8}});
+    territory.addPolygon(neutral, {{8, -10, 12, -10, 12, 8, 8, 8, 8, -10}});
+    territory.addPolygon(neutral, {{40, 0, 46, 0, 46, 6, 40, 6, 40, 0}});
+    territory.addPolygon(island, {{42, 2, 44, 2, 44, 4, 42, 4, 42, 2}});
+    territory.build();
+    PassabilityMasks masks;
+    masks.reset(registry.count());
+    TerritoryRouter router;
+    router.refresh(territory);
+    failures += router.cellOwner(router.cellOf(4.25, 10.25)) != neutral || router.cellOwner(router.cellOf(9.25, 10.25)) != home;
+
+    std::vector<std::pair<float, float>> path;
+    auto crossesNeutral = [&](const std::vector<std::pair<float, float>>& points) {
+        // Checks every point along the legs, a tenth of a cell apart.
+        for (std::size_t i = 1; i < points.size(); ++i) {
+            float dx = points[i].first - points[i - 1].first, dy = points[i].second - points[i - 1].second;
+            int steps = static_cast<int>(std::ceil(std::max(std::fabs(dx), std::fabs(dy)) / 0.05f)) + 1;
+            for (int s = 0; s <= steps; ++s) {
+                float t = static_cast<float>(s) / steps;
+                if (territory.ownerAt(points[i - 1].second + dy * t, points[i - 1].first + dx * t) == neutral) return true;
+            }
+        }
+        return false;
+    };
+    auto legsKm = [&](const std::vector<std::pair<float, float>>& points) {
+        double km = 0.0;
+        for (std::size_t i = 1; i < points.size(); ++i)
+            km += haversineKm(points[i - 1].second, points[i - 1].first, points[i].second, points[i].first);
+        return km;
+    };
+
+    // (lat 2, lng 4) to (lat 2, lng 16): ~1330 km straight through Neutral, ~2000 km over the top.
+    bool found = router.route(2.0, 4.0, 2.0, 16.0, masks.enterMask(home), path);
+    double detourKm = legsKm(path);
+    failures += !found || crossesNeutral(path) || detourKm < 1700.0 || detourKm > 2300.0;
+    failures += path.front() != std::make_pair(4.0f, 2.0f) || path.back() != std::make_pair(16.0f, 2.0f);
+
+    masks.setRelation(home, neutral, RelationStatus::AtWar);
+    found = router.route(2.0, 4.0, 2.0, 16.0, masks.enterMask(home), path);
+    double warKm = legsKm(path);
+    failures += !found || warKm > 1400.0 || path.size() != 2;
+    masks.setRelation(home, neutral, RelationStatus::Neutral);
+
+    // Island is enclosed by Neutral: unreachable at peace, and nothing is written. Without a budget
+    // the search floods every reachable cell; with one it gives up early.
+    found = router.route(2.0, 4.0, 3.0, 43.0, masks.enterMask(home), path, router.width() * router.height());
+    failures += found || !path.empty();
+    std::size_t enclosedExpanded = router.expanded();
+    found = router.route(2.0, 4.0, 3.0, 43.0, masks.enterMask(home), path);
+    failures += found || router.expanded() > TerritoryRouter::kDefaultMaxExpanded + 1;
+
+    // Captures: Home takes a half-degree corridor through Neutral; only those cells resample.
+    std::vector<std::uint32_t> captured;
+    for (double lat : {2.125, 2.375}) {
+        for (double lng = 8.125; lng < 12.0; lng += 0.25) {
+            std::size_t cell = territory.cellIndex(lat, lng);
+            territory.setCellOwner(cell, home);
+            captured.push_back(static_cast<std::uint32_t>(cell));
+        }
+    }
+    router.refreshCells(territory, captured.data(), captured.size());
+    found = router.route(2.25, 4.0, 2.25, 16.0, masks.enterMask(home), path);
+    failures += !found || crossesNeutral(path) || legsKm(path) > 1400.0;
+
+    // Over the date line: 2 degrees, not 358.
+    found = router.route(60.0, 179.0, 60.0, -179.0, masks.enterMask(home), path);
+    failures += !found || router.expanded() > 16 || legsKm(path) > 150.0;
+
+    // Across an empty world: a quarter of the way round.
+    auto t0 = std::chrono::steady_clock::now();
+    found = router.route(-40.0, -60.0, 40.0, 30.0, masks.enterMask(home), path);
+    double worldMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    failures += !found;
+
+    std::cout << "Detour " << detourKm << " km, at war " << warKm << " km; enclosed goal flooded " << enclosedExpanded
+              << " cells; long route " << worldMs << " ms (" << router.expanded() << " cells, " << path.size()
+              << " waypoints); failures: " << failures << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+// End of territory_router.cpp
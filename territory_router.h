@@ -0,0 +1,91 @@
+/**************************************************************************************************
+ * territory_router.h
+ * Masked Overland Routing for Conqueror Engine (Header)
+ *
+ * UnitModule's A* treats the cells of nations a unit may not enter as walls, but only on its small
+ * demo grid. TerritoryRouter applies the same rule worldwide for AI formations: the territory owner
+ * grid is resampled at the centre of each routing cell (default 0.5 degrees, 720x360 cells, with
+ * longitude wrapping at the date line), and an 8-connected A* over it skips every cell whose owner
+ * fails the nation's enter mask (passability.h). Steps cost their ground length in km, so a route
+ * is shortest on the ground rather than in degrees; the heuristic is the chord to the goal.
+ * Diagonal steps may not cut the corner of a blocked cell.
+ *
+ * A route is returned as waypoints for SteeringSystem::setGroupPath: the start (where the
+ * formation musters), the cell centres where the route turns, and the exact goal. Captures only
+ * resample the routing cells they touch (refreshCells). Searches share scratch arrays stamped
+ * with a search generation: one search at a time, from the thread that owns the router.
+ *
+ * Exposed Types:
+ * - TerritoryRouter
+ **************************************************************************************************/
+
+#ifndef TERRITORY_ROUTER_H
+#define TERRITORY_ROUTER_H
+
+#include "nations.h"
+#include "passability.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class TerritoryIndex;
+
+//-------------------------------------------------
+// Territory Router
+//-------------------------------------------------
+class TerritoryRouter {
+public:
+    static constexpr double kDefaultCellDegrees = 0.5;
+    // Searches give up after this many expanded cells (a few ms), so an unreachable goal does not
+    // flood the whole world on the tick thread.
+    static constexpr std::size_t kDefaultMaxExpanded = 20000;
+
+    explicit TerritoryRouter(double cellDegrees = kDefaultCellDegrees);
+
+    // Resamples the owner of every routing cell from the territory index.
+    void refresh(const TerritoryIndex& territory);
+    // Resamples only the routing cells containing the given territory cells (e.g. a capture batch).
+    void refreshCells(const TerritoryIndex& territory, const std::uint32_t* territoryCells, std::size_t count);
+
+    /**
+     * @brief Shortest overland route that stays on cells the mask allows.
+     * The start and goal cells are always usable: a unit stands where it stands, and the goal was
+     * chosen by the caller.
+     * @param waypoints Receives (lng, lat) pairs, x first as SteeringSystem expects: the start,
+     *                  every turning point, then the goal. Longitudes are in [-180, 180).
+     * @return false when no route exists or the search ran out of budget (waypoints is left empty).
+     */
+    bool route(double fromLat, double fromLng, double toLat, double toLng, NationMask enterable,
+               std::vector<std::pair<float, float>>& waypoints, std::size_t maxExpanded = kDefaultMaxExpanded);
+
+    int width() const { return gridWidth; }
+    int height() const { return gridHeight; }
+    double cellDegrees() const { return degrees; }
+    std::uint32_t cellOf(double lat, double lng) const;
+    NationId cellOwner(std::uint32_t cell) const { return owners[cell]; }
+    // Cells expanded by the last route() call.
+    std::size_t expanded() const { return expandedCount; }
+
+private:
+    double degrees;
+    int gridWidth, gridHeight;
+    std::vector<NationId> owners;
+    std::vector<float> rowKmX;          // East-west step length per row (km).
+    float stepKmY = 0.0f;               // North-south step length (km).
+    std::vector<float> rowSin, rowCos, colSin, colCos;  // Cell-centre unit vectors, by row and column.
+
+    // Search scratch, valid where stamp == generation.
+    std::vector<float> costSoFar;
+    std::vector<std::int32_t> parent;
+    std::vector<std::uint32_t> stamp;
+    std::vector<std::uint8_t> closed;
+    std::uint32_t generation = 0;
+    std::size_t expandedCount = 0;
+
+    double cellLat(int cy) const { return -90.0 + (cy + 0.5) * degrees; }
+    double cellLng(int cx) const { return -180.0 + (cx + 0.5) * degrees; }
+};
+
+#endif // TERRITORY_ROUTER_H
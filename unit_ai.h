@@ -0,0 +1,115 @@
+/**************************************************************************************************
+ * unit_ai.h
+ * Unit AI for Conqueror Engine (Header)
+ *
+ * Port of UnitAI / AIManager from ai.py onto the batched behavior-tree runtime (behavior_tree.h).
+ * Every AI unit shares one compiled tree:
+ *
+ *   Selector "UnitRoot"
+ *     Sequence "MoveSequence"
+ *       Condition "HasTarget"
+ *       Action    "MoveToTarget"   (steps a tenth of the way; arrives inside arriveDistance)
+ *     Action "Idle"
+ *
+ * With enableSteering() units are steered instead (steering.h): MoveToTarget only reports whether
+ * the unit is still seeking, and update() advances one SteeringSystem step for the whole
+ * population after the tree tick. Arrival then uses the steering arriveRadius. march() sends a
+ * set of units as one formation (a steering group) along a list of waypoints; units sent with
+ * setTarget() leave their formation and seek their own goal.
+ *
+ * Unit state (position, target, state, owner) is kept as blackboard columns, so update() walks
+ * each column once for the whole population. Positions are in map degrees (x = longitude,
+ * y = latitude).
+ *
+ * Exposed Types:
+ * - UnitAiState
+ * - UnitAiSystem
+ **************************************************************************************************/
+
+#ifndef UNIT_AI_H
+#define UNIT_AI_H
+
+#include "behavior_tree.h"
+#include "nations.h"
+#include "steering.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+enum class UnitAiState : std::int32_t {
+    Idle = 0,
+    Moving = 1
+};
+
+//-------------------------------------------------
+// Unit AI System
+//-------------------------------------------------
+class UnitAiSystem {
+public:
+    UnitAiSystem();
+    // The tree's leaves refer to this instance's columns.
+    UnitAiSystem(const UnitAiSystem&) = delete;
+    UnitAiSystem& operator=(const UnitAiSystem&) = delete;
+
+    // Adds an idle unit and returns its id (ids are dense, starting at 0).
+    std::uint32_t registerUnit(NationId nation, float x, float y);
+    void setTarget(std::uint32_t unit, float x, float y);
+    void clearTarget(std::uint32_t unit);
+    /**
+     * @brief Sends units as one formation along waypoints (x, y), ending at the last one.
+     * The units leave their previous formations; the new one reuses a steering group nobody
+     * belongs to any more. Without steering each unit just targets the last waypoint.
+     * @return The formation's steering group, or SteeringSystem::kNoGroup.
+     */
+    std::uint32_t march(const std::uint32_t* units, std::size_t count, const std::vector<std::pair<float, float>>& waypoints);
+
+    // Ticks every unit through the tree.
+    void update();
+    // Ticks only the listed units. A steered system still moves every unit.
+    void update(const std::uint32_t* units, std::size_t count);
+
+    // Distance (degrees) at which a moving unit snaps to its target. ai.py uses 1.0.
+    void setArriveDistance(float degrees) { arriveDistance = degrees; }
+    // Switches to steered movement; units already registered become agents outside any formation.
+    void enableSteering(const SteeringParams& params);
+    bool steered() const { return steeringEnabled; }
+
+    std::size_t count() const { return board.size(); }
+    float x(std::uint32_t unit) const { return board.floats(colX)[unit]; }
+    float y(std::uint32_t unit) const { return board.floats(colY)[unit]; }
+    const float* xs() const { return board.floats(colX); }
+    const float* ys() const { return board.floats(colY); }
+    float targetX(std::uint32_t unit) const { return board.floats(colTargetX)[unit]; }
+    float targetY(std::uint32_t unit) const { return board.floats(colTargetY)[unit]; }
+    bool hasTarget(std::uint32_t unit) const { return board.ints(colHasTarget)[unit] != 0; }
+    UnitAiState state(std::uint32_t unit) const { return static_cast<UnitAiState>(board.ints(colState)[unit]); }
+    NationId nation(std::uint32_t unit) const { return static_cast<NationId>(board.ints(colNation)[unit]); }
+    // Units that became idle on the last update (reached their target or had none).
+    std::size_t idleCount() const { return idle; }
+    // Units that reached their target during the last update.
+    const std::vector<std::uint32_t>& arrivals() const { return arrived; }
+
+    BtBlackboard& blackboard() { return board; }
+    const BehaviorTree& behavior() const { return tree; }
+    const SteeringSystem& steering() const { return movement; }
+
+private:
+    BtBlackboard board;
+    BehaviorTree tree;
+    std::size_t colX, colY, colTargetX, colTargetY, colHasTarget, colState, colNation;
+    float arriveDistance = 1.0f;
+    std::size_t idle = 0;
+    std::vector<std::uint32_t> arrived;
+    SteeringSystem movement;
+    bool steeringEnabled = false;
+    std::vector<std::uint32_t> formationOf;     // Steering group per unit (kNoGroup: none).
+    std::vector<std::uint32_t> formationSize;   // Units per steering group.
+
+    void addAgent(std::uint32_t unit);
+    void leaveFormation(std::uint32_t unit);
+    void stepSteering();
+};
+
+#endif // UNIT_AI_H
@@ -1,4 +1,7 @@
 // units.cpp
+#include "units.h"
+#include "movement.h"
+
 #include <iostream>
 #include <string>
 #include <vector>
@@ -13,17 +16,6 @@ void logEvent(const std::string &message) {
     std::cout << message << std::endl;
 }
 
-// -------------------------------------------------
-// Structure representing a unit variant
-struct UnitVariant {
-    std::string category;      // For example: "Tank", "Infantry", etc.
-    std::string variantName;   // Real-life variant name.
-    double cost;               // Money cost.
-    double resourceCost;       // Additional resource cost.
-    bool subscriptionRequired; // True if requires tickets/subscription.
-    std::string iconPath;      // Icon file path.
-};
-
 // Global registry mapping unit category to its variants.
 std::map<std::string, std::vector<UnitVariant>> g_unitVariants;
 
@@ -183,30 +175,35 @@ Nation* getNationData(const std::string &nationName) {
         Nation newNation;
         newNation.name = nationName;
         newNation.treasury = 10000000; // 10 million initial treasury.
-        g_nations[nationName] = newNation;
+        g_nations[nationName] = std::move(newNation);
         return &g_nations[nationName];
     }
 }
 
+// -------------------------------------------------
+// Movement integrator shared by every unit (x = longitude, y = latitude).
+MovementSystem g_unitMovement;
+
 // -------------------------------------------------
 // Unit class representing a game unit.
 class Unit {
 public:
     std::string category;
     UnitVariant variant;
-    float x, y; // 2D position.
+    std::uint32_t body; // Entry in g_unitMovement holding the position.
     std::string nationName;
     
     Unit(const std::string &cat, const UnitVariant &var, float posX, float posY, const std::string &nation)
-        : category(cat), variant(var), x(posX), y(posY), nationName(nation) {}
+        : category(cat), variant(var), body(g_unitMovement.add(g_unitMovement.category(cat), posY, posX)),
+          nationName(nation) {}
     
+    float x() const { return g_unitMovement.longitude(body); }
+    float y() const { return g_unitMovement.latitude(body); }
+    bool isMoving() const { return g_unitMovement.isMoving(body); }
+
+    // Starts moving towards (destX, destY) at the category's speed; updateUnits() advances it.
     void moveTo(float destX, float destY) {
-        x = destX;
-        y = destY;
-        std::ostringstream oss;
-        oss << "Unit (" << category << " - " << variant.variantName << ") moved to (" 
-            << destX << ", " << destY << ")";
-        logEvent(oss.str());
+        g_unitMovement.moveTo(body, destY, destX);
     }
     
     void printInfo() {
@@ -214,7 +211,7 @@ public:
                   << ", Variant: " << variant.variantName 
                   << ", Cost: $" << std::fixed << std::setprecision(2) << variant.cost 
                   << ", Subscription: " << (variant.subscriptionRequired ? "Yes" : "No")
-                  << ", Position: (" << x << ", " << y << ")" << std::endl;
+                  << ", Position: (" << x() << ", " << y() << ")" << std::endl;
     }
 };
 
@@ -275,7 +272,7 @@ Unit* createUnit(const std::string &unitCategory, float posX, float posY, const
 }
 
 // -------------------------------------------------
-// moveUnitTo: Moves the provided unit to (destX, destY)
+// moveUnitTo: Orders the provided unit to move to (destX, destY)
 void moveUnitTo(Unit* unit, float destX, float destY) {
     if (!unit) {
         logEvent("Invalid unit provided to moveUnitTo.");
@@ -284,6 +281,13 @@ void moveUnitTo(Unit* unit, float destX, float destY) {
     unit->moveTo(destX, destY);
 }
 
+// -------------------------------------------------
+// updateUnits: Advances every moving unit by one tick. Arrivals are read from
+// g_unitMovement.arrivals(); nothing is logged per unit.
+void updateUnits() {
+    g_unitMovement.step(kHoursPerTick);
+}
+
 // -------------------------------------------------
 // Main Testing Block (Compile with -DUNIT_TEST to run)
 #ifdef UNIT_TEST
@@ -294,21 +298,29 @@ int main() {
     // Create a test nation.
     getNationData("TestLand");
     
-    // Buy a Tank.
-    Unit* myTank = buyUnit("Tank", 50.0f, 100.0f, "TestLand");
+    // Buy a Tank (positions are longitude, latitude).
+    Unit* myTank = buyUnit("Tank", 10.0f, 50.0f, "TestLand");
     if (myTank) {
         myTank->printInfo();
-        moveUnitTo(myTank, 75.0f, 125.0f);
-        myTank->printInfo();
+        moveUnitTo(myTank, 12.0f, 51.0f);
     }
     
     // Buy a Fighter Jet.
-    Unit* myFighter = buyUnit("Fighter Jet", 200.0f, 300.0f, "TestLand");
+    Unit* myFighter = buyUnit("Fighter Jet", 139.7f, 35.7f, "TestLand");
     if (myFighter) {
         myFighter->printInfo();
-        moveUnitTo(myFighter, 250.0f, 350.0f);
-        myFighter->printInfo();
+        moveUnitTo(myFighter, -122.4f, 37.8f);
+    }
+    
+    // Tick until both have arrived (one game day at most).
+    int ticks = 0;
+    for (; ticks < static_cast<int>(kTicksPerGameDay) && g_unitMovement.movingCount() > 0; ++ticks) {
+        updateUnits();
+        for (const MovementArrival& arrival : g_unitMovement.arrivals())
+            std::cout << "Unit " << arrival.unit << " arrived after " << ticks + 1 << " ticks." << std::endl;
     }
+    if (myTank) myTank->printInfo();
+    if (myFighter) myFighter->printInfo();
     
     return 0;
 }
@@ -1,10 +1,28 @@
 #ifndef UNITS_H
 #define UNITS_H
 
+#include <map>
+#include <string>
+#include <vector>
+
 // Units module header
 // Declares functions for initializing, updating, and cleaning up the units module.
 bool initUnits();
 void updateUnits();
 void cleanupUnits();
 
+// Structure representing a unit variant
+struct UnitVariant {
+    std::string category;      // For example: "Tank", "Infantry", etc.
+    std::string variantName;   // Real-life variant name.
+    double cost;               // Money cost.
+    double resourceCost;       // Additional resource cost.
+    bool subscriptionRequired; // True if requires tickets/subscription.
+    std::string iconPath;      // Icon file path.
+};
+
+// Global registry mapping unit category to its variants (filled by initUnitVariants()).
+extern std::map<std::string, std::vector<UnitVariant>> g_unitVariants;
+void initUnitVariants();
+
 #endif // UNITS_H
@@ -0,0 +1,306 @@
+/*
+ * worldpack.cpp - world.pack reader (mmap / single read), writer and the offline builder.
+ */
+
+#include "worldpack.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if !defined(__EMSCRIPTEN__) && (defined(__unix__) || defined(__APPLE__))
+#define WORLDPACK_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+inline void logEvent(const std::string &message, const std::string &level = "INFO") {
+    std::cout << "[" << level << "] " << message << std::endl;
+}
+
+namespace {
+
+inline std::uint64_t alignUp(std::uint64_t offset) { return (offset + 7) & ~std::uint64_t(7); }
+
+} // namespace
+
+bool WorldPack::open(const std::string& path) {
+    close();
+#ifdef WORLDPACK_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(WorldPackHeader))) {
+        ::close(fd);
+        return false;
+    }
+    void* view = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+    base = static_cast<const std::uint8_t*>(view);
+    size = static_cast<std::size_t>(info.st_size);
+    mapped = true;
+#else
+    // WASM (the preloaded file lives in MEMFS) and other platforms: one read into an aligned buffer.
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    std::fseek(file, 0, SEEK_END);
+    long length = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    if (length < static_cast<long>(sizeof(WorldPackHeader))) {
+        std::fclose(file);
+        return false;
+    }
+    buffer.reset(new std::uint64_t[(static_cast<std::size_t>(length) + 7) / 8]);
+    std::size_t read = std::fread(buffer.get(), 1, static_cast<std::size_t>(length), file);
+    std::fclose(file);
+    if (read != static_cast<std::size_t>(length)) {
+        buffer.reset();
+        return false;
+    }
+    base = reinterpret_cast<const std::uint8_t*>(buffer.get());
+    size = read;
+#endif
+    if (!validate()) {
+        logEvent("WorldPack: " + path + " is not a version " + std::to_string(kWorldPackVersion) + " world pack.",
+                 "ERROR");
+        close();
+        return false;
+    }
+    logEvent("WorldPack: " + std::string(mapped ? "mapped " : "read ") + path + " (" + std::to_string(size) +
+             " bytes, " + std::to_string(entryCount) + " sections).");
+    return true;
+}
+
+bool WorldPack::openMemory(const void* data, std::size_t bytes) {
+    close();
+    if (!data || bytes < sizeof(WorldPackHeader) || reinterpret_cast<std::uintptr_t>(data) % 8 != 0) return false;
+    base = static_cast<const std::uint8_t*>(data);
+    size = bytes;
+    if (!validate()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void WorldPack::close() {
+#ifdef WORLDPACK_MMAP
+    if (mapped && base) ::munmap(const_cast<std::uint8_t*>(base), size);
+#endif
+    base = nullptr;
+    size = 0;
+    mapped = false;
+    buffer.reset();
+    entries = nullptr;
+    entryCount = 0;
+    strings = nullptr;
+    stringBytes = 0;
+}
+
+bool WorldPack::validate() {
+    const WorldPackHeader* header = reinterpret_cast<const WorldPackHeader*>(base);
+    if (header->magic != kWorldPackMagic || header->version != kWorldPackVersion || header->fileBytes != size)
+        return false;
+    std::uint64_t tableEnd = sizeof(WorldPackHeader) + std::uint64_t(header->sectionCount) * sizeof(WorldPackSectionEntry);
+    if (tableEnd > size) return false;
+    entries = reinterpret_cast<const WorldPackSectionEntry*>(base + sizeof(WorldPackHeader));
+    entryCount = header->sectionCount;
+    for (std::uint32_t i = 0; i < entryCount; ++i) {
+        const WorldPackSectionEntry& e = entries[i];
+        if (e.offset % 8 != 0 || e.offset < tableEnd || e.offset > size || e.bytes > size - e.offset) return false;
+    }
+    std::size_t count = 0;
+    strings = section<char>(WorldPackSection::Strings, &count);
+    stringBytes = count;
+    // The table must end with a terminator so string() never reads past it.
+    return !strings || (count > 0 && strings[count - 1] == '\0');
+}
+
+const WorldPackSectionEntry* WorldPack::find(WorldPackSection tag) const {
+    for (std::uint32_t i = 0; i < entryCount; ++i)
+        if (entries[i].tag == static_cast<std::uint32_t>(tag)) return &entries[i];
+    return nullptr;
+}
+
+std::uint32_t WorldPackWriter::addString(const std::string& text) {
+    if (strings.empty()) strings.push_back('\0');   // Offset 0 is the empty string.
+    if (text.empty()) return 0;
+    auto it = stringOffsets.find(text);
+    if (it != stringOffsets.end()) return it->second;
+    std::uint32_t offset = static_cast<std::uint32_t>(strings.size());
+    strings.insert(strings.end(), text.begin(), text.end());
+    strings.push_back('\0');
+    stringOffsets.emplace(text, offset);
+    return offset;
+}
+
+bool WorldPackWriter::write(const std::string& path) const {
+    std::vector<char> table = strings.empty() ? std::vector<char>(1, '\0') : strings;
+    std::uint32_t sectionCount = static_cast<std::uint32_t>(sections.size() + 1);
+
+    std::vector<WorldPackSectionEntry> entries;
+    std::uint64_t offset = alignUp(sizeof(WorldPackHeader) + sectionCount * sizeof(WorldPackSectionEntry));
+    entries.push_back({static_cast<std::uint32_t>(WorldPackSection::Strings), static_cast<std::uint32_t>(table.size()),
+                       offset, table.size()});
+    offset = alignUp(offset + table.size());
+    for (const PendingSection& s : sections) {
+        entries.push_back({static_cast<std::uint32_t>(s.tag), s.count, offset, s.payload.size()});
+        offset = alignUp(offset + s.payload.size());
+    }
+    WorldPackHeader header{kWorldPackMagic, kWorldPackVersion, sectionCount, 0, offset};
+
+    std::vector<std::uint8_t> image(offset, 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+    std::memcpy(image.data() + sizeof(header), entries.data(), entries.size() * sizeof(WorldPackSectionEntry));
+    std::memcpy(image.data() + entries[0].offset, table.data(), table.size());
+    for (std::size_t i = 0; i < sections.size(); ++i)
+        if (!sections[i].payload.empty())
+            std::memcpy(image.data() + entries[i + 1].offset, sections[i].payload.data(), sections[i].payload.size());
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    bool ok = std::fwrite(image.data(), 1, image.size(), file) == image.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+WorldPack& worldPack() {
+    static WorldPack pack;
+    return pack;
+}
+
+// -------------------------------------------------
+// Offline builder and standalone test. Both link the loaders they convert from:
+//   g++ -std=c++17 -O2 -DWORLDPACK_BUILD worldpack.cpp territory.cpp cities.cpp json_reader.cpp units.cpp
+//       movement.cpp geo.cpp -o worldpack-build, then ./worldpack-build world.pack
+//   g++ -std=c++17 -O2 -DWORLDPACK_TEST worldpack.cpp territory.cpp cities.cpp json_reader.cpp units.cpp
+//       movement.cpp geo.cpp
+#if defined(WORLDPACK_BUILD) || defined(WORLDPACK_TEST)
+#include "cities.h"
+#include "json_reader.h"
+#include "territory.h"
+#include "units.h"
+
+namespace {
+
+// countries.geo.json + data/cities.json + the unit variant catalog -> one pack file.
+bool buildWorldPack(const std::string& geoPath, const std::string& citiesPath, const std::string& outPath) {
+    WorldPackWriter writer;
+
+    NationRegistry registry;
+    TerritoryIndex territory;
+    if (!territory.loadGeoJson(geoPath, registry)) return false;
+    territory.writePack(writer, registry);
+
+    JsonValue cities;
+    std::string error;
+    if (!loadJsonFile(citiesPath, cities, &error) || !CitySystem::writePack(cities, writer)) {
+        logEvent("WorldPack: Failed to convert " + citiesPath + ": " + error, "ERROR");
+        return false;
+    }
+
+    initUnitVariants();
+    std::vector<PackVariant> variants;
+    for (const auto& category : g_unitVariants)
+        for (const UnitVariant& v : category.second)
+            variants.push_back({writer.addString(v.category), writer.addString(v.variantName),
+                                writer.addString(v.iconPath), v.subscriptionRequired ? 1u : 0u, v.cost,
+                                v.resourceCost});
+    writer.addSection(WorldPackSection::Variants, variants);
+
+    if (!writer.write(outPath)) {
+        logEvent("WorldPack: Failed to write " + outPath, "ERROR");
+        return false;
+    }
+    logEvent("WorldPack: Wrote " + outPath + " (" + std::to_string(registry.count()) + " nations, " +
+             std::to_string(territory.polygonCount()) + " polygons, " + std::to_string(variants.size()) +
+             " unit variants).");
+    return true;
+}
+
+} // namespace
+#endif
+
+#ifdef WORLDPACK_BUILD
+int main(int argc, char** argv) {
+    std::string out = argc > 1 ? argv[1] : "world.pack";
+    std::string geo = argc > 2 ? argv[2] : "countries.geo.json";
+    std::string cities = argc > 3 ? argv[3] : "data/cities.json";
+    return buildWorldPack(geo, cities, out) ? 0 : 1;
+}
+#endif
+
+// -------------------------------------------------
+// Standalone Testing Block (Compile with -DWORLDPACK_TEST)
+// Builds a pack, checks that it restores the same territory and cities as the JSON path, and
+// times both startups.
+#ifdef WORLDPACK_TEST
+#include <chrono>
+#include <random>
+
+int main() {
+    const std::string path = "/tmp/worldpack_test.pack";
+    if (!buildWorldPack("countries.geo.json", "data/cities.json", path)) return 1;
+    auto ms = [](std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    };
+    auto resolverFor = [](const TerritoryIndex& territory, NationRegistry& registry) {
+        return [&territory, &registry](const std::string& code, const std::string& country, double lat, double lng) {
+            NationId owner = territory.ownerAt(lat, lng);
+            if (owner == kNoNation) owner = registry.find(country);
+            return owner == kNoNation ? registry.find(code) : owner;
+        };
+    };
+
+    auto t0 = std::chrono::steady_clock::now();
+    NationRegistry jsonNations;
+    TerritoryIndex jsonTerritory;
+    CitySystem jsonCities;
+    jsonTerritory.loadGeoJson("countries.geo.json", jsonNations);
+    jsonCities.loadJson("data/cities.json", resolverFor(jsonTerritory, jsonNations));
+    double jsonMs = ms(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    WorldPack pack;
+    NationRegistry packNations;
+    TerritoryIndex packTerritory;
+    CitySystem packCities;
+    bool loaded = pack.open(path) && packTerritory.loadPack(pack, packNations) &&
+                  packCities.loadPack(pack, resolverFor(packTerritory, packNations));
+    double packMs = ms(t0);
+    if (!loaded) return 1;
+
+    int failures = 0;
+    failures += packNations.count() != jsonNations.count();
+    failures += packTerritory.ownerGrid() != jsonTerritory.ownerGrid();
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> latDist(-60.0, 75.0), lngDist(-180.0, 180.0);
+    for (int i = 0; i < 100000; ++i) {
+        double lat = latDist(rng), lng = lngDist(rng);
+        failures += packTerritory.ownerAt(lat, lng) != jsonTerritory.ownerAt(lat, lng);
+    }
+    failures += packCities.count() != jsonCities.count();
+    for (std::size_t i = 0; i < packCities.count() && i < jsonCities.count(); ++i)
+        failures += packCities.name(i) != jsonCities.name(i) || packCities.owner(i) != jsonCities.owner(i) ||
+                    packCities.population(i) != jsonCities.population(i) || packCities.lat(i) != jsonCities.lat(i);
+
+    std::size_t variantCount = 0;
+    const PackVariant* variants = pack.section<PackVariant>(WorldPackSection::Variants, &variantCount);
+    initUnitVariants();
+    std::size_t expected = 0;
+    for (const auto& category : g_unitVariants) expected += category.second.size();
+    failures += !variants || variantCount != expected;
+    if (variants && variantCount > 0)
+        std::cout << "First variant: " << pack.string(variants[0].category) << " / " << pack.string(variants[0].name)
+                  << " ($" << variants[0].cost << ")" << std::endl;
+
+    std::cout << "Startup from JSON: " << jsonMs << " ms, from world pack: " << packMs << " ms ("
+              << pack.sizeBytes() / 1024 << " KB); mismatches: " << failures << std::endl;
+    std::remove(path.c_str());
+    return failures == 0 ? 0 : 1;
+}
+#endif
+
+// End of worldpack.cpp
@@ -0,0 +1,185 @@
+/**************************************************************************************************
+ * worldpack.h
+ * Binary World Pack for Conqueror Engine (Header)
+ *
+ * Startup data (country outlines, cities and the unit variant catalog) is converted offline by
+ * worldpack-build into one little-endian file, world.pack, that the engine maps instead of parsing
+ * countries.geo.json and data/cities.json:
+ *   - natively the file is mmap'ed read-only, so sections are used in place;
+ *   - in WASM the whole file is read with one call into a single 8-byte aligned buffer in linear
+ *     memory (or handed over with openMemory() after a fetch()).
+ * Every section starts on an 8-byte boundary and holds a flat array of one record type, so a
+ * section is consumed as a typed pointer plus a count; strings live in one shared table and are
+ * referenced by byte offset.
+ *
+ * File layout:
+ *   WorldPackHeader | WorldPackSectionEntry[sectionCount] | section payloads (8-byte aligned)
+ *
+ * Exposed Types:
+ * - WorldPackSection / WorldPackHeader / WorldPackSectionEntry
+ * - PackNation / PackPart / PackRing / PackCityCountry / PackVariant
+ * - WorldPack (reader) / WorldPackWriter (used by the offline builder)
+ *
+ * Process-wide pack used by the engine modules:
+ * - worldPack()
+ **************************************************************************************************/
+
+#ifndef WORLDPACK_H
+#define WORLDPACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//-------------------------------------------------
+// On-disk structures
+//-------------------------------------------------
+constexpr std::uint32_t kWorldPackMagic = 0x50575143;  // "CQWP"
+constexpr std::uint32_t kWorldPackVersion = 1;
+
+enum class WorldPackSection : std::uint32_t {
+    Strings = 1,        // char: NUL-terminated strings, referenced by byte offset.
+    Nations,            // PackNation: territory nations in registry order.
+    Parts,              // PackPart: one polygon (outer ring + holes) of a nation.
+    Rings,              // PackRing: vertex ranges.
+    VertexLng,          // double
+    VertexLat,          // double
+    CityCountries,      // PackCityCountry: listed country and its city range.
+    CityNames,          // uint32_t string offsets.
+    CityLat,            // double
+    CityLng,            // double
+    Variants            // PackVariant: unit variant catalog, grouped by category.
+};
+
+struct WorldPackHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t sectionCount;
+    std::uint32_t reserved;
+    std::uint64_t fileBytes;
+};
+
+struct WorldPackSectionEntry {
+    std::uint32_t tag;
+    std::uint32_t count;        // Records in the section.
+    std::uint64_t offset;       // From the start of the file; multiple of 8.
+    std::uint64_t bytes;
+};
+
+struct PackNation { std::uint32_t code, name; };
+struct PackRing { std::uint32_t begin, end; };
+struct PackPart {
+    std::uint32_t nation;       // Index into Nations.
+    std::uint32_t ringBegin, ringEnd;
+    std::uint32_t reserved;
+    double minLng, minLat, maxLng, maxLat;
+};
+struct PackCityCountry {
+    std::uint32_t code, name;   // String offsets (ISO alpha-2 and display name).
+    std::uint32_t firstCity, cityCount;
+};
+struct PackVariant {
+    std::uint32_t category, name, icon;
+    std::uint32_t subscriptionRequired;
+    double cost, resourceCost;
+};
+
+//-------------------------------------------------
+// World Pack (read-only view)
+//-------------------------------------------------
+class WorldPack {
+public:
+    WorldPack() = default;
+    ~WorldPack() { close(); }
+    WorldPack(const WorldPack&) = delete;
+    WorldPack& operator=(const WorldPack&) = delete;
+
+    /**
+     * @brief Maps (natively) or reads in one call (WASM) a pack file and validates its header and
+     * section table.
+     * @return False if the file is missing, truncated or from another pack version.
+     */
+    bool open(const std::string& path);
+    // Uses bytes that are already in memory (e.g. fetched by the page). Not copied; must outlive the pack.
+    bool openMemory(const void* data, std::size_t bytes);
+    void close();
+
+    bool isOpen() const { return base != nullptr; }
+    std::size_t sizeBytes() const { return size; }
+    bool isMapped() const { return mapped; }
+
+    /**
+     * @brief Typed view of a section.
+     * @param count Receives the record count (0 if the section is absent).
+     * @return Pointer to the first record, or nullptr if the section is absent or has another record size.
+     */
+    template <typename T>
+    const T* section(WorldPackSection tag, std::size_t* count = nullptr) const {
+        const WorldPackSectionEntry* entry = find(tag);
+        if (!entry || entry->bytes != static_cast<std::uint64_t>(entry->count) * sizeof(T)) {
+            if (count) *count = 0;
+            return nullptr;
+        }
+        if (count) *count = entry->count;
+        return reinterpret_cast<const T*>(base + entry->offset);
+    }
+
+    // String at a Strings offset ("" if out of range).
+    const char* string(std::uint32_t offset) const {
+        return offset < stringBytes ? strings + offset : "";
+    }
+
+private:
+    const std::uint8_t* base = nullptr;
+    std::size_t size = 0;
+    bool mapped = false;
+    std::unique_ptr<std::uint64_t[]> buffer;   // Owned copy when the file could not be mapped.
+    const WorldPackSectionEntry* entries = nullptr;
+    std::uint32_t entryCount = 0;
+    const char* strings = nullptr;
+    std::size_t stringBytes = 0;
+
+    bool validate();
+    const WorldPackSectionEntry* find(WorldPackSection tag) const;
+};
+
+//-------------------------------------------------
+// World Pack Writer (offline builder)
+//-------------------------------------------------
+class WorldPackWriter {
+public:
+    // Adds a string to the shared table (deduplicated) and returns its offset.
+    std::uint32_t addString(const std::string& text);
+
+    template <typename T>
+    void addSection(WorldPackSection tag, const T* records, std::size_t count) {
+        const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(records);
+        sections.push_back({tag, static_cast<std::uint32_t>(count),
+                            std::vector<std::uint8_t>(bytes, bytes + count * sizeof(T))});
+    }
+    template <typename T>
+    void addSection(WorldPackSection tag, const std::vector<T>& records) {
+        addSection(tag, records.data(), records.size());
+    }
+
+    // Writes the header, section table, string table and payloads.
+    bool write(const std::string& path) const;
+
+private:
+    struct PendingSection {
+        WorldPackSection tag;
+        std::uint32_t count;
+        std::vector<std::uint8_t> payload;
+    };
+    std::vector<PendingSection> sections;
+    std::vector<char> strings;
+    std::unordered_map<std::string, std::uint32_t> stringOffsets;
+};
+
+// Process-wide pack opened by the territory module and read by the other modules during init.
+WorldPack& worldPack();
+
+#endif // WORLDPACK_H